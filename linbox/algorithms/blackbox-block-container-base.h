@@ -66,16 +66,9 @@ public:
 	template<class Blackbox>
 	static typename std::enable_if<!is_blockbb<Blackbox>::value>::type 
 	mul(Block &M1, const Blackbox &M2, const Block& M3) {
-		linbox_check( M1.rowdim() == M2.rowdim());
-		linbox_check( M2.coldim() == M3.rowdim());
-		linbox_check( M1.coldim() == M3.coldim());
-
-		typename Block::ColIterator        p1 = M1.colBegin();
-		typename Block::ConstColIterator   p3 = M3.colBegin();
-
-		for (; p3 != M3.colEnd(); ++p1,++p3) {
-			M2.apply(*p1,*p3);
-		}
+		// column by column, by parallel batches if M2 is reentrant
+		MatrixDomain<Field> MD(M2.field());
+		MD.blackboxMulLeft(M1, M2, M3);
 	}
 };
 
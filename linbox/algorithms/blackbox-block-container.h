@@ -209,16 +209,21 @@ namespace LinBox
 				}
 			}
 			else {
-				_rep.resize(_rep.size()-3);
+				// U0 and V0 are block diagonal: row i of U0 is nonzero only on
+				// the columns i*Nn..(i+1)*Nn-1. The record holds U.A^(k+1).V
+				// for k < 2Nn-1, the block Hankel matrix they form is KU.A.KV
+				// with KU = [U; U.A; ...] and KV = [V, A.V, ...] square of
+				// dimension Nn*block.
 				size_t block= U0.rowdim();
 				size_t Nn = U0.coldim()/block;
+				_rep.resize(2*Nn-1, Value(F));
 				_Special_U.resize(block, std::vector<typename Field::Element>(Nn));
 
 				for (size_t i=0;i<block;++i)
 					for (size_t j=0;j<Nn;++j)
-						F.assign(_Special_U[i][j], U0.getEntry(0, i*Nn+j));
+						F.assign(_Special_U[i][j], U0.getEntry(i, i*Nn+j));
 
-				for (size_t i=0;i< this->_size-3;++i){
+				for (size_t i=0;i< _rep.size();++i){
 					_launch_record_notdense();
 					_rep[i] = this->_value;
 				}
@@ -406,34 +411,38 @@ namespace LinBox
 		// launcher of computation of sequence element
 		void _launch_record_notdense ()
 		{
-			size_t block= this->_blockV.coldim();
-			size_t numblock=_Special_U[0].size();
 			if (this->casenumber) {
 				Mul(_blockW,*this->_BB,this->_blockV);
-
-				std::vector<Element> tmp(block);
-				for (size_t i=0; i<block; ++i){
-					BlasMatrix<Field> T(_blockW, i*numblock, 0, numblock, block);
-					_BMD.mul(tmp, _Special_U[i], T);
-					for (size_t j=0;j<block;++j){
-						this->getField()->assign(this->_value.refEntry(i,j), tmp[j]);
-					}
-				}
-
+				_project_notdense(_blockW);
 				this->casenumber = 0;
 			}
 			else {
 				Mul(this->_blockV,*this->_BB,_blockW);
+				_project_notdense(this->_blockV);
+				this->casenumber = 1;
+			}
+		}
 
-				std::vector<Element> tmp(block);
-				for (size_t i=0; i< block; ++i){
-					BlasMatrix<Field> T(this->_blockV, i*numblock, 0, numblock, block);
-					_BMD.mul(tmp, _Special_U[i], T);
-					for (size_t j=0;j<block;++j)
-						this->getField().assign(this->_value.refEntry(i,j), tmp[j]);
+		// value = U.W for the block diagonal U, block row i only reads the
+		// rows of W in the i-th slice, so the slices are independent
+		void _project_notdense (const Block &W)
+		{
+			const Field &F = this->field();
+			size_t block= W.coldim();
+			long nblock= (long)_Special_U.size();
+			size_t numblock=_Special_U[0].size();
+#ifdef __LINBOX_USE_OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+			for (long i=0; i<nblock; ++i){
+				const std::vector<Element> &u = _Special_U[i];
+				for (size_t j=0;j<block;++j){
+					Element s;
+					F.assign(s, F.zero);
+					for (size_t k=0;k<numblock;++k)
+						F.axpyin(s, u[k], W.getEntry(i*numblock+k, j));
+					F.assign(this->_value.refEntry(i,j), s);
 				}
-
-				this->casenumber = 1;
 			}
 		}
 
@@ -33,8 +33,11 @@
 
 #include "linbox/util/timer.h"
 
-#if defined(__LINBOX_USE_OPENMP) and defined(__GIVARO_USE_OPENMP)
+#if defined(__LINBOX_USE_OPENMP)
 #include <omp.h>
+#endif
+
+#if defined(__LINBOX_USE_OPENMP) and defined(__GIVARO_USE_OPENMP)
 #include "givaro/givomptimer.h"
 namespace LinBox {
     typedef Givaro::OMPTimer CTimer;
@@ -262,6 +265,7 @@ EARLY_TERM_THRESHOLD (ett_default)
 			size_t _row, _col;
 			size_t _ett;
 			size_t _etc;
+			std::vector<Coefficient> _acc; // per-thread discrepancy accumulators
 
 		public:
 			// This is an enumeration class that tells what state the berlekamp/massey algoithm iterator is in.
@@ -364,7 +368,7 @@ EARLY_TERM_THRESHOLD (ett_default)
 				_delta(it._delta), _mu(it._mu), _beta(it._beta),
 				_sigma(it._sigma), _gensize(it._gensize),
 				_row(it._row), _col(it._col),
-				_ett(it._ett), _etc(it._etc), _state(it._state) {}
+				_ett(it._ett), _etc(it._etc), _acc(it._acc), _state(it._state) {}
 
 
 			//Assignment operator not overloaded since BlasMatrix class has overloaded assignment error
@@ -549,8 +553,6 @@ EARLY_TERM_THRESHOLD (ett_default)
 				if(_t == _size){
 					return *this;
 				}
-				//Initialize the discrepancy
-				Coefficient disc(field(),_row, _row+_col);
 				//Create two iterators, one for seq, and one for gen
 				typename BM_Seq::const_iterator cseqit;
 				typename std::list<Coefficient>::iterator genit;
@@ -561,26 +563,41 @@ EARLY_TERM_THRESHOLD (ett_default)
 				//Compute the discrepancy
 				std::vector<Coefficient*> coeffVec;
 				std::vector<const Coefficient*> seqPtrVec;
+				coeffVec.reserve(_gensize);
+				seqPtrVec.reserve(_gensize);
 				for(genit = _gen.begin(); genit!=_gen.end(); ++genit){
 					coeffVec.push_back(&(*genit));
 					seqPtrVec.push_back(&(*cseqit));
 					--cseqit;
 				}
 				int numCoeffs=coeffVec.size();
-				std::vector <Coefficient> discComponents;
-				discComponents.reserve(numCoeffs);
-				for (int i=0;i<numCoeffs;++i) {
-					discComponents.push_back(Coefficient(field(),_row,_row+_col));
+				// each thread accumulates a contiguous range of the products
+				// in its own accumulator, allocated once for the whole iteration
+#ifdef __LINBOX_USE_OPENMP
+				int numThreads=std::min(omp_get_max_threads(),numCoeffs);
+#else
+				int numThreads=1;
+#endif
+				while ((int)_acc.size() < numThreads)
+					_acc.push_back(Coefficient(field(),_row,_row+_col));
+#ifdef __LINBOX_USE_OPENMP
+#pragma omp parallel for num_threads(numThreads) schedule(static,1)
+#endif
+				for (int t=0;t<numThreads;++t) {
+					int lo=(t*numCoeffs)/numThreads, hi=((t+1)*numCoeffs)/numThreads;
+					domain().mul(_acc[t],*(seqPtrVec[lo]),*(coeffVec[lo]));
+					for (int i=lo+1;i<hi;++i)
+						domain().axpyin(_acc[t],*(seqPtrVec[i]),*(coeffVec[i]));
 				}
+				// binary tree reduction of the partial discrepancies into _acc[0]
+				for (int stride=1;stride<numThreads;stride<<=1) {
 #ifdef __LINBOX_USE_OPENMP
 #pragma omp parallel for
 #endif
-				for (int i=0;i<numCoeffs;++i) {
-					domain().axpyin(discComponents[i],*(seqPtrVec[i]),*(coeffVec[i]));
-				}
-				for (int i=0;i<numCoeffs;++i) {
-					domain().addin(disc,discComponents[i]);
+					for (int t=0;t<numThreads-stride;t+=2*stride)
+						domain().addin(_acc[t],_acc[t+stride]);
 				}
+				Coefficient &disc=_acc[0];
                                 start1.stop();
 				g_time2 += start1.realtime();
 
@@ -28,6 +28,7 @@
 #define __LINBOX_massey_block_domain_H
 
 #include <vector>
+#include <deque>
 #include <iostream>
 #include <algorithm>
 #include <iomanip>
@@ -56,6 +57,10 @@
 
 //#define _BM_TIMING
 #define DEFAULT_BLOCK_EARLY_TERM_THRESHOLD 10
+// number of sequence terms consumed at once by the online generator computation
+#ifndef DEFAULT_BLOCK_ONLINE_BATCH
+#define DEFAULT_BLOCK_ONLINE_BATCH 64
+#endif
 
 namespace LinBox
 {
@@ -239,6 +244,20 @@ namespace LinBox
 			degree = masseyblock_left_rec(P);
 		}
 
+		// left minimal generating polynomial computed while the sequence is
+		// being generated, only a sliding window of the sequence is stored:
+		// the terms of index >= k-deg(sigma), that is about n/(m+n) of the
+		// terms used, so the memory is halved for square blocks, not bounded
+		void left_minpoly_online (std::vector<Coefficient> &P, size_t batch=DEFAULT_BLOCK_ONLINE_BATCH)
+		{
+			masseyblock_left_online(P,batch);
+		}
+
+		void left_minpoly_online (std::vector<Coefficient> &P, std::vector<size_t> &degree, size_t batch=DEFAULT_BLOCK_ONLINE_BATCH)
+		{
+			degree = masseyblock_left_online(P,batch);
+		}
+
 
 		// right minimal generating polynomial of the sequence
 		void right_minpoly (std::vector<Coefficient> &P) { masseyblock_right(P);}
@@ -250,7 +269,7 @@ namespace LinBox
 
 		std::vector<size_t> masseyblock_left (std::vector<Coefficient> &P)
 		{
-            std::ostream& report = commentator().report (Commentator::LEVEL_IMPORTANT, INTERNAL_DESCRIPTION);
+            std::ostream& report = commentator().report (Commentator::LEVEL_NORMAL, INTERNAL_DESCRIPTION);
 
 			const size_t length = _container->size ();
 			const size_t m = _container->rowdim();
@@ -605,6 +624,51 @@ namespace LinBox
             SB.PM_Basis(SigmaBase, PowerSerie, length, shift);
 
 
+			// extract the generator from the m rows of lowest defect
+			getGenerator(lingen, SigmaBase, shift, m);
+
+#ifdef __CHECK_RESULT
+			report<<"Check minimal polynomial application\n";
+			bool valid=true;
+			for (size_t i=0;i< length - lingen.size();++i){
+				Coefficient res(field(),m,n);
+				Coefficient Power(PowerSerie[i],0,0,m,n);
+				_BMD.mul(res,lingen[0],Power);
+				for (size_t k=1,j=i+1;k<lingen.size();++k,++j){
+					Coefficient Powerview(PowerSerie[j],0,0,m,n);
+					_BMD.axpyin(res,lingen[k],Powerview);
+				}
+				for (size_t j=0;j<m*n;++j)
+					if (!field().isZero(*(res.getPointer()+j)))
+						valid= false;
+            }
+			if (valid)
+				report<<"minpoly is correct\n";
+			else
+				report<<"minpoly is wrong\n";
+#endif
+
+#ifdef __PRINT_MINPOLY
+			report<<"MinPoly:=";
+            write_maple(field(),lingen);
+#endif
+			std::vector<size_t> degree(m);
+			for (size_t i=0;i<m;++i)
+				degree[i] = shift[i];
+			return degree;
+		}
+
+
+		// Reverse the m rows of the order basis SigmaBase which have lowest
+		// shifted degree into the left generator lingen. shift is sorted.
+		template<typename PMatrix>
+		void getGenerator (std::vector<Coefficient> &lingen, const PMatrix &SigmaBase, std::vector<size_t> &shift, size_t m)
+		{
+#ifdef __PRINT_SIGMABASE
+			std::ostream& report = std::cout;
+#endif
+			size_t mn=SigmaBase.rowdim();
+
 			// take the m rows which have lowest defect
 			// compute permutation such that first m rows have lowest defect
 			std::vector<size_t> Perm(mn);
@@ -612,7 +676,7 @@ namespace LinBox
 				Perm[i]=i;
 			for (size_t i=0;i<mn;++i) {
 				size_t idx_min=i;
-				for (size_t j=i+1;j<m+n;++j)
+				for (size_t j=i+1;j<mn;++j)
 					if (shift[j]< shift[idx_min])
 						idx_min=j;
 				std::swap(shift[i],shift[idx_min]);
@@ -632,7 +696,7 @@ namespace LinBox
 
                         
 #ifdef __PRINT_SIGMABASE
-            report<<"order is "<<length-1<<std::endl;
+            report<<"degree is "<<SigmaBase.size()-1<<std::endl;
 			report<<"SigmaBase:=";
             Sigma.write(report);
             report<<"shift:=[";
@@ -651,34 +715,122 @@ namespace LinBox
                 for (size_t j=0;j<=shift[i];j++)
                     for (size_t k=0;k<m;k++)
                         field().assign(lingen[shift[i]-j].refEntry(i,k), Sigma.ref(i,k,j));
+		}
 
+		std::vector<size_t> masseyblock_left_online (std::vector<Coefficient> &lingen, size_t batch)
+		{
+			typedef PolynomialMatrix<PMType::polfirst,PMStorage::plain, Field> PMatrix;
 
-                     
-#ifdef __CHECK_RESULT
-			report<<"Check minimal polynomial application\n";
-			bool valid=true;
-			for (size_t i=0;i< length - lingen.size();++i){
-				Coefficient res(field(),m,n);
-				Coefficient Power(PowerSerie[i],0,0,m,n);
-				_BMD.mul(res,lingen[0],Power);
-				for (size_t k=1,j=i+1;k<lingen.size();++k,++j){
-					Coefficient Powerview(PowerSerie[j],0,0,m,n);
-					_BMD.axpyin(res,lingen[k],Powerview);
+			size_t length = _container->size();
+			size_t m = _container->rowdim();
+			size_t n = _container->coldim();
+			size_t mn= m+n;
+			batch = std::max(std::min(batch,length),size_t(1));
+
+			// set the shift to [ 0 .. 0 1 .. 1]
+			std::vector<size_t> shift(mn,0);
+			std::fill(shift.begin()+m,shift.end(),1);
+
+			// SigmaBase is the order basis of [ S(x) Id ]^T at order k, it starts with Id
+			PMatrix* SigmaBase = new PMatrix(field(),mn,mn,1);
+			for (size_t i=0;i<mn;++i)
+				field().assign(SigmaBase->ref(i,i,0),field().one);
+			size_t deg=0;
+
+			OrderBasis<Field> SB(field());
+			PolynomialMatrixMulDomain<Field> PMD(field());
+			typename Sequence::const_iterator _iter (_container->begin ());
+
+			// window[i] = U.A^(first+i).V, only the terms which contribute to the
+			// next residual are kept, i.e. those of index >= k-deg(SigmaBase)
+			std::deque<Coefficient> window;
+			size_t first=0;
+
+			const Coefficient Zeromn(field(),m,n);
+			std::vector<Coefficient> current(batch,Zeromn), next(batch,Zeromn);
+			size_t k=0, nb=batch, zeros=0;
+			for (size_t i=0;i<nb;++i, ++_iter)
+				current[i]=*_iter;
+
+			PAR_BLOCK {
+				while (nb>0 && zeros < EARLY_TERM_THRESHOLD) {
+					size_t nb_next= std::min(batch,length-k-nb);
+
+					for (size_t i=0;i<nb;++i)
+						window.push_back(current[i]);
+
+					// the next terms of the sequence are computed while the order
+					// basis is updated with the current ones: the first task only
+					// touches the sequence and next, the second one only reads the
+					// window and does not report, the commentator is not thread safe
+					SYNCH_GROUP(
+						{ TASK(MODE(REFERENCE(next,_iter) READ(nb_next)),
+						{
+							for (size_t i=0;i<nb_next;++i, ++_iter)
+								next[i]=*_iter;
+						})}
+						{ TASK(MODE(CONSTREFERENCE(window) REFERENCE(SigmaBase,shift,deg,zeros,SB,PMD) READ(nb,k,first,m,n,mn)),
+						{
+							// residual of SigmaBase on the terms k..k+nb-1
+							linbox_check(deg<=k);
+							size_t lo=k-deg;
+							PMatrix Serie(field(),mn,n,deg+nb);
+							for (size_t i=0;i<deg+nb;++i){
+								const Coefficient& T=window[lo+i-first];
+								for (size_t j=0;j<m;++j)
+									for (size_t l=0;l<n;++l)
+										field().assign(Serie.ref(j,l,i), T.getEntry(j,l));
+							}
+							if (lo==0)
+								for (size_t j=0;j<n;++j)
+									field().assign(Serie.ref(m+j,j,0),field().one);
+							PMatrix Residual(field(),mn,n,nb);
+							PMD.midproductgen(Residual,*SigmaBase,Serie,true,deg+1,deg+nb);
+
+							// early termination: count the consecutive terms annihilated
+							// by the m rows of SigmaBase with lowest shifted degree
+							std::vector<size_t> rows(mn);
+							for (size_t i=0;i<mn;++i) rows[i]=i;
+							std::stable_sort(rows.begin(),rows.end(),[&shift](size_t a, size_t b){return shift[a]<shift[b];});
+							for (size_t i=0;i<nb;++i){
+								bool nul=true;
+								for (size_t j=0;j<m && nul;++j)
+									for (size_t l=0;l<n && nul;++l)
+										nul=field().isZero(Residual.get(rows[j],l,i));
+								zeros= nul?zeros+1:0;
+							}
+
+							// update the order basis with the one of the residual
+							PMatrix Sigma2(field(),mn,mn,nb+1);
+							size_t d2=SB.PM_Basis(Sigma2,Residual,nb,shift);
+							PMatrix* Sigma = new PMatrix(field(),mn,mn,deg+d2+1);
+							PMD.mul(*Sigma,Sigma2,*SigmaBase);
+							delete SigmaBase;
+							SigmaBase=Sigma;
+							deg+=d2;
+						})}
+					)
+
+					// slide the window
+					k+=nb;
+					size_t lo_next= (deg<=k? k-deg : 0);
+					while (first < lo_next){
+						window.pop_front();
+						++first;
+					}
+					std::swap(current,next);
+					nb=nb_next;
 				}
-				for (size_t j=0;j<m*n;++j)
-					if (!field().isZero(*(res.getPointer()+j)))
-						valid= false;
-            }
-			if (valid)
-				report<<"minpoly is correct\n";
-			else
-				report<<"minpoly is wrong\n";
-#endif
+			}
+
+			commentator().report(Commentator::LEVEL_NORMAL, INTERNAL_DESCRIPTION)
+				<< "online block generator: " << k << " terms used out of " << length
+				<< ", at most " << window.size()+batch << " stored" << std::endl;
+
+			// extract the generator from the m rows of lowest defect
+			getGenerator(lingen, *SigmaBase, shift, m);
+			delete SigmaBase;
 
-#ifdef __PRINT_MINPOLY
-			report<<"MinPoly:=";
-            write_maple(field(),lingen);
-#endif
 			std::vector<size_t> degree(m);
 			for (size_t i=0;i<m;++i)
 				degree[i] = shift[i];
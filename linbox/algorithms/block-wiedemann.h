@@ -140,7 +140,7 @@ namespace LinBox
                                         
                     std::vector<Block> minpoly;
                     std::vector<size_t> degree;
-                    MBD.left_minpoly_rec(minpoly,degree);
+                    MBD.left_minpoly_online(minpoly,degree);
                     //MBD.printTimer();
 
                     // std::cout<<"U:=";
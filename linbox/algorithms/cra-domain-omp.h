@@ -38,6 +38,7 @@
 #endif
 #include <omp.h>
 #include <set>
+#include "linbox/util/tracer.h"
 #include "linbox/algorithms/cra-domain-sequential.h"
 
 namespace LinBox
@@ -72,6 +73,7 @@ namespace LinBox
 			std::vector<IterationResult> ROUNDresults(NN);
 			std::set<Integer> coprimeset;
 
+			LINBOX_TRACE_SCOPE("Parallel OMP CRA");
 			while (! this->Builder_.terminated()) {
 				ROUNDdomains.clear();
 				ROUNDresidues.clear();
@@ -90,6 +92,7 @@ namespace LinBox
 
 #pragma omp parallel for
 				for(size_t i=0;i<NN;++i) {
+					LINBOX_TRACE_SCOPE("Parallel OMP CRA iteration");
 					ROUNDresults[i] = Iteration(ROUNDresidues[i], ROUNDdomains[i]);
 				}
 #pragma omp barrier
@@ -289,8 +289,6 @@ namespace LinBox
 
 			// update den
 			den <<= shift;
-			//update num
-			update_num (num, n, d, shift);
 
 #ifdef DEBUGRC
 			printf ("in iteration\n");
@@ -309,10 +307,17 @@ namespace LinBox
 			printf ("accumulate numerator=\n");
 			printvec (num, n);
 #endif
-			// update r = r * shift - M d
+			// update num and r = r * shift - M d, both only read the digit d
 			double tmp = 2 * mnorm + cblas_dmax (n, r, 1);
-			if (tmp < T) update_r_int (r, n, M, d, shift);
-			else update_r_ll (r, n, M, d, shift);
+			PAR_BLOCK {
+				SYNCH_GROUP(
+					{ TASK(MODE(READ(d,n,shift) READWRITE(num)),
+					       update_num (num, n, d, shift);); }
+					{ TASK(MODE(READ(d,n,shift,M,tmp) READWRITE(r)),
+					       if (tmp < T) update_r_int (r, n, M, d, shift);
+					       else update_r_ll (r, n, M, d, shift);); }
+				);
+			}
 			//update_r_ll (r, n, M, d, shift);
 		} while (den < B);
 
@@ -44,6 +44,7 @@
 
 #include "linbox/util/debug.h"
 #include "linbox/util/commentator.h"
+#include "linbox/util/perf-counters.h"
 #include "linbox/field/archetype.h"
 #include "linbox/field/gf2.h"
 #include "linbox/matrix/sparse-matrix.h"
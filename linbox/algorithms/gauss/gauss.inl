@@ -81,6 +81,7 @@ namespace LinBox
         // In place (LigneA is modified)
         // With reordering (D is a density type. Density is allocated here)
         //    long Ni = LigneA.n_row (), Nj = LigneA.n_col ();
+        LINBOX_PERF_SCOPE("elimination");
         commentator().start ("QLUPin Gaussian elimination with reordering",
                      "IPLR", Ni);
         commentator().report (Commentator::LEVEL_NORMAL, INTERNAL_DESCRIPTION)
@@ -499,6 +500,7 @@ namespace LinBox
         // In place (LigneA is modified)
         // With reordering (D is a density type. Density is allocated here)
         //    long Ni = LigneA.n_row (), Nj = LigneA.n_col ();
+        LINBOX_PERF_SCOPE("elimination");
         commentator().start ("IPLR Gaussian elimination with reordering",
                      "IPLR", Ni);
         field().write( commentator().report (Commentator::LEVEL_NORMAL, INTERNAL_DESCRIPTION)
@@ -641,6 +643,7 @@ namespace LinBox
         // In place (LigneA is modified)
         // With reordering (D is a density type. Density is allocated here)
         //    long Ni = LigneA.n_row (), Nj = LigneA.n_col ();
+        LINBOX_PERF_SCOPE("elimination");
         commentator().start ("IPperm Gaussian elimination with reordering",
                      "IPLR", Ni);
         field().write( commentator().report (Commentator::LEVEL_NORMAL, INTERNAL_DESCRIPTION)
@@ -791,6 +794,7 @@ namespace LinBox
         // Without reordering (Pivot is first non-zero in row)
         //     long Ni = SLA.n_row (), Nj = SLA.n_col ();
         //    long Ni = LigneA.n_row (), Nj = LigneA.n_col ();
+        LINBOX_PERF_SCOPE("elimination");
         commentator().start ("Gaussian elimination (no reordering)",
                      "NoRe", Ni);
         commentator().report (Commentator::LEVEL_NORMAL, INTERNAL_DESCRIPTION)
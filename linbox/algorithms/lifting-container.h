@@ -44,6 +44,8 @@
 #include "linbox/algorithms/blackbox-block-container.h"
 #include "linbox/algorithms/block-massey-domain.h"
 #include "linbox/algorithms/gauss.h"
+#include "linbox/algorithms/triangular-solve-levels.h"
+#include "linbox/matrix/permutation-matrix.h"
 #include "linbox/vector/vector-domain.h"
 #include "linbox/blackbox/compose.h"
 #include "linbox/blackbox/block-hankel-inverse.h"
@@ -173,7 +175,7 @@ namespace LinBox
 			this->_intRing.init(_numbound,N);
 			this->_intRing.init(_denbound,D);
 
-			_MAD.setup( Prime );
+			_MAD.calibrate( Prime );
 
 #ifdef DEBUG_LC
 			std::cout<<"lifting container initialized\n";
@@ -951,7 +953,15 @@ namespace LinBox
 	}; // end of class WiedemannLiftingContainerBase
 
 
-	/// Block Hankel LiftingContianer.
+	/** Block Hankel LiftingContainer.
+	 *
+	 * Each digit is \f$K_V H^{-1} K_U D r \bmod p\f$ where \f$K_U\f$ and
+	 * \f$K_V\f$ are the block Krylov matrices of Ap for the block diagonal
+	 * projections U and V, and Hinv the inverse of the block Hankel matrix
+	 * \f$K_U Ap K_V\f$. Ap may be larger than A, the extra rows being an
+	 * identity block, residues are then padded by zeros and the padding of
+	 * the digits is dropped.
+	 */
 	template <class _Ring, class _Field, class _IMatrix, class _FMatrix, class _Block>
 	class BlockHankelLiftingContainer : public LiftingContainerBase< _Ring, _IMatrix> {
 
@@ -974,6 +984,8 @@ namespace LinBox
 		const Field                     *_field;
 		mutable FVector                  _res_p;
 		mutable FVector                _digit_p;
+		// workspace of nextdigit, allocated once
+		mutable FVector             _w0, _w1, _z0, _z1;
 		std::vector<std::vector<Element> >   _u;
 		std::vector<std::vector<Element> >   _v;
 		size_t                           _block;
@@ -999,29 +1011,27 @@ namespace LinBox
 					     const Block&      V,
 					     const VectorIn&   b,
 					     const Prime_Type& p) :
-			LiftingContainerBase<Ring,IMatrix> (R,A,b,p), _Ap(Ap), _Hinv(Hinv), _field(&F),
-			_res_p(b.size()), _digit_p(A.coldim()),  _block(U.rowdim()), _numblock(A.coldim()/_block) , _VD(F), _BMD(F), _diagMat(D)
+			LiftingContainerBase<Ring,IMatrix> (R,A,b,p), _Ap(Ap), _diagMat(D), _Hinv(Hinv), _field(&F),
+			_res_p(Ap.rowdim(), F.zero), _digit_p(Ap.coldim(), F.zero),
+			_w0(Ap.rowdim(), F.zero), _w1(Ap.rowdim(), F.zero),
+			_z0(Ap.rowdim(), F.zero), _z1(Ap.rowdim(), F.zero),
+			_block(U.rowdim()), _numblock(Ap.coldim()/_block) , _VD(F), _BMD(F)
 		{
+			linbox_check(Ap.coldim() == _block*_numblock);
+			linbox_check(Ap.rowdim() >= A.rowdim());
 			tApplyU.clear();
 			tApplyH.clear();
 			tApplyV.clear();
-			for (size_t i=0; i< _res_p.size(); ++i)
-				field().init(_res_p[i]);
-			for (size_t i=0; i< _digit_p.size(); ++i)
-				field().init(_digit_p[i]);
-
-			// size_t block= U.rowdim();
 
 			_u.resize(_block, std::vector<Element>(_numblock));
 			_v.resize(_block, std::vector<Element>(_numblock));
 
 			for (size_t i=0;i<_block;++i)
 				for (size_t j=0;j<_numblock;++j){
-					field().assign(_u[i][j], U.getEntry(0, i*_numblock+j));
+					field().assign(_u[i][j], U.getEntry(i, i*_numblock+j));
 					field().assign(_v[i][j], V.getEntry(i*_numblock+j, i));
 				}
 
-			//Ap.write(std::cout,F);
 #ifdef RSTIMING
 			ttGetDigit.clear();
 			ttGetDigitConvert.clear();
@@ -1050,21 +1060,29 @@ namespace LinBox
 
 	protected:
 
+		// z0[j*block+i] = u_i . (i-th slice of w), for the j-th Krylov vector w
+		void projectU(size_t j, const FVector& w) const
+		{
+			for (size_t i=0; i<_block; ++i){
+				Element& z = _z0[j*_block+i];
+				field().assign(z, field().zero);
+				const Element* wi = &w[i*_numblock];
+				for (size_t k=0;k<_numblock;++k)
+					field().axpyin(z, _u[i][k], wi[k]);
+			}
+		}
+
 		virtual IVector& nextdigit(IVector& digit, const IVector& residu) const
 		{
 #ifdef RSTIMING
 			tGetDigitConvert.start();
 #endif
-			//LinBox::integer tmp;
-
 			Hom<Ring, Field> hom(this->_intRing, field());
-			// res_p =  residu mod p
-			//VectorHom::map (_res_p, residu, field(), this->_intRing);
+			// res_p =  residu mod p, the padding stays zero
 			{
 				typename FVector::iterator iter_p = _res_p.begin();
 				typename IVector::const_iterator iter = residu.begin();
 				for ( ;iter != residu. end(); ++iter, ++iter_p)
-					//field(). init (*iter_p, this->_intRing.convert(tmp,*iter));
 					hom.image(*iter_p, *iter);
 			}
 #ifdef RSTIMING
@@ -1074,8 +1092,8 @@ namespace LinBox
 #endif
 
 			/* compute the solution of :
-			 * _Ap^(-1).residu mod p = [V^T AV^T ... A^k]^T . Hinv
-			 * . [U^T U^TA ... U^TA^k]^T residue mod p
+			 * _Ap^(-1).D.residu mod p = [V AV ... A^k V] . Hinv
+			 * . [U^T (UA)^T ... (UA^k)^T]^T D.residue mod p
 			 * with k= numblock -1
 			 */
 #ifdef RSTIMING
@@ -1083,55 +1101,25 @@ namespace LinBox
 			tAcc.start();
 #endif
 
-#if 0
-			std::cout<<"b:=<";
-			for (size_t i=0;i<_res_p.size()-1;++i)
-				field().write(std::cout,_res_p[i])<<",";
-			field().write(std::cout,_res_p[_res_p.size()-1])<<">;\n";
-#endif
-
-			size_t n = _Ap.coldim();
-			// compute z0 = [U^T U^T Ap^T ... U^T Ap^k]^T . residue mod p
-			FVector z0(n), b0(n), b1(n);
-			_diagMat.apply(b0, _res_p);
-			_res_p=b0;
-			BlasMatrix<Field> Apib(field(),n, _numblock);
-			for (size_t i=0;i<n;++i){
-				field().assign(Apib.refEntry(i,0), _res_p[i]);
+			// z0 = [U^T (U Ap)^T ... (U Ap^k)^T]^T . D.residue mod p
+			_diagMat.apply(_w0, _res_p);
+			projectU(0, _w0);
+			for (size_t j=1; j<_numblock; ++j){
+				_Ap.apply(_w1, _w0);
+				std::swap(_w0, _w1);
+				projectU(j, _w0);
 			}
 
-			int swi=1;
-			for (size_t j=1; j<_numblock; ++j)
-				if (swi){
-					_Ap.apply(b1, b0);
-					for (size_t i=0;i<n;++i)
-						field().assign(Apib.refEntry(i,j), b1[i]);
-					swi=0;
-				}
-				else{
-					_Ap.apply(b0, b1);
-					for (size_t i=0;i<n;++i)
-						field().assign(Apib.refEntry(i,j), b0[i]);
-					swi=1;
-				}
-
-			FVector tmp(_numblock);
-			for (size_t i=0; i<_block; ++i){
-				BlasMatrix<Field> T(field(),Apib, i*_numblock, 0, _numblock, _numblock);
-				_BMD.mul(tmp, _u[i], T);
-				for (size_t j=0;j<_numblock;++j){
-					this->field().assign(z0[j*_block+i], tmp[j]);
-				}
-			}
 #ifdef RSTIMING
 			tAcc.stop();
 			tApplyU+=tAcc;
 			tAcc.clear();
 			tAcc.start();
 #endif
+
 			// compute z1 = Hinv.z0
-			FVector z1(n);
-			_Hinv.apply(z1, z0);
+			_Hinv.apply(_z1, _z0);
+
 #ifdef RSTIMING
 			tAcc.stop();
 			tApplyH+=tAcc;
@@ -1139,54 +1127,35 @@ namespace LinBox
 			tAcc.start();
 #endif
 
-#if 0
-			   std::cout<<" Hinv U b mod p done\n";
-			   std::cout<<"\n y:=<";
-			   for (size_t i=0;i<_digit_p.size()-1;++i)
-			   field().write(std::cout,z1[i])<<",";
-			   field().write(std::cout,z1[_digit_p.size()-1])<<">;\n";
-#endif
-
-			// compute digit_p  = [V^T AV^T ... A^k]^T.z1
-			FVector b_bar(n), b_hat(_numblock);
-			for (size_t i=0;i<n;++i)
+			// compute digit_p  = [V AV ... A^k V].z1 by Horner's rule
+			for (size_t i=0;i<_digit_p.size();++i)
 				field().assign(_digit_p[i], field().zero);
 
-			for (int i= _numblock-1;i>=0; --i){
-				_Ap.apply(b1, _digit_p);
-				_digit_p=b1;
-				for (size_t j=0;j<_block;++j){
-					_VD.mul(b_hat, _v[j], z1[i*_block+j]);
+			for (size_t j= _numblock; j-- > 0; ){
+				if (j+1 < _numblock) {
+					_Ap.apply(_w1, _digit_p);
+					std::swap(_digit_p, _w1);
+				}
+				for (size_t i=0;i<_block;++i){
+					const Element& c = _z1[j*_block+i];
+					Element* di = &_digit_p[i*_numblock];
 					for (size_t k=0;k<_numblock;++k)
-						field().assign(b_bar[j*_numblock+k], b_hat[k]);
+						field().axpyin(di[k], _v[i][k], c);
 				}
-				_VD.addin(_digit_p, b_bar);
 			}
+
 #ifdef RSTIMING
 			tAcc.stop();
 			tApplyV+=tAcc;
-#endif
-
-#if 0
-			   std::cout<<" V Hinv U b mod p done\n";
-			   std::cout<<"\n x:=<";
-			   for (size_t i=0;i<_digit_p.size()-1;++i)
-			   field().write(std::cout,_digit_p[i])<<",";
-			   field().write(std::cout,_digit_p[_digit_p.size()-1])<<">;\n";
-#endif
-
-#ifdef RSTIMING
 			tGetDigit.stop();
 			ttGetDigit+=tGetDigit;
 			tGetDigitConvert.start();
 #endif
-			// digit = digit_p
-			//VectorHom::map(digit, _digit_p, this->_intRing, field());
+			// digit = digit_p, without the padding
 			{
 				typename FVector::const_iterator iter_p = _digit_p.begin();
 				typename IVector::iterator iter = digit.begin();
-				for ( ; iter_p!= _digit_p.end(); ++iter_p, ++iter)
-					//this->_intRing.init(*iter, field().convert(tmp,*iter_p));
+				for ( ; iter!= digit.end(); ++iter_p, ++iter)
 					hom.preimage(*iter, *iter_p);
 			}
 
@@ -1213,6 +1182,7 @@ namespace LinBox
 		typedef typename IMatrix::Element          Integer_t;
 		typedef BlasVector<Ring>               IVector;
 		typedef BlasVector<Field>               FVector;
+		typedef BlasMatrix<Field>               FBlock;
 
 	protected:
 
@@ -1224,7 +1194,15 @@ namespace LinBox
 		const Field                     *_field;
 		mutable FVector                  _res_p;
 		mutable FVector                _digit_p;
-		GaussDomain<Field>                  _GD;
+		// L and U are scheduled once, each digit reuses the level sets
+		SparseTriangularSolver<Field>    _Lsolve;
+		SparseTriangularSolver<Field>    _Usolve;
+		// Q^T and P^T as gathers of the entries, or of the rows of a block
+		IndexPermutation<size_t>           _Qt;
+		IndexPermutation<size_t>           _Pt;
+		mutable FVector                      _y;
+		mutable FVector                      _v;
+		mutable FVector                      _w;
 
 
 	public:
@@ -1242,7 +1220,11 @@ namespace LinBox
 					  const VectorIn&    b,
 					  const Prime_Type&  p) :
 			LiftingContainerBase<Ring,IMatrix> (R,A,b,p), LL(L),UU(U),QQ(Q), PP(P), _rank(rank),
-			_field(&F), _res_p(F,b.size()), _digit_p(F,A.coldim()), _GD(F)
+			_field(&F), _res_p(F,b.size()), _digit_p(F,A.coldim()),
+			_Lsolve(L, SparseTriangularSolver<Field>::lower),
+			_Usolve(U, SparseTriangularSolver<Field>::upper, rank),
+			_Qt(transposedIndices(Q)), _Pt(transposedIndices(P)),
+			_y(F,U.rowdim()), _v(F,U.rowdim()), _w(F,U.coldim())
 		{
 			for (size_t i=0; i< _res_p.size(); ++i)
 				field().init(_res_p[i]);
@@ -1256,8 +1238,32 @@ namespace LinBox
 		// return the field
 		const Field& field() const { return *_field; }
 
+		/** Solve A.X = B mod p for a block of right hand sides, with the
+		 * Q.L.U.P factorization and the level schedules of the digits.
+		 * The columns of X beyond the rank are zero, as for the digits.
+		 */
+		FBlock& solveModp(FBlock& X, const FBlock& B) const
+		{
+			linbox_check(B.rowdim() == UU.rowdim() && X.rowdim() == UU.coldim() && X.coldim() == B.coldim());
+			FBlock Y(field(), UU.rowdim(), B.coldim()), V(field(), UU.rowdim(), B.coldim());
+			FBlock W(field(), UU.coldim(), B.coldim());
+			// the rows of B in the order of Q^T, then of X in the order of P^T
+			_Qt.applyLeft(Y, B);
+			_Lsolve.solve(V, Y);
+			_Usolve.solve(W, V);
+			return _Pt.applyLeft(X, W);
+		}
+
 	protected:
 
+		static IndexPermutation<size_t> transposedIndices(const Permutation<_Field>& P)
+		{
+			std::vector<size_t> g(P.getStorage().begin(), P.getStorage().end());
+			IndexPermutation<size_t> T(g);
+			T.Invert();
+			return T;
+		}
+
 		virtual IVector& nextdigit(IVector& digit, const IVector& residu) const
 		{
 
@@ -1270,9 +1276,11 @@ namespace LinBox
 					hom.image(*iter_p, *iter);
 			}
 
-                        FVector w(field(), UU.coldim());
-			// solve the system mod p using L.Q.U.P Factorization
-			_GD.solve(_digit_p, w, _rank, QQ,LL,UU,PP, _res_p);
+			// solve the system mod p using Q.L.U.P Factorization
+			_Qt.apply(_y, _res_p);
+			_Lsolve.solve(_v, _y);
+			_Usolve.solve(_w, _v);
+			_Pt.apply(_digit_p, _w);
 
                         // promote new solution mod p to integers
 			{
@@ -31,6 +31,7 @@
 
 #include "linbox/linbox-config.h"
 #include "linbox/util/error.h"
+#include "linbox/util/perf-counters.h"
 
 #include "fflas-ffpack/fflas/fflas_simd.h"
 
@@ -69,6 +70,7 @@ namespace LinBox {
              */
             void
             FFT_direct (Element *coeffs) const {
+                LINBOX_PERF_SCOPE("FFT");
                 this->DIF (coeffs); /* or DIT_reversed */
             }
 
@@ -82,6 +84,7 @@ namespace LinBox {
              */
             void
             FFT_inverse (Element *coeffs) const {
+                LINBOX_PERF_SCOPE("FFT");
                 this->DIT (coeffs); /* or DIF_reversed */
             }
 
@@ -44,8 +44,14 @@
 #include <fstream>
 #include <chrono>
 #include "fflas-ffpack/fflas-ffpack.h"
+#include "linbox/util/timer.h"
 #define MBASIS_THRESHOLD_LOG 5
 #define MBASIS_THRESHOLD (1<<MBASIS_THRESHOLD_LOG)
+// minimal size of a polynomial matrix product in PM-Basis before it is
+// split into horizontal slices computed by concurrent tasks
+#ifndef PMBASIS_PAR_THRESHOLD
+#define PMBASIS_PAR_THRESHOLD 128
+#endif
 
 
 
@@ -185,6 +191,8 @@ namespace LinBox {
                 PolynomialMatrixMulDomain<Field>   _PMD;
                 BlasMatrixDomain<Field>            _BMD;
                 ET                           _EarlyStop;
+                size_t                         _threads; // thread budget for the polynomial matrix products
+                size_t                _mbasis_threshold; // recursion cutoff from PM-Basis to M-Basis
         public:
 #if  defined(PROFILE_PMBASIS) or defined(__CHECK_MBASIS) or defined(__CHECK_PMBASIS)
                 size_t _idx=0;
@@ -193,11 +201,53 @@ namespace LinBox {
                 std::chrono::time_point<std::chrono::system_clock> _start, _end;
                 bool _started=false;
 #endif
-                OrderBasis(const Field& f) : _field(&f), _PMD(f), _BMD(f) {                 
+                OrderBasis(const Field& f, size_t threads=1) :
+                        _field(&f), _PMD(f), _BMD(f), _threads(threads?threads:1), _mbasis_threshold(MBASIS_THRESHOLD) {
                 }
 
                 inline const Field& field() const {return *_field;}
 
+                void   setThreads(size_t t)   {_threads=(t?t:1);}
+                size_t getThreads() const     {return _threads;}
+                void   setThreshold(size_t t) {_mbasis_threshold=(t?t:1);}
+                size_t getThreshold() const   {return _mbasis_threshold;}
+
+                // Measure M-Basis against one level of PM-Basis on random series of
+                // dimension m x n for increasing orders, and set the recursion cutoff
+                // to the largest order for which M-Basis is still the fastest.
+                size_t tuneThreshold(size_t m, size_t n, size_t maxorder=1024){
+                        typename Field::RandIter G(field());
+                        size_t best=1;
+                        for (size_t ord=8; ord<=maxorder; ord<<=1){
+                                PMatrix serie(field(),m,n,ord);
+                                for (size_t i=0;i<m*n;i++)
+                                        for (size_t k=0;k<ord;k++)
+                                                G.random(serie.ref(i,k));
+                                PMatrix sigma1(field(),m,m,ord+1), sigma2(field(),m,m,ord+1);
+                                std::vector<size_t> shift1(m,0), shift2(m,0);
+                                Timer chrono;
+
+                                _EarlyStop.reset();
+                                chrono.start();
+                                M_Basis(sigma1,serie,ord,shift1);
+                                chrono.stop();
+                                double t_mbasis=chrono.realtime();
+
+                                _EarlyStop.reset();
+                                _mbasis_threshold=ord>>1;
+                                chrono.clear(); chrono.start();
+                                PM_Basis(sigma2,serie,ord,shift2);
+                                chrono.stop();
+                                double t_pmbasis=chrono.realtime();
+
+                                if (t_pmbasis < t_mbasis) break;
+                                best=ord;
+                        }
+                        _EarlyStop.reset();
+                        _mbasis_threshold=best;
+                        return best;
+                }
+
                 // serie must have exactly order elements (i.e. its degree = order-1)
                 // sigma can have at most order+1 elements (i.e. its degree = order)
                 template<typename PMatrix1, typename PMatrix2>
@@ -228,7 +278,7 @@ namespace LinBox {
                         std::chrono::time_point<std::chrono::system_clock> _chrono_start=std::chrono::system_clock::now();
 #endif
                         
-                        if (order <= MBASIS_THRESHOLD) {
+                        if (order <= _mbasis_threshold) {
 #if defined (PROFILE_PMBASIS) or defined(__CHECK_PMBASIS)
                                 _idx+=order;
 #endif
@@ -276,7 +326,7 @@ namespace LinBox {
 #ifdef MEM_PMBASIS
                                 std::cerr<<"[PM-Basis ("<<order<<") "<<_idx<<"/"<<_target<<"] [Serie2] -> "<<MB(serie2->realmeminfo())<<"Mo"<<MEMINFO2<<std::endl;
 #endif              
-                                _PMD.midproductgen(*serie2, sigma1, serie, true, ord1+1,ord1+ord2);
+                                midproductgen_par(*serie2, sigma1, serie, ord1+1,ord1+ord2);
                                 
 #ifdef PROFILE_PMBASIS
                                 //chrono.stop();
@@ -293,7 +343,7 @@ namespace LinBox {
                                 delete serie2;                                 
 
                                 // compute the result
-                                _PMD.mul(sigma, sigma2, sigma1);
+                                mul_par(sigma, sigma2, sigma1);
                                 sigma.resize(d1+d2+1);                                
 #ifdef PROFILE_PMBASIS
                                 //chrono.stop();
@@ -323,6 +373,89 @@ namespace LinBox {
                                 return d1+d2;
                         }
                 }
+        private:
+                // A <- rows [r0,r0+A.rowdim()[ of B
+                template<typename PMatrix1, typename PMatrix2>
+                static void getRows(PMatrix1 &A, const PMatrix2 &B, size_t r0){
+                        size_t off=r0*B.coldim(), s=std::min(A.size(),B.size());
+                        for (size_t i=0;i<A.rowdim()*A.coldim();i++)
+                                for (size_t k=0;k<s;k++)
+                                        A.ref(i,k)=B.get(off+i,k);
+                }
+                // rows [r0,r0+B.rowdim()[ of A <- B
+                template<typename PMatrix1, typename PMatrix2>
+                static void setRows(PMatrix1 &A, const PMatrix2 &B, size_t r0){
+                        size_t off=r0*A.coldim(), s=std::min(A.size(),B.size());
+                        for (size_t i=0;i<B.rowdim()*B.coldim();i++)
+                                for (size_t k=0;k<s;k++)
+                                        A.ref(off+i,k)=B.get(i,k);
+                }
+
+                // number of horizontal slices used to split a product with
+                // m rows and output size s among the available threads
+                size_t nbSlices(size_t m, size_t s) const {
+                        if (_threads<=1 || s<PMBASIS_PAR_THRESHOLD) return 1;
+                        return std::min(_threads,m);
+                }
+
+        public:
+                // c=a*b, the rows of a (and c) being distributed among the threads;
+                // each task uses its own product domain since the FFT domain
+                // keeps some precomputations that must not be shared
+                template<typename PMatrix1, typename PMatrix2, typename PMatrix3>
+                void mul_par(PMatrix1 &c, const PMatrix2 &a, const PMatrix3 &b){
+                        size_t m=a.rowdim(), nb=nbSlices(m,a.size()+b.size());
+                        if (nb==1){
+                                _PMD.mul(c,a,b);
+                                return;
+                        }
+                        std::vector<size_t> r(nb+1);
+                        for (size_t t=0;t<=nb;t++) r[t]=(t*m)/nb;
+                        PAR_BLOCK {
+                                SYNCH_GROUP(
+                                        for (size_t t=0;t<nb;t++) {
+                                                { TASK(MODE(CONSTREFERENCE(a,b,r) REFERENCE(c)),
+                                                {
+                                                        PolynomialMatrixMulDomain<Field> PMD(field());
+                                                        PMatrix2 a_t(field(),r[t+1]-r[t],a.coldim(),a.size());
+                                                        PMatrix1 c_t(field(),r[t+1]-r[t],c.coldim(),c.size());
+                                                        getRows(a_t,a,r[t]);
+                                                        PMD.mul(c_t,a_t,b);
+                                                        setRows(c,c_t,r[t]);
+                                                })}
+                                        }
+                                )
+                        }
+                }
+
+                // middle product c=(a*b)[n0..n1] with the rows of a (and c)
+                // distributed among the threads
+                template<typename PMatrix1, typename PMatrix2, typename PMatrix3>
+                void midproductgen_par(PMatrix1 &c, const PMatrix2 &a, const PMatrix3 &b, size_t n0, size_t n1){
+                        size_t m=a.rowdim(), nb=nbSlices(m,b.size());
+                        if (nb==1){
+                                _PMD.midproductgen(c,a,b,true,n0,n1);
+                                return;
+                        }
+                        std::vector<size_t> r(nb+1);
+                        for (size_t t=0;t<=nb;t++) r[t]=(t*m)/nb;
+                        PAR_BLOCK {
+                                SYNCH_GROUP(
+                                        for (size_t t=0;t<nb;t++) {
+                                                { TASK(MODE(CONSTREFERENCE(a,b,r) REFERENCE(c)),
+                                                {
+                                                        PolynomialMatrixMulDomain<Field> PMD(field());
+                                                        PMatrix2 a_t(field(),r[t+1]-r[t],a.coldim(),a.size());
+                                                        PMatrix1 c_t(field(),r[t+1]-r[t],c.coldim(),c.size());
+                                                        getRows(a_t,a,r[t]);
+                                                        PMD.midproductgen(c_t,a_t,b,true,n0,n1);
+                                                        setRows(c,c_t,r[t]);
+                                                })}
+                                        }
+                                )
+                        }
+                }
+
                 // serie must have exactly order elements (i.e. its degree = order-1)
                 size_t M_Basis(MatrixP              &sigma,
                                const MatrixP        &serie,
@@ -746,7 +879,7 @@ namespace LinBox {
                         std::chrono::time_point<std::chrono::system_clock> _chrono_start=std::chrono::system_clock::now();
 #endif
                         
-                        if (order <= MBASIS_THRESHOLD) {
+                        if (order <= _mbasis_threshold) {
 #if defined (PROFILE_PMBASIS) or defined(__CHECK_PMBASIS)
                                 _idx+=order;
 #endif
@@ -802,7 +935,7 @@ namespace LinBox {
                                 std::cerr<<"[PM-Basis ("<<order<<") "<<_idx<<"/"<<_target<<"] [ALLOC Serie2] -> "<<MB(serie2_ptr->realmeminfo())<<"Mo"<<MEMINFO2<<std::endl;
 #endif
                                 
-                                _PMD.midproductgen(*serie2_ptr, *sigma1_ptr, *serie_ptr, true, ord1+1,ord1+ord2);
+                                midproductgen_par(*serie2_ptr, *sigma1_ptr, *serie_ptr, ord1+1,ord1+ord2);
 #ifndef __CHECK_PMBASIS
                                 delete serie_ptr; // the initial serie is no more needed (except with checking pmbasis)
 #endif         
@@ -819,7 +952,7 @@ namespace LinBox {
 #ifdef MEM_PMBASIS
                                 std::cerr<<"[PM-Basis ("<<order<<") "<<_idx<<"/"<<_target<<"] [ALLOC Sigma] -> "<<MB(sigma_ptr->realmeminfo())<<"Mo"<<MEMINFO2<<std::endl;
 #endif                                
-                                _PMD.mul(*sigma_ptr, *sigma2_ptr, *sigma1_ptr, d1+d2);
+                                mul_par(*sigma_ptr, *sigma2_ptr, *sigma1_ptr);
                                 //sigma_ptr->resize(d1+d2+1);                                
                                 delete sigma1_ptr;
                                 delete sigma2_ptr;
@@ -33,6 +33,9 @@
 #ifndef __LINBOX_reconstruction_H
 #define __LINBOX_reconstruction_H
 
+#include <vector>
+#include <algorithm>
+
 #include "linbox/linbox-config.h"
 #include "linbox/util/debug.h"
 
@@ -139,7 +142,7 @@ namespace LinBox
 
 			else
 				//return getRational6(num,den, switcher);
-				return getRational1 (num, den);
+				return getRational7 (num, den);
 			//{getRational1(num,den); print (num); std::cout << "Denominator: " << den << "\n";
 			//getRational3(num, den);print (num); std::cout << "Denominator: " << den << "\n";}
 			return 1;
@@ -155,7 +158,7 @@ namespace LinBox
 			//{getRational1(num,den); print (num); std::cout << "Denominator: " << den << "\n";
 			//getRational3(num, den);print (num); std::cout << "Denominator: "  << den << "\n";}
 			else
-				return getRational1 (num, den);
+				return getRational7 (num, den);
 			//{getRational1(num,den); print (num); std::cout << "Denominator: " << den << "\n";
 			//getRational3(num, den);print (num); std::cout << "Denominator: "  << den << "\n"; }
 
@@ -385,6 +388,204 @@ namespace LinBox
 			return true; //lifted ok
 		} // end of getRational1
 
+		/** Reconstruct a vector of rational numbers
+		 *  from p-adic digit vector sequence.
+		 *  An early termination technique is used.
+		 *  Answer is a pair (numerator, common denominator)
+		 *
+		 *  The approximation is only evaluated at geometrically spaced
+		 *  numbers of digits. At each of these checks, the common
+		 *  denominator found so far is reused: every entry is multiplied
+		 *  by it and only the entries which do not give a small numerator
+		 *  are reconstructed (see commonDenominatorCheck). The lifting stops
+		 *  when two consecutive checks agree on the denominator.
+		 */
+		template<class Vector1>
+		bool getRational7(Vector1& num, Integer& den) const
+		{
+
+#ifdef RSTIMING
+			ttRecon.clear();
+			tRecon.start();
+#endif
+			linbox_check(num. size() == (size_t)_lcontainer.size());
+			size_t n   = num. size();
+			size_t len = _lcontainer. length();
+			Integer prime = _lcontainer.prime();
+			const Vector zero(_r,n,_r.zero);
+			std::vector<Vector> digits(len,zero); //Store all p-adic digits
+
+			// approximation mod modulus, only the new digits are evaluated at each check
+			Vector res(_r,n,_r.zero), blk(_r,n,_r.zero);
+			Integer modulus, numbound, denbound, half, two, pk;
+			_r. assign (modulus, _r.one);
+			_r. init (two, int64_t(2));
+
+			// denominator validated at the previous check, zero if none
+			Integer pden;
+			_r. assign (pden, _r.zero);
+			_r. assign (den, _r.one);
+
+			typename LiftingContainer::const_iterator iter = _lcontainer.begin();
+			size_t step = 0, evaluated = 0;
+			size_t next = std::min((size_t)std::max(_threshold,1), len);
+			bool done = false;
+
+#ifdef RSTIMING
+			tRecon.stop();
+			ttRecon+=tRecon;
+#endif
+			while (!done && step < len) {
+
+				// get next p-adic digit
+				if (!iter.next(digits[step])) {
+					commentator().report() <<
+					"ERROR in lifting container. Are you using <double> ring with large norm? (7)" << std::endl;
+					return false;
+				}
+				++step;
+				if (step < next) continue;
+
+				// next check after a quarter more digits, at least _threshold
+				next = std::min(len, step + std::max((size_t)_threshold, step/4));
+
+#ifdef RSTIMING
+				tRecon.start();
+#endif
+				// res += modulus * (new digits evaluated at prime)
+				typename std::vector<Vector>::const_iterator dig = digits.begin()+(ptrdiff_t)evaluated;
+				_r. assign (pk, prime);
+				PolEval (blk, dig, step-evaluated, pk);
+				for (size_t i=0; i<n; ++i)
+					_r. axpyin (res[i], modulus, blk[i]);
+				_r. mulin (modulus, pk);
+				evaluated = step;
+
+				// half of the modulus is shared by the bounds, capped by the true ones
+				_r. div (half, modulus, two);
+				_r. sqrt (numbound, half);
+				_r. assign (denbound, numbound);
+				if (_r. compare(numbound, _lcontainer.numbound()) > 0)
+					_r. assign (numbound, _lcontainer.numbound());
+				if (_r. compare(denbound, _lcontainer.denbound()) > 0)
+					_r. assign (denbound, _lcontainer.denbound());
+
+				bool fresh = _r. isOne (den);
+				bool valid = commonDenominatorCheck (num, den, res, modulus, numbound, denbound);
+				if (!valid && !fresh) {
+					// a factor of den was fake, start again from scratch
+					_r. assign (den, _r.one);
+					valid = commonDenominatorCheck (num, den, res, modulus, numbound, denbound);
+				}
+				if (valid) {
+					done = (step == len) || _r. areEqual (den, pden);
+					_r. assign (pden, den);
+				}
+				else {
+					_r. assign (den, _r.one);
+					_r. assign (pden, _r.zero);
+				}
+#ifdef RSTIMING
+				tRecon.stop();
+				ttRecon+=tRecon;
+#endif
+			}
+
+			if (!done) {
+				commentator().report()
+				<< "ERROR in reconstruction ? (7)\n" << std::endl;
+				return false;
+			}
+			return true; //lifted ok
+		} // end of getRational7
+
+		/*! Checks that \p den is a common denominator of the approximation
+		 * \p res mod \p modulus, i.e. that each res[i]*den mod modulus is a
+		 * numerator bounded by \p numbound. The first entry which fails is
+		 * reconstructed, its denominator enlarges \p den and only the failing
+		 * entries are checked again. On success \p num holds the numerators.
+		 */
+		template<class Vector1>
+		bool commonDenominatorCheck(Vector1& num, Integer& den, const Vector& res,
+					    const Integer& modulus, const Integer& numbound, const Integer& denbound) const
+		{
+			size_t n = res.size();
+			if (_r. compare(den, denbound) > 0) return false;
+
+			std::vector<size_t> pending(n), failed;
+			for (size_t i=0; i<n; ++i) pending[i]=i;
+			std::vector<char> ok(n,0);
+			bool grown = false;
+			Integer t, tmp_num, tmp_den, room;
+
+			while (true) {
+				long np = (long)pending.size();
+#ifdef __LINBOX_USE_OPENMP
+#pragma omp parallel for schedule(dynamic,64)
+#endif
+				for (long k=0; k<np; ++k) {
+					size_t i = pending[(size_t)k];
+					ok[i] = smallNumerator (num[i], res[i], den, modulus, numbound);
+				}
+				failed.clear();
+				for (size_t k=0; k<pending.size(); ++k)
+					if (!ok[pending[k]]) failed.push_back(pending[k]);
+				pending.swap(failed);
+				if (pending.empty()) break;
+
+				// reconstruct the first failing entry of res*den
+				size_t i = pending.front();
+				_r. mul (t, res[i], den);
+				_r. modin (t, modulus);
+				_r. div (room, denbound, den);
+				if (_r. isZero (room))
+					return false;
+				if (!Givaro::Rational::RationalReconstruction(tmp_num, tmp_den, t, modulus, numbound, room))
+					return false;
+				_r. abs (tmp_den, tmp_den);
+				if (_r. isOne (tmp_den))
+					return false;
+				_r. mulin (den, tmp_den);
+				grown = true;
+			}
+
+			// numerators found before the last enlargement of den are outdated
+			if (grown) {
+				long nn = (long)n;
+#ifdef __LINBOX_USE_OPENMP
+#pragma omp parallel for schedule(dynamic,64)
+#endif
+				for (long k=0; k<nn; ++k)
+					ok[(size_t)k] = smallNumerator (num[(size_t)k], res[(size_t)k], den, modulus, numbound);
+				for (size_t k=0; k<n; ++k)
+					if (!ok[k]) return false;
+			}
+			return true;
+		}
+
+		/*! a = x*den mod modulus in symmetric representation.
+		 * @return whether |a| < numbound
+		 */
+		template<class Elt>
+		bool smallNumerator(Elt& a, const Integer& x, const Integer& den,
+				    const Integer& modulus, const Integer& numbound) const
+		{
+			Integer tmp, neg;
+			_r. mul (tmp, x, den);
+			_r. modin (tmp, modulus);
+			if (_r. compare(tmp, numbound) < 0) {
+				_r. assign (a, tmp);
+				return true;
+			}
+			_r. sub (neg, tmp, modulus);
+			_r. abs (tmp, neg);
+			if (_r. compare(tmp, numbound) < 0) {
+				_r. assign (a, neg);
+				return true;
+			}
+			return false;
+		}
+
 		/** Reconstruct a vector of rational numbers
 		 *  from p-adic digit vector sequence.
 		 *  An early termination technique is used.
@@ -198,7 +198,7 @@ namespace LinBox {
 			do{
 			int ret;
 				//tt.clear(); tt.start();
-				ret = rat_sol(numx, denx, xs_int, xs_frac, bi, lastb, r, lastr, x, bound, M);
+				ret = rat_sol(numx, denx, xs_int, xs_frac, bi, lastb, r, lastr, x, bound, M, DM);
 				//tt.stop(); solve_timer += tt;
 
 				if(ret == 1){
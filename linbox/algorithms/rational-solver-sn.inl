@@ -70,7 +70,7 @@ int zw_shift(NumericSolver & NS_S, size_t n, FVector &r, FVector &x)
 }
 
 template <class IMatrix>
-int rat_sol(IVector& numx, Int& denx, FVector& xs_int, FVector& xs_frac, IVector &b, IVector &lastb, FVector& r, FVector& lastr, FVector& x, integer &loopBound, IMatrix &IM) {
+int rat_sol(IVector& numx, Int& denx, FVector& xs_int, FVector& xs_frac, IVector &b, IVector &lastb, FVector& r, FVector& lastr, FVector& x, integer &loopBound, IMatrix &IM, const FMatrix &DM) {
 
 	debug("Matrix norm: " << mnorm);
 	int thresh_expt = 1;  // consider as low as 1 or 2 (at least when n large)
@@ -87,6 +87,9 @@ int rat_sol(IVector& numx, Int& denx, FVector& xs_int, FVector& xs_frac, IVector
 	//  need to save original r for zw_shift calculation
 	//  TODO: I took out the ZWSHIFT, still need last r??
 
+	// digits of the last hit, accumulated into numx while the next residual is computed
+	FVector xs_acc(field(),n);
+
 	if(denx == 1){
 		// compute first approximate solution x
 		_numsolver.solve(x, r);
@@ -96,7 +99,7 @@ int rat_sol(IVector& numx, Int& denx, FVector& xs_int, FVector& xs_frac, IVector
 		copy(b.begin(), b.end(), lastb.begin());
 		//-- compute xs_int, xs_frac, r (residue)
 		update_xs(xs_int, xs_frac, x);
-		if(exact_apply) update_r_exact(b, r, xs_int, IM);
+		if(exact_apply) update_r_exact(b, r, xs_int, IM, DM);
 		else update_r(r, xs_int);
 	}
 
@@ -130,22 +133,35 @@ int rat_sol(IVector& numx, Int& denx, FVector& xs_int, FVector& xs_frac, IVector
 		if (q < threshold) {
 			HIT++;
 			// update numx and denx
-			denx <<= (uint64_t)shift; // PG : shift is not defined !!!!
-			update_num (numx, xs_int);
+			size_t hit_shift = shift;
+			denx <<= (uint64_t)hit_shift;
+			swap(xs_acc, xs_int);
 
-			if(_VDF.isZero(r))
+			if(_VDF.isZero(r)) {
+				update_num (numx, xs_acc, hit_shift);
 				return 2;
+			}
 
 			// consider increasing the shift for next iteration
 			upshift();
 
-			// make x = nextx, then compute new residual, xs_int, xs_frac
-			swap(x, nextx);
-			copy(r.begin(), r.end(), lastr.begin());
-			copy(b.begin(), b.end(), lastb.begin());
-			update_xs(xs_int, xs_frac, x);
-			if(exact_apply) update_r_exact(b, r, xs_int, IM);
-			else update_r(r, xs_int);
+			// the numerator update only depends on the digits of this hit:
+			// overlap it with the new residual, xs_int, xs_frac
+			PAR_BLOCK {
+				SYNCH_GROUP(
+					{ TASK(MODE(READ(xs_acc,hit_shift) READWRITE(numx)),
+					       update_num (numx, xs_acc, hit_shift);); }
+					{ TASK(MODE(READWRITE(x,nextx,r,lastr,b,lastb,xs_int,xs_frac)),
+					       // make x = nextx, then compute new residual, xs_int, xs_frac
+					       swap(x, nextx);
+					       copy(r.begin(), r.end(), lastr.begin());
+					       copy(b.begin(), b.end(), lastb.begin());
+					       update_xs(xs_int, xs_frac, x);
+					       if(exact_apply) update_r_exact(b, r, xs_int, IM, DM);
+					       else update_r(r, xs_int););
+					}
+				);
+			}
 		}
 		else {  //  q >= threshold, back-off
 			MISS++;
@@ -166,7 +182,7 @@ int rat_sol(IVector& numx, Int& denx, FVector& xs_int, FVector& xs_frac, IVector
 			copy(lastr.begin(), lastr.end(), r.begin());
 			copy(lastb.begin(), lastb.end(), b.begin());
 			update_xs(xs_int, xs_frac, x);
-			if(exact_apply) update_r_exact(b, r, xs_int, IM);
+			if(exact_apply) update_r_exact(b, r, xs_int, IM, DM);
 			else update_r(r, xs_int);
 		}
 	}
@@ -279,7 +295,7 @@ inline void update_r(FVector& r, FVector& xs_int)
 } // update_r
 
 template <class IMatrix>
-inline void update_r_exact(IVector& r_exact, FVector& r, FVector& xs_int, IMatrix &IM){
+inline void update_r_exact(IVector& r_exact, FVector& r, FVector& xs_int, IMatrix &IM, const FMatrix &DM){
 	size_t n = r.size();
 
 	IVector x_i(_ring,n), y_i(_ring,n);
@@ -307,6 +323,9 @@ inline void update_r_exact(IVector& r_exact, FVector& r, FVector& xs_int, IMatri
 		for(size_t i = 0; i < n; ++i)
 			_ring.init(y_i[i], y[i]);
 	}
+	else if (limb_apply(y_i, xs_int, DM)) {
+		debugneol("Limbs ");
+	}
 	else{
 		SHIFT_BOUND--; // to less this possibility
 		debugneol("Exact ");
@@ -326,15 +345,68 @@ inline void update_r_exact(IVector& r_exact, FVector& r, FVector& xs_int, IMatri
 	return;
 } // update_r_exact
 
-//update num, *num <- *num * 2^shift + d
-inline IVector& update_num (IVector& num, const FVector& d)
+/* y = M x exactly, for x integral, using the double image DM of M.
+ * x is split in limbs of k bits, with 2^k * ||M||_oo < 2^52, so that every
+ * product by a limb is exact in double. All the limbs are applied by one
+ * dgemm and recombined in the ring row by row.
+ * Returns false if the matrix entries are too large for any limb.
+ */
+inline bool limb_apply(IVector& y, const FVector& x, const FMatrix& DM)
+{
+	size_t n = x.size();
+	size_t bits = 0;
+	for(size_t mn2 = nextPower2((size_t)mnorm); mn2; mn2>>=1, bits++);
+	if (bits >= 52) return false;
+	int k = (int)(52 - bits);
+	double base = ldexp(1.0, k);
+
+	// number of limbs of the largest entry
+	double xmax = zw_dmax((int)n, &*x.begin(), 1);
+	size_t nl = 1;
+	for (double top = base; top <= xmax; top *= base) ++nl;
+
+	// X(i,l) is the l-th signed limb of x[i]
+	std::vector<double> X(n*nl), Y(n*nl);
+	for (size_t i = 0; i < n; ++i) {
+		double a = fabs(x[i]);
+		double s = (x[i] < 0) ? -1.0 : 1.0;
+		for (size_t l = 0; l < nl; ++l) {
+			double q = floor(a / base);
+			X[i*nl+l] = s * (a - q * base);
+			a = q;
+		}
+	}
+
+	cblas_dgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, (int)n, (int)nl, (int)n,
+		    1.0, DM.getPointer(), (int)DM.getStride(), &X[0], (int)nl, 0.0, &Y[0], (int)nl);
+
+	Int scalar; _ring.init(scalar, uint64_t(1) << k);
+	long ln = (long)n;
+#ifdef __LINBOX_USE_OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+	for (long i = 0; i < ln; ++i) {
+		const double* Yi = &Y[(size_t)i*nl];
+		Int limb;
+		_ring.init(y[(size_t)i], Yi[nl-1]);
+		for (size_t l = nl-1; l > 0; --l) {
+			_ring.mulin(y[(size_t)i], scalar);
+			_ring.init(limb, Yi[l-1]);
+			_ring.addin(y[(size_t)i], limb);
+		}
+	}
+	return true;
+} // limb_apply
+
+//update num, *num <- *num * 2^s + d
+inline IVector& update_num (IVector& num, const FVector& d, size_t s)
 {
 	size_t n = d.size();
 	IVector d_i(_ring,n);
 	for (size_t i = 0; i < n; ++i) {
 		_ring.init(d_i[i], d[i]);
 	}
-	Int scalar; _ring.init(scalar, uint64_t(1 << shift));
+	Int scalar; _ring.init(scalar, uint64_t(1) << s);
 	//  TODO - analyze GMP shifting capability
 	_VDR.mulin(num, scalar);
 	_VDR.addin(num, d_i);
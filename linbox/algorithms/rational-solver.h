@@ -33,6 +33,7 @@
 #define __LINBOX_rational_solver_H
 
 #include <iostream>
+#include <cmath>
 
 #include "linbox/linbox-config.h"
 #include "linbox/util/debug.h"
@@ -46,6 +47,10 @@
 #include "linbox/algorithms/vector-fraction.h"
 #include "linbox/util/timer.h"
 
+#ifdef __LINBOX_USE_OPENMP
+#include <omp.h>
+#endif
+
 //#define RSTIMING
 
 namespace LinBox
@@ -615,7 +620,18 @@ namespace LinBox {
 	/*--------------*/
 
 	/*! Block Hankel.
-	 * NO DOC
+	 *
+	 * Dixon lifting for sparse nonsingular systems where the inverse modulo
+	 * p is \f$K_V H^{-1} K_U\f$, \f$K_U\f$ and \f$K_V\f$ being the block
+	 * Krylov matrices of a random diagonal preconditioning of A for block
+	 * diagonal projections U and V, and H the block Hankel matrix
+	 * \f$K_U A K_V\f$. The Krylov sequence and the inverse of H are
+	 * computed once per prime, then each digit costs 2n/s sparse
+	 * matrix-vector products and one block Hankel product.
+	 *
+	 *   @bib
+	 *   - Eberly, Giesbrecht, Giorgi, Storjohann, Villard <i>Solving sparse
+	 *   rational linear systems.</i> ISSAC 2006.
 	 */
 	template<class Ring, class Field,class RandomPrime>
 	class DixonSolver<Ring, Field, RandomPrime, Method::BlockHankel> {
@@ -626,7 +642,7 @@ namespace LinBox {
 		typedef typename RandomPrime::Prime_Type     Prime;
 
 	protected:
-		RandomPrime                     _genprime;
+		mutable RandomPrime             _genprime;
 		mutable Prime                   _prime;
 		Ring                            _ring;
 
@@ -660,11 +676,33 @@ namespace LinBox {
         }
 
 
-		// solve non singular system
+		/** Solve a nonsingular sparse system.
+		 * @param blocksize the block size s, 0 to choose it with blockingFactor().
+		 * The system is padded with an identity block up to a multiple of s.
+		 * @param maxPrimes number of primes tried when the projections fail
+		 */
 		template<class IMatrix, class Vector1, class Vector2>
 		SolverReturnStatus solveNonsingular(Vector1& num, Integer& den,
 						    const IMatrix& A, const Vector2& b,
 						    size_t blocksize, int maxPrimes = DEFAULT_MAXPRIMES) const;
+
+		/** Block size for an n x n matrix with nnz nonzero entries.
+		 * Per digit, 2n/s sparse products of cost nnz balance a block
+		 * Hankel product of about s.n.log(n) operations. The sequence
+		 * costs 2n/s block products of width s whose rows are shared by
+		 * the threads, so s is at least the number of threads, and at
+		 * most sqrt(n) so that the Hankel matrix has at least s blocks.
+		 */
+		static size_t blockingFactor(size_t n, size_t nnz)
+		{
+			double logn = std::max(1., std::log2((double)n));
+			size_t s = (size_t)std::sqrt((double)nnz / logn);
+#ifdef __LINBOX_USE_OPENMP
+			s = std::max(s, (size_t)omp_get_max_threads());
+#endif
+			s = std::min(s, (size_t)std::sqrt((double)n));
+			return std::max(s, size_t(1));
+		}
 	};
 
 
@@ -48,6 +48,7 @@
 #include <fflas-ffpack/fflas/fflas.h>
 #include "linbox/solutions/methods.h"
 #include "linbox/blackbox/block-hankel-inverse.h"
+#include "linbox/blackbox/sparse-blockbb.h"
 
 #include "linbox/vector/blas-vector.h"
 
@@ -487,80 +488,94 @@ namespace LinBox
 	{
 
 		linbox_check(A.rowdim() == A.coldim());
-		linbox_check(A.rowdim() % blocksize == 0);
+		linbox_check(A.rowdim() == b.size());
 
-		// reduce the matrix mod p
-		Field F(_prime);
 		typedef typename IMatrix::template rebind<Field>::other FMatrix;
-		FMatrix Ap(A, F);
-
-		// precondition Ap  with a random diagonal Matrix
-		typename Field::RandIter G(F,0,123456);
-		BlasVector<Field> diag(F,Ap.rowdim());
-
-		for(size_t i=0;i<Ap.rowdim();++i){
-			do {
-				G.random(diag[i]);
-			} while(F.isZero(diag[i]));
-		}
-
-
-
-		Diagonal<Field> D(diag);
-
-		Compose<Diagonal<Field>, FMatrix> DAp(D,Ap);
+		typedef SparseBlockBB<Field> KrylovMatrix;
+		typedef BlackboxBlockContainerRecord<Field, KrylovMatrix> Sequence;
+		typedef BlockHankelLiftingContainer<Ring,Field,IMatrix,KrylovMatrix, BlasMatrix<Field> > LiftingContainer;
 
 		size_t n = A.coldim();
-		size_t numblock = n/blocksize;
-
-		// generate randomly U and V
-		BlasMatrix<Field> U(F,blocksize,A.rowdim()), V(A.coldim(),blocksize);
-
-		for (size_t j=0;j<blocksize; ++j)
-			for (size_t i=j*numblock;i<(j+1)*numblock;++i){
-				G.random(V.refEntry(i,j));
+		size_t s = (blocksize == 0) ? blockingFactor(n, A.size()) : blocksize;
+		size_t numblock = (n + s - 1) / s;
+		// the system is padded by an identity block up to a multiple of s
+		size_t N = numblock * s;
+
+		commentator().report(Commentator::LEVEL_UNIMPORTANT, INTERNAL_DESCRIPTION)
+			<< "Block Hankel: block size " << s << ", dimension " << N << std::endl;
+
+		for (int trial = 0; trial < maxPrimes; ++trial) {
+			if (trial) {
+				_prime = *_genprime;
+				++_genprime;
+			}
+			Field F(_prime);
+			typename Field::RandIter G(F, 0, 123456 + trial);
+
+			// precondition A mod p with a random diagonal Matrix
+			BlasVector<Field> diag(F, N);
+			for(size_t i=0;i<N;++i){
+				do {
+					G.random(diag[i]);
+				} while(F.isZero(diag[i]));
 			}
-		for (size_t i=0;i<n;++i)
-			G.random(U.refEntry(0,i));
+			Diagonal<Field> D(diag);
+			KrylovMatrix DAp(FMatrix(A, F), diag);
+
+			// random block diagonal projections U and V
+			BlasMatrix<Field> U(F, s, N), V(F, N, s);
+			for (size_t j=0;j<s; ++j)
+				for (size_t i=j*numblock;i<(j+1)*numblock;++i){
+					G.random(U.refEntry(j,i));
+					G.random(V.refEntry(i,j));
+				}
 
 #ifdef RSTIMING
-		Timer chrono;
-		chrono.clear();
-		chrono.start();
+			Timer chrono;
+			chrono.clear();
+			chrono.start();
 #endif
-
-		// compute the block krylov sequence associated to U.A^i.V
-		BlackboxBlockContainerRecord<Field, Compose<Diagonal<Field>,FMatrix> >  Seq(&DAp, F, U, V, false);
+			try {
+				// compute the block krylov sequence associated to U.A^i.V
+				Sequence Seq(&DAp, F, U, V, false);
 
 #ifdef RSTIMING
-		chrono.stop();
-		std::cout<<"sequence generation: "<<chrono<<"\n";
-		chrono.clear();
-		chrono.start();
+				chrono.stop();
+				std::cout<<"sequence generation: "<<chrono<<"\n";
+				chrono.clear();
+				chrono.start();
 #endif
 
-		// compute the inverse of the Hankel matrix associated with the Krylov Sequence
-		BlockHankelInverse<Field> Hinv(F, Seq.getRep());
-		BlasVector<Field> y(F,n), x(F,n, F.one);
+				// compute the inverse of the Hankel matrix associated with the Krylov Sequence,
+				// it throws when the Hankel matrix is singular
+				BlockHankelInverse<Field> Hinv(F, Seq.getRep());
 
 #ifdef RSTIMING
-		chrono.stop();
-		std::cout<<"inverse block hankel: "<<chrono<<"\n";
+				chrono.stop();
+				std::cout<<"inverse block hankel: "<<chrono<<"\n";
 #endif
 
-		typedef BlockHankelLiftingContainer<Ring,Field,IMatrix,Compose<Diagonal<Field>,FMatrix>, BlasMatrix<Field> > LiftingContainer;
-		LiftingContainer lc(_ring, F, A, DAp, D, Hinv, U, V, b, _prime);
-		RationalReconstruction<LiftingContainer > re(lc);
-
-		if (!re.getRational(num, den, 0)) return SS_FAILED;
+				LiftingContainer lc(_ring, F, A, DAp, D, Hinv, U, V, b, _prime);
+				RationalReconstruction<LiftingContainer > re(lc);
 
+				if (re.getRational(num, den, 0)) {
 #ifdef RSTIMING
-		std::cout<<"lifting bound computation : "<<lc.ttSetup<<"\n";
-		std::cout<<"residue computation       : "<<lc.ttRingApply<<"\n";
-		std::cout<<"rational reconstruction   : "<<re.ttRecon<<"\n";
+					std::cout<<"lifting bound computation : "<<lc.ttSetup<<"\n";
+					std::cout<<"residue computation       : "<<lc.ttRingApply<<"\n";
+					std::cout<<"rational reconstruction   : "<<re.ttRecon<<"\n";
 #endif
+					return SS_OK;
+				}
+			}
+			catch (const LinboxError&) {
+				// A singular mod p or unlucky projections
+			}
 
-		return SS_OK;
+			commentator().report(Commentator::LEVEL_IMPORTANT, INTERNAL_WARNING)
+				<< "Block Hankel: failure with prime " << _prime << std::endl;
+		}
+
+		return SS_FAILED;
 	}
 
 
@@ -31,6 +31,7 @@
  */
 
 #include <vector>
+#include <ostream>
 #include "linbox/integer.h"
 #include "linbox/matrix/dense-matrix.h"
 
@@ -46,20 +47,38 @@ namespace LinBox
 
 		/* Compute the local smith form at prime p, when modular (p^e) fits in long
 		 * Should work with SparseMatrix and BlasMatrix
+		 * The compute_local functions report to the commentator, or to the
+		 * given stream, without any other use of the commentator: they can
+		 * run concurrently on their own streams.
 		 */
 		template <class Matrix>
 		static void compute_local_long (BlasVector<Givaro::ZRing<Integer> >& s, const Matrix& A, int64_t p, int64_t e);
+		template <class Matrix>
+		static void compute_local_long (BlasVector<Givaro::ZRing<Integer> >& s, const Matrix& A, int64_t p, int64_t e, std::ostream& report);
 
 		/* Compute the local smith form at prime p, when modular (p^e) doesnot fit in int64_t
 		 * Should work with SparseMatrix and BlasMatrix
 		 */
 		template <class Matrix>
 		static void compute_local_big (BlasVector<Givaro::ZRing<Integer> >& s, const Matrix& A, int64_t p, int64_t e);
+		template <class Matrix>
+		static void compute_local_big (BlasVector<Givaro::ZRing<Integer> >& s, const Matrix& A, int64_t p, int64_t e, std::ostream& report);
 
 		/* Compute the local smith form at prime p
 		*/
 		template <class Matrix>
 		static void compute_local (BlasVector<Givaro::ZRing<Integer> >& s, const Matrix& A, int64_t p, int64_t e);
+		template <class Matrix>
+		static void compute_local (BlasVector<Givaro::ZRing<Integer> >& s, const Matrix& A, int64_t p, int64_t e, std::ostream& report);
+
+		/* Compute the local smith form at prime p modulo p^(e+extra), doubling
+		 * extra until the result agrees with the rank r.
+		 * Return the exponent used.
+		 */
+		template <class Matrix>
+		static int64_t compute_local_checked (BlasVector<Givaro::ZRing<Integer> >& s, const Matrix& A, long r, int64_t p, int64_t e, int extra);
+		template <class Matrix>
+		static int64_t compute_local_checked (BlasVector<Givaro::ZRing<Integer> >& s, const Matrix& A, long r, int64_t p, int64_t e, int extra, std::ostream& report);
 
 		/* Compute the k-smooth part of the invariant factor, where k = 100.
 		 * @param sev is the exponent part ...
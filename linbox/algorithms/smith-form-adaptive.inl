@@ -28,6 +28,7 @@
 
 #include <cmath>
 #include <vector>
+#include <sstream>
 #include <givaro/modular-integral.h>
 
 #include "linbox/linbox-config.h"
@@ -36,6 +37,8 @@
 #include "linbox/ring/pir-modular-int32.h"
 #include "linbox/ring/local2_32.h"
 #include "linbox/ring/local-pir-modular.h"
+#include "linbox/ring/modular.h"
+#include "linbox/matrix/matrixdomain/blas-matrix-domain.h"
 #include "linbox/algorithms/smith-form-iliopoulos.h"
 #include "linbox/algorithms/smith-form-local.h"
 #include "linbox/algorithms/rational-solver-adaptive.h"
@@ -57,9 +60,12 @@ namespace LinBox
 	template <class Matrix>
 	void SmithFormAdaptive::compute_local_long (BlasVector<Givaro::ZRing<Integer> >& s, const Matrix& A, int64_t p, int64_t e)
 	{
-		//std::ostream& report(std::cout);
-		std::ostream& report = commentator().report (Commentator::LEVEL_IMPORTANT, PROGRESS_REPORT);
+		compute_local_long (s, A, p, e, commentator().report (Commentator::LEVEL_IMPORTANT, PROGRESS_REPORT));
+	}
 
+	template <class Matrix>
+	void SmithFormAdaptive::compute_local_long (BlasVector<Givaro::ZRing<Integer> >& s, const Matrix& A, int64_t p, int64_t e, std::ostream& report)
+	{
 		int order = (int)(A. rowdim() < A. coldim() ? A. rowdim() : A. coldim());
 		linbox_check ((s. size() >= (size_t)order) && (p > 0) && ( e >= 0));
 		if (e == 0) return;
@@ -108,7 +114,12 @@ namespace LinBox
 			std::cout << "Call of ffpack is done\n";
 			delete[] A_local;
 #endif
-			size_t rank; integral_rank(rank, A, Method::Auto());
+			// the rank mod p itself, without the commentator
+			typedef Givaro::Modular<double> Field;
+			Field F ((double)p);
+			BlasMatrix<Field> A_p(F, A.rowdim(), A.coldim());
+			MatrixHom::map (A_p, A);
+			size_t rank = BlasMatrixDomain<Field>(F). rankInPlace (A_p);
 
 			BlasVector<Givaro::ZRing<Integer> >::iterator s_p;
 			for (s_p = s. begin(); s_p != s. begin() + (long) rank; ++ s_p)
@@ -144,9 +155,12 @@ namespace LinBox
 	template <class Matrix>
 	void SmithFormAdaptive::compute_local_big (BlasVector<Givaro::ZRing<Integer> >& s, const Matrix& A, int64_t p, int64_t e)
 	{
+		compute_local_big (s, A, p, e, commentator().report (Commentator::LEVEL_IMPORTANT, PROGRESS_REPORT));
+	}
 
-		//std::ostream& report(std::cout);
-		std::ostream& report = commentator().report (Commentator::LEVEL_IMPORTANT, PROGRESS_REPORT);
+	template <class Matrix>
+	void SmithFormAdaptive::compute_local_big (BlasVector<Givaro::ZRing<Integer> >& s, const Matrix& A, int64_t p, int64_t e, std::ostream& report)
+	{
 		int order = (int)(A. rowdim() < A. coldim() ? A. rowdim() : A. coldim());
 		linbox_check ((s. size() >= (size_t) order) && (p > 0) && ( e >= 0));
 		integer T; T = order; T <<= 20; T = pow (T, (int) sqrt((double)order));
@@ -172,20 +186,49 @@ namespace LinBox
 	*/
 	template <class Matrix>
 	void SmithFormAdaptive::compute_local (BlasVector<Givaro::ZRing<Integer> >& s, const Matrix& A, int64_t p, int64_t e)
+	{
+		compute_local (s, A, p, e, commentator().report (Commentator::LEVEL_IMPORTANT, PROGRESS_REPORT));
+	}
+
+	template <class Matrix>
+	void SmithFormAdaptive::compute_local (BlasVector<Givaro::ZRing<Integer> >& s, const Matrix& A, int64_t p, int64_t e, std::ostream& report)
 	{
 
 		linbox_check ((p > 0) && ( e >= 0));
 		integer m = 1; int i = 0; for ( i = 0; i < e; ++ i) m *= p;
 		if (((p == 2) && (e <= 32)) || (m <= FieldTraits<PIRModular<int32_t> >::maxModulus()))
-			compute_local_long (s, A, p, e);
+			compute_local_long (s, A, p, e, report);
 		else
-			compute_local_big (s, A, p, e);
+			compute_local_big (s, A, p, e, report);
 
 		// normalize the answer
 		for (BlasVector<Givaro::ZRing<Integer> >::iterator p_it = s. begin(); p_it != s. end(); ++ p_it)
 			*p_it = gcd (*p_it, m);
 	}
 
+	/* Compute the local smith form at prime p modulo p^(e+extra), doubling extra
+	 * until it agrees with the rank r. Return the exponent finally used.
+	 */
+	template <class Matrix>
+	int64_t SmithFormAdaptive::compute_local_checked (BlasVector<Givaro::ZRing<Integer> >& s, const Matrix& A, long r, int64_t p, int64_t e, int extra)
+	{
+		return compute_local_checked (s, A, r, p, e, extra, commentator().report (Commentator::LEVEL_IMPORTANT, PROGRESS_REPORT));
+	}
+
+	template <class Matrix>
+	int64_t SmithFormAdaptive::compute_local_checked (BlasVector<Givaro::ZRing<Integer> >& s, const Matrix& A, long r, int64_t p, int64_t e, int extra, std::ostream& report)
+	{
+		int order = (int)(A. rowdim() < A. coldim() ? A. rowdim() : A. coldim());
+		do {
+			integer m = 1;
+			for (int i = 0; i < e + extra; ++ i) m *= p;
+			compute_local (s, A, p, e + extra, report);
+			if ((s[(size_t)r-1] % m != 0 ) && ((r == order) ||(s[(size_t)r] % m == 0)))
+				return e + extra;
+			extra *= 2;
+		} while (true);
+	}
+
 	/* Compute the k-smooth part of the invariant factor, where k = 100.
 	 * @param sev is the exponent part ...
 	 * By local smith form and rank computation
@@ -210,24 +253,29 @@ namespace LinBox
 			*s_p = 0;
 		if (r == 0) return;
 
+		// the local Smith forms are independent, one task per prime; the tasks
+		// report to their own stream, the commentator is not thread safe
+		std::vector<BlasVector<Givaro::ZRing<Integer> > > locals((size_t)NPrime, local);
+		std::vector<int64_t> exponent((size_t)NPrime);
+		std::vector<std::ostringstream> logs((size_t)NPrime);
+		PAR_BLOCK {
+			SYNCH_GROUP(
+				for (int i = 0; i < NPrime; ++ i) {
+					{ TASK(MODE(CONSTREFERENCE(A,sev) REFERENCE(locals,exponent,logs)),
+					{
+						int extra = 1;
+						if ((prime[i] == 2) && (sev[(size_t)i] < 32))
+							extra =  32 -(int) sev[(size_t)i];
+						exponent[(size_t)i] = compute_local_checked (locals[(size_t)i], A, r, prime[i], sev[(size_t)i], extra, logs[(size_t)i]);
+					})}
+				}
+			)
+		}
 		for (sev_p = sev. begin(), prime_p = prime; sev_p != sev. begin() +(ptrdiff_t) NPrime; ++ sev_p, ++ prime_p) {
-			int extra = 1;
-			do {
-
-				if ((*prime_p == 2) && (*sev_p < 32))
-					extra =  32 -(int) *sev_p;
-				// put in a warning if over 2^32
-				integer m = 1;
-				for (int i = 0; i < *sev_p + extra; ++ i) m *= * prime_p;
-				report << "   Compute the local smith form mod " << *prime_p <<"^" << *sev_p + extra << std::endl;
-				compute_local (local, A, *prime_p, *sev_p + extra);
-				//check
-				report << "   Check if it agrees with the rank: ";
-				if ((local[(size_t)r-1] % m != 0 ) && ((r == order) ||(local[(size_t)r] % m == 0))) {report << "yes.\n"; break;}
-				report << "no. \n";
-				extra *= 2;
-			} while (true);
-			for (s_p = s. begin(), local_p = local. begin(); s_p != s. begin() +(ptrdiff_t) order; ++ s_p, ++ local_p)
+			size_t i = (size_t)(prime_p - prime);
+			report << logs[i]. str();
+			report << "   Local smith form mod " << *prime_p <<"^" << exponent[i] << " agrees with the rank.\n";
+			for (s_p = s. begin(), local_p = locals[i]. begin(); s_p != s. begin() +(ptrdiff_t) order; ++ s_p, ++ local_p)
 				*s_p *= *local_p;
 		}
 		report << "Computation of the smooth part is done.\n";
@@ -324,28 +372,35 @@ namespace LinBox
 			*s_p = 0;
 		if (r == 0) return;
 
+		// only compute the local Smith form at each possible prime, one task per
+		// prime reporting to its own stream, as in smithFormSmooth
+		std::vector<BlasVector<Givaro::ZRing<Integer> > > locals((size_t)NPrime, local);
+		std::vector<int64_t> exponent((size_t)NPrime,0);
+		std::vector<std::ostringstream> logs((size_t)NPrime);
+		PAR_BLOCK {
+			SYNCH_GROUP(
+				for (int i = 0; i < NPrime; ++ i) {
+					if (sev[(size_t)i] <= 0) continue;
+					{ TASK(MODE(CONSTREFERENCE(A) REFERENCE(locals,exponent,logs)),
+					{
+						int extra = 2;
+						if (prime[i] == 2) extra = 32;
+						else {
+							// cheating here, try to use the max word size modular
+							double log_max_mod = log((double) FieldTraits<PIRModular<int32_t> >:: maxModulus() - 1) ;
+							extra = (int)(floor(log_max_mod / log (double(prime[i]))));
+						}
+						exponent[(size_t)i] = compute_local_checked (locals[(size_t)i], A, r, prime[i], 0, extra, logs[(size_t)i]);
+					})}
+				}
+			)
+		}
 		for (sev_p = sev. begin(), prime_p = prime; sev_p != sev. begin() +(ptrdiff_t) NPrime; ++ sev_p, ++ prime_p) {
 			if (*sev_p <= 0) continue;
-			//only compute the local Smith form at each possible prime
-			int extra = 2;
-			if (*prime_p == 2) extra = 32;
-			else {
-				// cheating here, try to use the max word size modular
-				double log_max_mod = log((double) FieldTraits<PIRModular<int32_t> >:: maxModulus() - 1) ;
-				extra = (int)(floor(log_max_mod / log (double(*prime_p))));
-			}
-			do {
-				integer m = 1;
-				for (int i = 0; i < extra; ++ i) m *= * prime_p;
-				report << "   Compute the local smith form mod " << *prime_p <<"^" << extra << std::endl;
-				compute_local (local, A, *prime_p, extra);
-				//check
-				report << "   Check if it agrees with the rank: ";
-				if ((local[(size_t)r-1] % m != 0 ) && ((r == order) ||(local[(size_t)r] % m == 0))) {report << "yes.\n"; break;}
-				report << "no. \n";
-				extra *= 2;
-			} while (true);
-			for (s_p = s. begin(), local_p = local. begin(); s_p != s. begin() +(ptrdiff_t) order; ++ s_p, ++ local_p)
+			size_t i = (size_t)(prime_p - prime);
+			report << logs[i]. str();
+			report << "   Local smith form mod " << *prime_p <<"^" << exponent[i] << " agrees with the rank.\n";
+			for (s_p = s. begin(), local_p = locals[i]. begin(); s_p != s. begin() +(ptrdiff_t) order; ++ s_p, ++ local_p)
 				*s_p *= *local_p;
 		}
 		report << "Computation of the smith form done.\n";
@@ -442,8 +497,10 @@ namespace LinBox
 		bonus = gcd (bonus, r_mod);
 		Givaro::ZRing<Integer> Z;
 		BlasVector<Givaro::ZRing<Integer> > smooth (Z,(size_t)order), rough (Z,(size_t)order);
+		// the rough part goes through the commentator down to its solvers,
+		// the smooth part is parallel over the primes
 		smithFormRough (rough, DA, bonus);
-		smithFormSmooth (smooth, A, r, e);
+		smithFormSmooth (smooth, A, (long)r, e);
 		//fixed the rough largest invariant factor
 		if (r > 0) rough[r-1] = r_mod;
 
@@ -566,9 +623,10 @@ namespace LinBox
 		// bonus assigns to its rough part
 		bonus = gcd (bonus, r_mod);
 		BlasVector<Givaro::ZRing<Integer> > smooth (Z,order), rough (Z,order);
-		report << "Computation of smooth part begins.\n";
+		report << "Computation of smooth and rough parts begins.\n";
+		// the rough part goes through the commentator down to its solvers,
+		// the smooth part is parallel over the primes
 		smithFormSmooth (smooth, A, (long)r, e);
-		report << "Computation of rough part begins.\n";
 		smithFormRough (rough, A, bonus);
 		report << "Computation of rough/smooth parts finished.\n";
 		// fixed the rough largest invariant factor
@@ -0,0 +1,269 @@
+/* linbox/algorithms/triangular-solve-levels.h
+ * Copyright(C) LinBox
+ *
+ * ========LICENCE========
+ * This file is part of the library LinBox.
+ *
+ * LinBox is free software: you can redistribute it and/or modify
+ * it under the terms of the  GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ * ========LICENCE========
+ *.
+ */
+
+/*! @file algorithms/triangular-solve-levels.h
+ * @ingroup algorithms
+ * Level scheduled sparse triangular solves.
+ *
+ * The triangular factor is converted once into a CSR representation and
+ * its rows are grouped by level in the dependency DAG: the unknown of row i
+ * depends on the unknowns of the off-diagonal columns of row i, so all the
+ * rows of a level can be solved concurrently once the previous levels are
+ * done. This is meant for factors which are used for many right hand sides,
+ * e.g. the L and U factors of GaussDomain::QLUPin reused at each p-adic step.
+ */
+
+#ifndef __LINBOX_triangular_solve_levels_H
+#define __LINBOX_triangular_solve_levels_H
+
+#include <vector>
+#include <algorithm>
+
+#include "linbox/linbox-config.h"
+#include "linbox/util/debug.h"
+#include "linbox/util/error.h"
+#include "linbox/matrix/dense-matrix.h"
+
+#ifdef __LINBOX_USE_OPENMP
+#include <omp.h>
+#endif
+
+// minimal number of rows in a level before it is solved in parallel
+#ifndef __LINBOX_TRSV_LEVEL_PAR_THRESHOLD
+#define __LINBOX_TRSV_LEVEL_PAR_THRESHOLD 256
+#endif
+
+namespace LinBox
+{
+	/** Rows of a triangular matrix sorted by level.
+	 *
+	 * Row i of the matrix is made of the columns ind[ptr[i]..ptr[i+1][, the
+	 * rows beyond ptr.size()-1 being empty. Row i depends on the rows of
+	 * its columns j < i if \p lower, j > i otherwise, the other columns are
+	 * ignored. Its level is 1 + the highest level of these rows, and level l
+	 * is made of the rows levelrows[levelptr[l]..levelptr[l+1][ on return.
+	 */
+	template<class PtrVector, class IndVector>
+	void sortRowsByLevel (std::vector<size_t>& levelptr, std::vector<size_t>& levelrows, size_t n,
+			      bool lower, const PtrVector& ptr, const IndVector& ind)
+	{
+		size_t nr=std::min(n, ptr.size() ? (size_t)ptr.size()-1 : 0);
+		std::vector<size_t> level(n,0);
+		size_t maxlevel=0;
+		for (size_t k=0; k<n; ++k) {
+			size_t i=(lower ? k : n-1-k);
+			size_t lvl=0;
+			if (i<nr)
+				for (size_t t=(size_t)ptr[i]; t<(size_t)ptr[i+1]; ++t) {
+					size_t j=(size_t)ind[t];
+					if (lower ? j<i : (j>i && j<n))
+						lvl=std::max(lvl, level[j]+1);
+				}
+			level[i]=lvl;
+			maxlevel=std::max(maxlevel,lvl);
+		}
+		// counting sort of the rows by level
+		levelptr.assign(n ? maxlevel+2 : 1, 0);
+		for (size_t i=0; i<n; ++i)
+			++levelptr[level[i]+1];
+		for (size_t l=1; l<levelptr.size(); ++l)
+			levelptr[l]+=levelptr[l-1];
+		levelrows.resize(n);
+		std::vector<size_t> pos(levelptr.begin(), levelptr.end()-1);
+		for (size_t i=0; i<n; ++i)
+			levelrows[pos[level[i]]++]=i;
+	}
+
+	/** \brief Sparse triangular system solver with level scheduling.
+	 *
+	 * Built from a sparse matrix whose rows are sequences of (column, value)
+	 * pairs, as produced by GaussDomain::QLUPin:
+	 * - a \c lower factor is unit lower triangular (the diagonal, if stored, is ignored);
+	 * - an \c upper factor has its first \c rank rows starting with their nonzero pivot
+	 *   on the diagonal, the remaining rows being zero.
+	 */
+	template<class _Field>
+	class SparseTriangularSolver {
+	public:
+		typedef _Field                       Field;
+		typedef typename Field::Element    Element;
+		typedef BlasMatrix<Field>           Block;
+
+		enum Shape { lower, upper };
+
+		template<class _Matrix>
+		SparseTriangularSolver (const _Matrix& T, Shape shape, size_t rank=0) :
+			_field(&T.field()), _shape(shape), _n(T.rowdim()), _m(T.coldim()),
+			_rank(shape==lower ? T.rowdim() : rank)
+		{
+			linbox_check(_rank <= _n);
+			initCSR(T);
+			initLevels();
+		}
+
+		const Field& field() const { return *_field; }
+
+		size_t rowdim()   const { return _n; }
+		size_t coldim()   const { return _m; }
+		size_t nblevels() const { return _levelptr.size()-1; }
+
+		/** Solve T.x = b.
+		 * For an upper factor, the last rowdim()-rank entries of b must be zero
+		 * and the entries of x beyond the rank are set to zero.
+		 */
+		template<class Vector1, class Vector2>
+		Vector1& solve (Vector1& x, const Vector2& b) const
+		{
+			linbox_check(b.size() == _n);
+			checkConsistency(b);
+			for (size_t i=_rank; i<x.size(); ++i)
+				field().assign(x[i], field().zero);
+			for (size_t l=0; l<nblevels(); ++l) {
+				long beg=(long)_levelptr[l], end=(long)_levelptr[l+1];
+#ifdef __LINBOX_USE_OPENMP
+#pragma omp parallel for schedule(static) if(end-beg >= __LINBOX_TRSV_LEVEL_PAR_THRESHOLD)
+#endif
+				for (long k=beg; k<end; ++k) {
+					size_t i=_levelrows[(size_t)k];
+					Element tmp;
+					field().init(tmp);
+					field().assign(tmp, b[i]);
+					for (size_t j=_rowptr[i]; j<_rowptr[i+1]; ++j)
+						field().maxpyin(tmp, _val[j], x[_colid[j]]);
+					if (_shape==upper)
+						field().divin(tmp, _diag[i]);
+					field().assign(x[i], tmp);
+				}
+			}
+			return x;
+		}
+
+		/** Solve T.X = B for a block of right hand sides.
+		 * Each row update is a sparse combination of rows of X,
+		 * which are contiguous in the row major storage of BlasMatrix.
+		 */
+		Block& solve (Block& X, const Block& B) const
+		{
+			linbox_check(B.rowdim() == _n && X.coldim() == B.coldim());
+			size_t k=B.coldim();
+			for (size_t i=_rank; i<_n; ++i)
+				for (size_t c=0; c<k; ++c)
+					if (! field().isZero(B.getEntry(i,c)))
+						throw LinboxError ("SparseTriangularSolver returned INCONSISTENT");
+			for (size_t i=_rank; i<X.rowdim(); ++i)
+				for (size_t c=0; c<k; ++c)
+					X.setEntry(i,c,field().zero);
+
+			for (size_t l=0; l<nblevels(); ++l) {
+				long beg=(long)_levelptr[l], end=(long)_levelptr[l+1];
+#ifdef __LINBOX_USE_OPENMP
+#pragma omp parallel for schedule(static) if((end-beg)*(long)k >= __LINBOX_TRSV_LEVEL_PAR_THRESHOLD)
+#endif
+				for (long r=beg; r<end; ++r) {
+					size_t i=_levelrows[(size_t)r];
+					Element* Xi=X.getPointer()+i*X.getStride();
+					const Element* Bi=B.getPointer()+i*B.getStride();
+					for (size_t c=0; c<k; ++c)
+						field().assign(Xi[c], Bi[c]);
+					for (size_t j=_rowptr[i]; j<_rowptr[i+1]; ++j) {
+						const Element* Xj=X.getPointer()+_colid[j]*X.getStride();
+						for (size_t c=0; c<k; ++c)
+							field().maxpyin(Xi[c], _val[j], Xj[c]);
+					}
+					if (_shape==upper) {
+						Element inv;
+						field().init(inv);
+						field().inv(inv, _diag[i]);
+						for (size_t c=0; c<k; ++c)
+							field().mulin(Xi[c], inv);
+					}
+				}
+			}
+			return X;
+		}
+
+	protected:
+		const Field*               _field;
+		Shape                      _shape;
+		size_t                         _n;
+		size_t                         _m;
+		size_t                      _rank;
+		// CSR storage of the off-diagonal part of the first _rank rows
+		std::vector<size_t>       _rowptr;
+		std::vector<size_t>        _colid;
+		std::vector<Element>         _val;
+		std::vector<Element>        _diag;
+		// rows sorted by level, level l is _levelrows[_levelptr[l].._levelptr[l+1][
+		std::vector<size_t>     _levelptr;
+		std::vector<size_t>    _levelrows;
+
+		template<class _Matrix>
+		void initCSR (const _Matrix& T)
+		{
+			_rowptr.resize(_rank+1);
+			_rowptr[0]=0;
+			_diag.resize(_rank, field().one);
+			typename _Matrix::ConstRowIterator row=T.rowBegin();
+			for (size_t i=0; i<_rank; ++i, ++row) {
+				if (_shape==upper) {
+					if (row->size()==0 || row->front().first != i)
+						throw LinboxError ("SparseTriangularSolver: missing pivot in upper factor");
+					field().assign(_diag[i], row->front().second);
+				}
+				for (typename _Matrix::ConstRow::const_iterator it=row->begin(); it!=row->end(); ++it) {
+					size_t j=(size_t)it->first;
+					// the unknowns beyond the rank are set to zero
+					if (j==i || (_shape==upper && j>=_rank)) continue;
+					linbox_check(_shape==lower ? j<i : j>i);
+					_colid.push_back(j);
+					_val.push_back(it->second);
+				}
+				_rowptr[i+1]=_colid.size();
+			}
+		}
+
+		void initLevels ()
+		{
+			sortRowsByLevel(_levelptr, _levelrows, _rank, _shape==lower, _rowptr, _colid);
+		}
+
+		template<class Vector2>
+		void checkConsistency (const Vector2& b) const
+		{
+			for (size_t i=_rank; i<_n; ++i)
+				if (! field().isZero(b[i]))
+					throw LinboxError ("SparseTriangularSolver returned INCONSISTENT");
+		}
+	};
+
+} // namespace LinBox
+
+#endif //__LINBOX_triangular_solve_levels_H
+
+// Local Variables:
+// mode: C++
+// tab-width: 4
+// indent-tabs-mode: nil
+// c-basic-offset: 4
+// End:
+// vim:sts=4:sw=4:ts=4:et:sr:cino=>s,f0,{0,g0,(0,\:0,t0,+0,=s
@@ -368,6 +368,9 @@ namespace LinBox
 		// Make an m x m lambda-sparse matrix, c.f. Mulders (2000)
 		SparseMatrix<Field> *makeLambdaSparseMatrix (size_t m);
 
+		// Seed of an implicit random preconditioner, drawn from _randiter
+		uint64_t randomSeed ();
+
 		Method::Wiedemann                      _traits;
 		const Field                         *_field;
 		typename Field::RandIter             _randiter;
@@ -60,6 +60,7 @@
 #include "linbox/algorithms/wiedemann.h"
 #include "linbox/blackbox/submatrix.h"
 #include "linbox/blackbox/butterfly.h"
+#include "linbox/blackbox/implicit-random.h"
 #include "linbox/blackbox/transpose.h"
 #include "linbox/algorithms/blackbox-container.h"
 #include "linbox/algorithms/blackbox-container-symmetric.h"
@@ -314,17 +315,18 @@ namespace LinBox
 			{
 				commentator().start ("Constructing sparse preconditioner");
 
-				SparseMatrix<Field> *P, *QT;
-				P = makeLambdaSparseMatrix (A.rowdim ());
-				QT = makeLambdaSparseMatrix (A.coldim ());
+				// entries drawn at each apply, reproducible from the seeds
+				typedef ImplicitLambdaSparse<Field> LambdaP;
+				LambdaP P(field(), A.rowdim (), A.rowdim (), randomSeed ());
+				LambdaP QT(field(), A.coldim (), A.coldim (), randomSeed ());
 
-				Transpose< SparseMatrix<Field> > Q(QT);
+				Transpose< LambdaP > Q(&QT);
 
-				Compose< Blackbox, Transpose< SparseMatrix<Field> > > AQ(&A, &Q);
-				Compose< SparseMatrix<Field>, Compose< Blackbox, Transpose< SparseMatrix<Field> > > > PAQ(P, &AQ);
+				Compose< Blackbox, Transpose< LambdaP > > AQ(&A, &Q);
+				Compose< LambdaP, Compose< Blackbox, Transpose< LambdaP > > > PAQ(&P, &AQ);
 				commentator().stop ("done");
 
-				sfrs = findRandomSolution (PAQ, x, b, r, P, &Q);
+				sfrs = findRandomSolution (PAQ, x, b, r, &P, &Q);
 
 				break;
 			}
@@ -608,6 +610,21 @@ namespace LinBox
 	}
 
 
+	template <class Field>
+	uint64_t WiedemannSolver<Field>::randomSeed ()
+	{
+		uint64_t seed = 0;
+		typename Field::Element e;
+		integer c;
+		field().init (e);
+		for (int k = 0; k < 4; ++k) {
+			_randiter.random (e);
+			field().convert (c, e);
+			seed = Philox4x32::block (seed, (uint64_t) c).word (0);
+		}
+		return seed;
+	}
+
 	template <class Field>
 	SparseMatrix<Field> *WiedemannSolver<Field>::makeLambdaSparseMatrix (size_t m)
 	{
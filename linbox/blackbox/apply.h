@@ -45,22 +45,31 @@
 #include "linbox/matrix/dense-matrix.h"
 #include "linbox/algorithms/lifting-container.h"
 #include <vector>
+#include <algorithm>
+#include <cstring>
 #include "linbox/vector/blas-vector.h"
 
 
 #include "linbox/util/timer.h"
+#include "linbox/util/commentator.h"
 
 
 // #ifdef __LINBOX_BLAS_AVAILABLE
 #include <fflas-ffpack/fflas/fflas.h>
 // #endif
 
-//#define DEBUG_CHUNK_SETUP
-//#define DEBUG_CHUNK_APPLY
-//#define DEBUG_CHUNK_APPLYM
+#ifdef __LINBOX_USE_OPENMP
+#include <omp.h>
+#endif
+
 //#define CHECK_APPLY
 #define TIMING_APPLY
 
+// below this number of entries, BlasMatrixApplyDomain::calibrate keeps the choice of setup
+#ifndef __LINBOX_APPLY_CALIBRATION_THRESHOLD
+#define __LINBOX_APPLY_CALIBRATION_THRESHOLD 10000
+#endif
+
 namespace LinBox
 {
 
@@ -280,6 +289,8 @@ namespace LinBox
 
 		void setup(LinBox::integer prime){}
 
+		void calibrate(LinBox::integer prime){}
+
 		Vector& applyV(Vector& y, Vector& x, Vector& z) const
 		{
 			return _matM.apply(y,x);
@@ -314,13 +325,30 @@ namespace LinBox
 
 
 
-	// \brief optimizations for applying an integer matrix to a bounded integer vector
+	/** \brief optimizations for applying an integer matrix to a bounded integer vector.
+	 *
+	 * The products are computed with BLAS on doubles, the matrix being
+	 * stored by setup() in one of the following ways:
+	 * - MatrixQadic: 16-bit chunks of the entries, one double matrix per chunk;
+	 * - VectorQadic: the entries as doubles, the vector being cut in 16-bit chunks;
+	 * - CRT: the matrix modulo small primes, the result being recovered by
+	 *   Chinese remaindering with the residues modulo p given to applyV();
+	 * - Classic: no conversion, product over the integers.
+	 *
+	 * With OpenMP, the row blocks of the double products, the chunks and the
+	 * RNS primes are shared among the threads, as well as the conversions of
+	 * the vector and the recombination of the rows of the result.
+	 *
+	 * setup() picks the representation from bounds on the entries, calibrate()
+	 * times every usable one on the actual matrix and keeps the fastest.
+	 * The vectors applied must have entries of absolute value less than p.
+	 */
 	template <class Domain, class IMatrix>
 	class BlasMatrixApplyDomain {
 
+	public:
 		enum ApplyChoice {Classic, MatrixQadic, VectorQadic, CRT};
 
-	public:
 		typedef typename Domain::Element   Element;
 		typedef BlasVector<Domain>         Vector;
 		typedef IMatrix                      Matrix;
@@ -328,720 +356,709 @@ namespace LinBox
 
 		BlasMatrixApplyDomain(const Domain& D, const IMatrix &Mat) :
 			_domain(D), _matM(Mat), _MD(D), _m(Mat.rowdim()), _n(Mat.coldim())
-			,use_chunks(false),use_neg(false),chunk_size(0)
-			,num_chunks(0)
-			,chunks(NULL),vchunks(NULL)
-		{
-			_switcher= Classic;_rns=NULL;
-		}
+			,_maxBitSize(0),_has_neg(false),_mqadic_ok(false),_vqadic_ok(false)
+			,use_neg(false),chunk_size(0),num_chunks(0)
+			,chunks(NULL),_switcher(Classic),_rns(NULL)
+		{}
 
 
 		~BlasMatrixApplyDomain ()
 		{
-			if (_switcher==MatrixQadic) delete[] chunks;
-			if (_switcher==VectorQadic) {delete[] chunks;delete[] vchunks;}
-			if (_switcher== CRT) delete _rns;
-			//std::cout<<"time convert data = "<<_convert_data<<std::endl;
-			//std::cout<<"time apply   = "<<_apply<<std::endl;
-			//std::cout<<"time convert result = "<<_convert_result<<std::endl;
+			_release();
 		}
 
+		/// Prepare the products by A with vectors of p-adic digits, the representation depending on the bounds of A and p.
 		ApplyChoice  setup(LinBox::integer prime)
-		{ //setup
+		{
+			_bounds(prime);
+			_release();
+#ifdef __LINBOX_HAVE_BIG_ENDIAN
+			_prepare(Classic);
+#else
+			if (_mqadic_ok)
+				_prepare(MatrixQadic);
+			else if (_vqadic_ok)
+				_prepare(VectorQadic);
+			else if (prime.bitsize()> 32)
+				_prepare(CRT);
+			else
+				_prepare(Classic);
+#endif
+			return _switcher;
+		}
 
-			_domain.init(_prime,prime);
+		/// Same as setup(prime), with representation \p c if it can be used, Classic otherwise.
+		ApplyChoice  setup(LinBox::integer prime, ApplyChoice c)
+		{
+			_bounds(prime);
+			_release();
+			_prepare(applicable(c) ? c : Classic);
+			return _switcher;
+		}
+
+		/** Same as setup(prime), then time each usable representation on
+		 * a vector of digits and keep the fastest.
+		 * Matrices with less than __LINBOX_APPLY_CALIBRATION_THRESHOLD
+		 * entries keep the choice of setup().
+		 * @param trials number of timed products per representation
+		 */
+		ApplyChoice  calibrate(LinBox::integer prime, size_t trials = 2)
+		{
+			setup(prime);
+			if (_m*_n < __LINBOX_APPLY_CALIBRATION_THRESHOLD)
+				return _switcher;
+
+			// digits of all sizes below p; b is only needed by the CRT
+			Vector x(_domain, _n), b(_domain, _m), y(_domain, _m);
+			integer pm1 = prime-1;
+			for (size_t j=0; j<_n; ++j)
+				_domain.init(x[j], pm1 >> uint64_t(j & 3));
+
+			ApplyChoice best = _switcher;
+			double tbest = -1;
+			const ApplyChoice all[4] = {MatrixQadic, VectorQadic, CRT, Classic};
+			for (size_t i=0; i<4; ++i) {
+				if (!applicable(all[i])) continue;
+				_release();
+				_prepare(all[i]);
+				double t = -1;
+				for (size_t r=0; r<trials && (tbest<0 || t<=tbest); ++r) {
+					Timer chrono;
+					chrono.clear();
+					chrono.start();
+					applyV(y, x, b);
+					chrono.stop();
+					if (t<0 || chrono.realtime() < t)
+						t = chrono.realtime();
+				}
+				commentator().report (Commentator::LEVEL_UNIMPORTANT, INTERNAL_DESCRIPTION)
+				<< "apply choice " << int(all[i]) << ": " << t << "s" << std::endl;
+				if (tbest<0 || t<tbest) {
+					tbest = t;
+					best = all[i];
+				}
+			}
+			if (best != _switcher) {
+				_release();
+				_prepare(best);
+			}
 			_apply.clear();
 			_convert_data.clear();
 			_convert_result.clear();
+			return _switcher;
+		}
+
+		/// Representation in use.
+		ApplyChoice choice() const { return _switcher; }
+
+		/// Whether representation \p c can be used with the prime of the last setup.
+		bool applicable(ApplyChoice c) const
+		{
 #ifdef __LINBOX_HAVE_BIG_ENDIAN
-			_switcher= Classic;
+			return c == Classic;
 #else
+			switch (c) {
+			case MatrixQadic: return _mqadic_ok;
+			case VectorQadic: return _vqadic_ok;
+			default: return true;
+			}
+#endif
+		}
+
+		/// y = A x, b = A x mod p is needed by the CRT representation.
+		Vector& applyV(Vector& y, Vector& x, Vector &b) const
+		{
+			linbox_check( _n == x.size());
+			linbox_check( _m == y.size());
+			linbox_check( _m == b.size());
+
+			_applyBlock(y.getPointer(), 1, x.getPointer(), 1, b.getPointer(), 1, 1);
+			return y;
+		}
+
+
+		Vector& applyVTrans(Vector& y, Vector& x) const
+		{
+			TransposeMatrix<IMatrix> B(_matM);
+			return _MD.vectorMul (y, B, x);
+		}
+
+		/// Y = A X, the CRT representation falls back to the classic product.
+		IMatrix& applyM (IMatrix &Y, const IMatrix &X) const
+		{
+			linbox_check( _n == X.rowdim());
+			linbox_check( _m == Y.rowdim());
+			linbox_check( Y.coldim() == X.coldim());
+
+			_applyBlock(Y.getPointer(), Y.getStride(), X.getPointer(), X.getStride(), NULL, 0, X.coldim());
+			return Y;
+		}
+
+		/// Y = A X for several vectors at once, B = A X mod p is needed by the CRT representation.
+		IMatrix& applyM (IMatrix &Y, const IMatrix &X, const IMatrix &B) const
+		{
+			linbox_check( _n == X.rowdim());
+			linbox_check( _m == Y.rowdim() && _m == B.rowdim());
+			linbox_check( Y.coldim() == X.coldim() && B.coldim() == X.coldim());
+
+			_applyBlock(Y.getPointer(), Y.getStride(), X.getPointer(), X.getStride(), B.getPointer(), B.getStride(), X.coldim());
+			return Y;
+		}
+
+
+	protected:
+
+		// bounds on A and on the products for the prime
+		void _bounds(const LinBox::integer& prime)
+		{
+			_domain.init(_prime,prime);
+			_apply.clear();
+			_convert_data.clear();
+			_convert_result.clear();
+
 			// compute the magnitude in bit of the matrix
 			// check if at least one entry in the matrix is negative
-			LinBox::integer tmp=0, maxValue=0;
-			size_t maxBitSize = 0;
-			use_neg = false;
+			LinBox::integer tmp=0;
+			_maxValue=0;
+			_has_neg = false;
 			typename Matrix::ConstIterator it = _matM.Begin();
 			for (size_t i=0; i<_m*_n; i++, ++it) {
 				_domain.convert(tmp, *it);
 				if (tmp <0) {
-					use_neg = 1;
+					_has_neg = true;
 					tmp=-tmp;
 				}
-				if (tmp> maxValue){
-					maxValue= tmp;
-				}
+				if (tmp> _maxValue)
+					_maxValue= tmp;
 			}
 			size_t bit, dbit;
-			bit=maxValue.bitsize();
-			dbit= maxValue.size_in_base(4)*2;
-			maxBitSize= ((dbit-bit)>0)? dbit: bit;
+			bit=_maxValue.bitsize();
+			dbit= _maxValue.size_in_base(4)*2;
+			_maxBitSize= (dbit>bit)? dbit: bit;
 
-			// Check Qadic matrix reprentation possibility
+			// 16-bit chunks times the other operand, summed n times, must stay below 2^53
 			LinBox::integer maxChunkVal = 1;
 			maxChunkVal <<= 53;
 			maxChunkVal /= (prime-1) * uint64_t(_n);
-			chunk_size = maxChunkVal.bitsize();
-			use_chunks = (chunk_size >= 16);
-			//std::cout<<"max bit= "<<maxBitSize<<" "<<maxValue.size_in_base(4)*2<<"\n";std::cout<<"max value= "<<maxValue<<"\n";
-			if (use_chunks){//std::cout<<"Matrix Qadic\n";
-				_switcher= MatrixQadic;
+			_mqadic_ok = (maxChunkVal.bitsize() > 16);
 
-			}
-			else {
-				// Check Qadic vector representation possibility
-				maxChunkVal = 1;
-				maxChunkVal <<= 53;
-				maxChunkVal /= 2*maxValue * uint64_t(_n);
-				chunk_size = maxChunkVal.bitsize();
-				use_chunks = (chunk_size >= 16);
+			maxChunkVal = 1;
+			maxChunkVal <<= 53;
+			maxChunkVal /= 2*(_maxValue > 0 ? _maxValue : integer(1)) * uint64_t(_n);
+			_vqadic_ok = (maxChunkVal.bitsize() > 16);
+		}
 
-				if (use_chunks){//std::cout<<"Vector Qadic\n";
-					_switcher= VectorQadic;
+		// store A for representation c
+		void _prepare(ApplyChoice c)
+		{
+			_switcher = c;
+			chunk_size = 16;
+			use_neg = _has_neg;
+			num_chunks = 0;
+			shift = 0;
+			integer maxValue = _maxValue, prime;
+			size_t maxBitSize = _maxBitSize;
+			_domain.convert(prime, _prime);
 
-					//std::cout<<"possible chunk size: "<<chunk_size<<std::endl;
-				}
-				else {
-					if (prime.bitsize()> 32){//std::cout<<"CRT\n";
-						_switcher= CRT;
+			switch (c) {
 
+			case MatrixQadic:
+				{
+					if (use_neg){
+						maxValue= maxValue<<1;
+						maxBitSize+=1;
 					}
-					else {//std::cout<<"Classic\n";
-						_switcher= Classic;
-
+					// compute the number of chunk
+					if (maxValue*prime* uint64_t(_n) < integer("9007199254740992")){
+						num_chunks=1;
+						use_neg=false;
 					}
-				}
-			}
+					else num_chunks =(maxBitSize) / chunk_size+ (((maxBitSize % chunk_size) > 0)? 1:0);
 
-			// set maximum size of chunk to 16
-			chunk_size = 16;
+					chunks = new double[_m*_n*num_chunks];
+					memset(chunks, 0, sizeof(double)*_m*_n*num_chunks);
 
-			switch (_switcher) {
+					shift= use_neg? maxValue : integer(0);
 
-			case MatrixQadic:
-				if (use_neg){
-					maxValue= maxValue<<1;
-					maxBitSize+=1;
-				}
-				// compute the number of chunk
-				if (maxValue*prime* uint32_t(_matM.coldim()) < integer("9007199254740992")){
-					num_chunks=1;
-					use_neg=false;
-				}
-				else num_chunks =(maxBitSize) / chunk_size+ (((maxBitSize % chunk_size) > 0)? 1:0);
-				//num_chunks = 1;
-				if (num_chunks ==1) use_neg= false;
-
-				//if (use_neg) num_chunks++; //the leading chunk will be negative
-
-				//int n2 = _m*_n;
-				chunks = new double[_m*_n*num_chunks];
-				memset(chunks, 0, sizeof(double)*_m*_n*num_chunks);
-
-				shift= use_neg? maxValue : integer(0);
-
-				create_MatrixQadic(_domain, _matM, chunks, num_chunks, shift);
-
-#ifdef DEBUG_CHUNK_SETUP
-				std::cout<<std::endl;
-				std::cout<<"max bit= "<<maxBitSize<<std::endl;
-				std::cout << num_chunks << " chunks of "<< chunk_size << " bits each" << std::endl;
-				if (!use_neg) std::cout << "not ";
-				std::cout << "using negative leading chunk" << std::endl;
-				std::cout << "shift is : "<<shift<<std::endl;
-				std::cout << "Contents of chunks: " << std::endl;
-				for (size_t i=0; i<num_chunks; i++) {
-					std::cout << "chunk " << i << std::endl;
-					for (size_t j=0; j<_m*_n; j++) {
-						std::cout << static_cast<long long>(chunks[i*_m*_n+j]);
-						if ((j+1)%_n) std::cout << ' '; else std::cout << std::endl;
-					}
+					create_MatrixQadic(_domain, _matM, chunks, num_chunks, shift);
 				}
-#endif
-
 				break;
 
 			case VectorQadic:
-				num_chunks = (prime.bitsize() / chunk_size)+ (((prime.bitsize() % chunk_size) > 0)? 1:0);
-				// convert integer matrix to double matrix
-				chunks  = new double[_m*_n];
-				memset(chunks, 0, sizeof(double)*_m*_n);
-				create_MatrixQadic (_domain, _matM, chunks, 1);
-
-				// if the matrix has negative entries
-				if (use_neg){
-					shift=maxValue;
-					double sh= (double) maxValue;
-					// shift the value of the entries in the matrix by ||A||=max(A_ij)
-					for (size_t i=0;i<_m*_n;++i)
-						chunks[i]+=sh;
-
+				{
+					num_chunks = (prime.bitsize() / chunk_size)+ (((prime.bitsize() % chunk_size) > 0)? 1:0);
+					// convert integer matrix to double matrix
+					chunks  = new double[_m*_n];
+					memset(chunks, 0, sizeof(double)*_m*_n);
+					create_MatrixQadic (_domain, _matM, chunks, 1);
+
+					// if the matrix has negative entries
+					if (use_neg){
+						shift=maxValue;
+						double sh= (double) maxValue;
+						// shift the value of the entries in the matrix by ||A||=max(A_ij)
+						for (size_t i=0;i<_m*_n;++i)
+							chunks[i]+=sh;
+					}
 				}
-
-				// allocate memory for the vector chunks
-				vchunks = new double[_n*num_chunks];
-				break;
-
-			case Classic:
 				break;
 
 			case CRT:
-				if (use_neg){
-					maxValue= maxValue<<1;
-					// maxBitSize+=1;
+				{
+					// the product is recovered in ]-pq/2, pq/2], so q > 2 ||A|| n
+					integer a_bound= 2*maxValue*uint64_t(_n)+1;
+					integer b_bound= sqrt(integer("9007199254740992")/uint64_t(_n));
+					MultiModRandomPrime mmrp;
+					std::vector<integer> rns_basis = mmrp.createPrimes(b_bound, a_bound);
+					_rns = new MultiModDouble(rns_basis);
+
+					// convert integer matrix to rns double matrix
+					chunks  = new double[_m*_n*_rns->size()];
+					memset(chunks, 0, sizeof(double)*_m*_n*_rns->size());
+					create_MatrixRNS(*_rns, _domain, _matM, chunks);
+
+					// prepare special CRT
+					Element g, s, q, two;
+					_q= _rns->getCRTmodulo();
+					_domain.init(q,_q);_domain.init(two,int64_t(2));
+					_domain.gcd(g, _inv_q, s, q, _prime);
+					if (_domain.compare(_inv_q, _domain.zero)<0 ) _domain.addin(_inv_q,_prime);
+					_domain.mul(_pq,_prime,q);
+					_domain.sub(_h_pq,_pq, _domain.one);
+					_domain.divin(_h_pq, two);
 				}
-				integer a_bound= maxValue*uint64_t(_n)+1;
-				integer b_bound= sqrt(integer("9007199254740992")/uint64_t(_n));	std::cout<<"max prime: "<<b_bound<<" max rns: "<<a_bound<<std::endl;
-				MultiModRandomPrime mmrp;
-				std::vector<integer> rns_basis = mmrp.createPrimes(b_bound, a_bound);
-				_rns = new MultiModDouble(rns_basis);
-
-				std::cout<<" CRT basi length= "<<_rns->size()<<std::endl;
-
-				// convert integer matrix to rns double matrix
-				chunks  = new double[_m*_n*_rns->size()];
-				memset(chunks, 0, sizeof(double)*_m*_n*_rns->size());
-				create_MatrixRNS(*_rns, _domain, _matM, chunks);
-
-				// allocate memory for the rns vector
-				vchunks = new double[_n*_rns->size()];
-
-				// prepare special CRT
-				Element g, s, q, two;
-				_q= _rns->getCRTmodulo();
-				_domain.init(q,_q);_domain.init(two,int64_t(2));
-				_domain.gcd(g, _inv_q, s, q, _prime);
-				if (_domain.compare(_inv_q, _domain.zero)<0 ) _domain.addin(_inv_q,_prime);
-				_domain.mul(_pq,_prime,q);
-				_domain.sub(_h_pq,_pq, _domain.one);
-				_domain.divin(_h_pq, two);
-
 				break;
 
+			case Classic:
+				break;
 			}
-
-#endif
-#ifdef DEBUG_CHUNK_APPLY
-			std::cout<<"A: \n";
-			_matM.write(std::cout);
-#endif
-
-			return _switcher;
 		}
 
+		void _release()
+		{
+			delete[] chunks;
+			chunks = NULL;
+			delete _rns;
+			_rns = NULL;
+			_switcher = Classic;
+		}
 
-		//#define DEBUG_CHUNK_APPLY
-		Vector& applyV(Vector& y, Vector& x, Vector &b) const
-		{ //applyV
-
-#ifdef DEBUG_CHUNK_APPLY
-			std::cout << "x: ";
-			for (size_t i=0; i<x.size(); i++)
-				std::cout << x[i] << ' ';
-			std::cout << std::endl;
-#endif
-			linbox_check( _n == x.size());
-			linbox_check( _m == y.size());
-
-			switch(_switcher) {//switch
-
+		// Y = A X, the k columns of X (resp. Y, B) being at x[j*ldx] (resp. y[i*ldy], b[i*ldb])
+		void _applyBlock(Element* y, size_t ldy, const Element* x, size_t ldx,
+				 const Element* b, size_t ldb, size_t k) const
+		{
+			switch(_switcher) {
+			case MatrixQadic:
+				_applyMatrixQadic(y, ldy, x, ldx, k);
+				break;
+			case VectorQadic:
+				_applyVectorQadic(y, ldy, x, ldx, k);
+				break;
+			case CRT:
+				if (b != NULL)
+					_applyCRT(y, ldy, x, ldx, b, ldb, k);
+				else
+					_applyClassic(y, ldy, x, ldx, k);
+				break;
 			case Classic:
-				_MD.vectorMul (y, _matM, x);
+				_applyClassic(y, ldy, x, ldx, k);
 				break;
+			}
+		}
 
-			case MatrixQadic:
-				{// mqadic
-#if 0
-					temp fix
-					_MD.vectorMul (y, _matM, x);
-					break;
+		void _applyClassic(Element* y, size_t ldy, const Element* x, size_t ldx, size_t k) const
+		{
+			const Element* a = _matM.getPointer();
+			size_t lda = _matM.getStride();
+			long m = (long) _m;
+#ifdef __LINBOX_USE_OPENMP
+#pragma omp parallel for schedule(dynamic, 8) if (_m*_n*k > 4096)
 #endif
-					double* dx = new double[_n];
-					for (size_t i=0; i<_n; i++) {
-						_domain.convert(dx[i], x[i]);
-					}
-					if (num_chunks == 1) {
-						double *ctd = new double[_m];
-						cblas_dgemv(CblasRowMajor, CblasNoTrans, (int) _m, (int) _n,
-							    1,  chunks, (int) _n, dx, 1, 0,  ctd, 1);
-
-						for (size_t i=0;i<_n;++i)
-							_domain.init(y[i],ctd[i]);
-						delete[] ctd;
-						delete[] dx;
-					}
-					else {
-						/*
-						 * rc: number of vectors to recombine
-						 * (the idea is that to compute a polynomial in the base 2^chunksize
-						 * with <= 53 bits in each coefficient, we can instead OR nonoverlapping blocks
-						 * of bits and then add them at the end, like this:
-						 *      AAAACCCCEEEEGGGG   instead  AAAA << 12 + BBBB << 10 + CCCC << 8 + ...
-						 *    +   BBBBDDDDFFFF00      of
-						 * also note that we need separate blocks for positive and negative entries)
-						 */
-						 int rc = int(52 / chunk_size) + 1; //constant at 4 for now
-						 /*
-						 * rclen: number of bytes in each of these OR-ed vectors
-						 * needs room to hold (max long long) << (num_chunks * chunksize)
-						 */
-						int rclen = (int)num_chunks*2 + 5;
-
-						unsigned char* combined = new unsigned char[(size_t)rc*_n*(size_t)rclen];
-						memset(combined, 0, (size_t)rc*_n*(size_t)rclen);
-
-						//order from major index to minor: combining index, component of sol'n, byte
-						//compute a product (chunk times x) for each chunk
-
-						double* ctd = new double[_n];
-#ifdef DEBUG_CHUNK_APPLY
-
-
-						std::cout<<"- A chunk --------------------------\n";
-						for (size_t k=0;k<num_chunks;++k){
-							for (size_t i=0;i<_m;i++){
-								for (size_t j=0;j<_n;j++)
-									std::cout<<integer(*(chunks+j+i*_n+k*_m*_n))<<",";
-								std::cout<<std::endl;
-							}
-							std::cout<<"\n";
-						}
+			for (long i=0; i<m; ++i) {
+				const Element* ai = a + (size_t)i*lda;
+				Element s;
+				for (size_t c=0; c<k; ++c) {
+					_domain.assign(s, _domain.zero);
+					for (size_t j=0; j<_n; ++j)
+						_domain.axpyin(s, ai[j], x[j*ldx+c]);
+					_domain.assign(y[(size_t)i*ldy+c], s);
+				}
+			}
+		}
 
-						std::cout<<"- A.x chunk---------------------\n";
+		void _applyMatrixQadic(Element* y, size_t ldy, const Element* x, size_t ldx, size_t k) const
+		{
+#ifdef TIMING_APPLY
+			Timer chrono;
+			chrono.clear();
+			chrono.start();
 #endif
-						for (size_t i=0; i<num_chunks; i++) {
-							cblas_dgemv(CblasRowMajor, CblasNoTrans,
-								    (int) _m, (int) _n, 1,
-								    chunks + (_m*_n*i),(int)  _n, dx, 1, 0, ctd, 1);
-#ifdef DEBUG_CHUNK_APPLY
-							for (size_t j=0;j<_n;j++)
-								std::cout<<integer(*(ctd+j))<<",";
-							std::cout<<std::endl;
+			// the chunk products must be nonnegative to be recombined:
+			// the negative entries of X go in k more columns
+			size_t bits;
+			bool neg = (num_chunks > 1) && _scan(bits, x, ldx, k);
+			size_t kk = neg ? 2*k : k;
+			std::vector<double> dX(_n*kk, 0.);
+			long n = (long) _n;
+#ifdef __LINBOX_USE_OPENMP
+#pragma omp parallel for schedule(static) if (_n*k > 4096)
 #endif
-
-							//if (!use_neg || i<num_chunks-1)
-							for (size_t j=0; j<_n; j++) {
-								// up to 53 bits will be ored-in, to be summed later
-								unsigned char* bitDest = combined;
-								bitDest += (size_t)rclen*((i % (size_t)rc)*_n+j);
-								long long mask = static_cast<long long>(ctd[j]);
-								bitDest += 2*i;
-								*(reinterpret_cast<long long*>(bitDest) ) |= mask;
-							}
-						}
-						delete[] dx;
-						for (size_t i=0; i<_n; i++) {
-							LinBox::integer result, tmp;
-							/*
-							   if (use_neg) {
-							   result = -ctd[i];
-							   result <<= (num_chunks-1)*16;
-							   }
-							   else
-							   */
-							result = 0;
-
-							for (int j=0; j<rc; j++) {
-								unsigned char* thispos = combined + (size_t)rclen*((size_t)j*_n+i);
-								Givaro::Protected::importWords(tmp, (size_t)rclen, -1, 1, 0, 0, thispos);
-								result += tmp;
+			for (long j=0; j<n; ++j)
+				for (size_t c=0; c<k; ++c) {
+					double v;
+					_domain.convert(v, x[(size_t)j*ldx+c]);
+					if (neg && v < 0)
+						dX[(size_t)j*kk+k+c] = -v;
+					else
+						dX[(size_t)j*kk+c] = v;
+				}
+#ifdef TIMING_APPLY
+			chrono.stop();
+			_convert_data+=chrono;
+			chrono.clear();
+			chrono.start();
+#endif
+			// compute a product (chunk times X) for each chunk
+			size_t mk = _m*kk;
+			std::vector<double> ctd(num_chunks*mk);
+			_dgemmBatch(num_chunks, _m, kk, _n, chunks, _m*_n, dX.data(), 0, ctd.data(), mk);
+#ifdef TIMING_APPLY
+			chrono.stop();
+			_apply+=chrono;
+			chrono.clear();
+			chrono.start();
+#endif
+			long m = (long) _m;
+			if (num_chunks == 1) {
+#ifdef __LINBOX_USE_OPENMP
+#pragma omp parallel for schedule(static) if (mk > 4096)
+#endif
+				for (long i=0; i<m; ++i)
+					for (size_t c=0; c<k; ++c)
+						_domain.init(y[(size_t)i*ldy+c], ctd[(size_t)i*kk+c]);
+			}
+			else {
+				// shift back the result by shift * sum(x)
+				std::vector<Element> acc(k);
+				if (use_neg)
+					_shiftSums(acc, x, ldx, k);
+
+				size_t rc = 52 / chunk_size + 1;
+				size_t rclen = num_chunks*2 + 6;
+#ifdef __LINBOX_USE_OPENMP
+#pragma omp parallel if (mk*num_chunks > 1024)
+#endif
+				{
+					std::vector<unsigned char> combined(rc*rclen);
+					integer res, tmp;
+#ifdef __LINBOX_USE_OPENMP
+#pragma omp for schedule(static)
+#endif
+					for (long i=0; i<m; ++i)
+						for (size_t c=0; c<k; ++c) {
+							const double* ci = ctd.data()+(size_t)i*kk+c;
+							_combine(res, ci, mk, num_chunks, 2, rc, rclen, combined.data());
+							if (neg) {
+								_combine(tmp, ci+k, mk, num_chunks, 2, rc, rclen, combined.data());
+								res -= tmp;
 							}
-							_domain.init(y[i], result);
+							Element& yi = y[(size_t)i*ldy+c];
+							_domain.init(yi, res);
+							if (use_neg)
+								_domain.subin(yi, acc[c]);
 						}
-						// shift back the result
-						if (use_neg) {
-							Element acc;
-							_domain.assign(acc,_domain.zero);
-							for (size_t i=0;i<x.size();++i)
-								_domain.addin(acc,x[i]);
-							_domain.mulin(acc,shift);
-
-							for (size_t i=0;i<y.size();++i)
-								_domain.subin(y[i], acc);
-						}
-						delete[] combined;
-						delete[] ctd;
-					}
 				}
-				break;
-
-			case VectorQadic:
-				{
+			}
 #ifdef TIMING_APPLY
-					Timer chrono;
-					chrono.clear();
-					chrono.start();
+			chrono.stop();
+			_convert_result+=chrono;
 #endif
-					// fill vector chunks with zero
-					memset(vchunks, 0, sizeof(double)*_n*num_chunks);
-
-					// smallest distance of non-overlaping chunks results
-					size_t rc = (52 / chunk_size) + 1;
-
-					// number of bytes in a chunks
-					size_t chunk_byte= (chunk_size == 32)? 4: 2;
-
-					// number of byte to store
-					size_t rclen = num_chunks*chunk_byte + 5;
-
-					unsigned char* combined = new unsigned char[rclen];
+		}
 
-					double *ctd= new double[_m*num_chunks];
-					if (chunk_size >=32)
-						create_VectorQadic_32 (_domain, x, vchunks, num_chunks);
+		void _applyVectorQadic(Element* y, size_t ldy, const Element* x, size_t ldx, size_t k) const
+		{
+#ifdef TIMING_APPLY
+			Timer chrono;
+			chrono.clear();
+			chrono.start();
+#endif
+			// X in chunks of 16 bits, nv chunks per entry, and the
+			// negative entries in k more columns
+			size_t bits;
+			bool neg = _scan(bits, x, ldx, k);
+			size_t nv = bits / chunk_size + ((bits % chunk_size) ? 1 : 0);
+			if (nv < num_chunks) nv = num_chunks;
+			size_t kk = neg ? 2*k : k;
+			size_t w = kk*nv;
+			std::vector<double> V(_n*w, 0.);
+			long n = (long) _n;
+#ifdef __LINBOX_USE_OPENMP
+#pragma omp parallel for schedule(static) if (_n*k > 1024)
+#endif
+			for (long j=0; j<n; ++j) {
+				integer tmp;
+				for (size_t c=0; c<k; ++c) {
+					_domain.convert(tmp, x[(size_t)j*ldx+c]);
+					if (tmp < 0) {
+						tmp = -tmp;
+						_split(V.data()+(size_t)j*w+(k+c)*nv, tmp, nv);
+					}
 					else
-						create_VectorQadic (_domain, x, vchunks, num_chunks);
+						_split(V.data()+(size_t)j*w+c*nv, tmp, nv);
+				}
+			}
 #ifdef TIMING_APPLY
-					chrono.stop();
-					_convert_data+=chrono;
-					chrono.clear();
-					chrono.start();
+			chrono.stop();
+			_convert_data+=chrono;
+			chrono.clear();
+			chrono.start();
 #endif
-					cblas_dgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, (int) _m, (int) num_chunks, (int) _n, 1.,
-						    chunks, (int) _n, vchunks, (int) num_chunks, 0., ctd, (int) num_chunks);
-
+			std::vector<double> ctd(_m*w);
+			_dgemmBatch(1, _m, w, _n, chunks, 0, V.data(), 0, ctd.data(), 0);
 #ifdef TIMING_APPLY
-					chrono.stop();
-					_apply+=chrono;
-					chrono.clear();
-					chrono.start();
+			chrono.stop();
+			_apply+=chrono;
+			chrono.clear();
+			chrono.start();
 #endif
+			std::vector<Element> acc(k);
+			if (use_neg)
+				_shiftSums(acc, x, ldx, k);
 
-#ifdef DEBUG_CHUNK_APPLY
-
-					std::cout<<"- A ---------------------------\n";
-					for (size_t i=0;i<_m;i++){
-						for (size_t j=0;j<_n;j++)
-							std::cout<<integer(*(chunks+j+i*_n))<<",";
-						std::cout<<std::endl;
-					}
-
-
-					std::cout<<"- x chunk-----------------------\n";
-					for (size_t i=0;i<_n;i++){
-						for (size_t j=0;j<num_chunks;j++)
-							std::cout<<integer(*(vchunks+j+i*num_chunks))<<",";
-						std::cout<<std::endl;
-					}
-
-					std::cout<<"- A.x chunk---------------------\n";
-					for (size_t i=0;i<_m;i++){
-						for (size_t j=0;j<num_chunks;j++)
-							std::cout<<integer(*(ctd+j+i*num_chunks))<<",";
-						std::cout<<std::endl;
-					}
+			size_t rc = 52 / chunk_size + 1;
+			size_t rclen = nv*2 + 6;
+			long m = (long) _m;
+#ifdef __LINBOX_USE_OPENMP
+#pragma omp parallel if (_m*w > 1024)
 #endif
-					for (size_t i=0; i< _m; ++i){
-						integer result=0, val;
-						for (size_t k=0; k< rc;++k){
-							memset(combined, 0, rclen);
-							unsigned char* BitDest = combined+chunk_byte*k;
-							for (size_t j=k; j< num_chunks; j+=rc){
-								long long mask = static_cast<long long>(ctd[i*num_chunks+j]);
-								*(reinterpret_cast<long long*>(BitDest) ) |= mask;
-								BitDest+=rc*chunk_byte;
-							}
-							Givaro::Protected::importWords(val, (size_t)rclen, -1, 1, 0, 0, combined);
-							result+=val;
+			{
+				std::vector<unsigned char> combined(rc*rclen);
+				integer res, tmp;
+#ifdef __LINBOX_USE_OPENMP
+#pragma omp for schedule(static)
+#endif
+				for (long i=0; i<m; ++i)
+					for (size_t c=0; c<k; ++c) {
+						const double* ci = ctd.data()+(size_t)i*w+c*nv;
+						_combine(res, ci, 1, nv, 2, rc, rclen, combined.data());
+						if (neg) {
+							_combine(tmp, ci+k*nv, 1, nv, 2, rc, rclen, combined.data());
+							res -= tmp;
 						}
-						_domain.init(y[i], result);
+						Element& yi = y[(size_t)i*ldy+c];
+						_domain.init(yi, res);
+						if (use_neg)
+							_domain.subin(yi, acc[c]);
 					}
-
-					// shift back the result
-					if (use_neg) {
-						Element acc;
-						_domain.assign(acc,_domain.zero);
-						for (size_t i=0;i<x.size();++i)
-							_domain.addin(acc,x[i]);
-						_domain.mulin(acc,shift);
-
-						for (size_t i=0;i<y.size();++i)
-							_domain.subin(y[i], acc);
-					}
-
-					delete[] combined;
-					delete[] ctd;
+			}
 #ifdef TIMING_APPLY
-					chrono.stop();
-					_convert_result+=chrono;
+			chrono.stop();
+			_convert_result+=chrono;
 #endif
+		}
 
-				}
-				break;
-
-			case CRT:
-
-				{
+		void _applyCRT(Element* y, size_t ldy, const Element* x, size_t ldx,
+			       const Element* b, size_t ldb, size_t k) const
+		{
 #ifdef TIMING_APPLY
-					Timer chrono;
-					chrono.clear();
-					chrono.start();
+			Timer chrono;
+			chrono.clear();
+			chrono.start();
 #endif
-					size_t rns_size= _rns->size();
-					integer mod, hmod;
-					mod  = _rns->getCRTmodulo ();
-					hmod = (mod-1)>>1;
-
-					// fill rns vector with zero
-					//memset(vchunks, 0, sizeof(double)*_n*rns_size);
-
-					// create rns vector
-					create_VectorRNS (*_rns, _domain, x, vchunks);
-
-					// allocate memory for the result
-					double *ctd= new double[_m*rns_size];
+			// X in the rns basis, one n x k block per prime
+			size_t rns_size= _rns->size();
+			size_t nk = _n*k;
+			std::vector<double> V(rns_size*nk);
+			long n = (long) _n;
+#ifdef __LINBOX_USE_OPENMP
+#pragma omp parallel for schedule(static) if (nk*rns_size > 4096)
+#endif
+			for (long j=0; j<n; ++j) {
+				integer tmp;
+				for (size_t c=0; c<k; ++c) {
+					_domain.convert(tmp, x[(size_t)j*ldx+c]);
+					for (size_t l=0; l<rns_size; ++l)
+						_rns->getBase(l).init(V[l*nk+(size_t)j*k+c], tmp);
+				}
+			}
 #ifdef TIMING_APPLY
-					chrono.stop();
-					_convert_data+=chrono;
-					chrono.clear();
-					chrono.start();
+			chrono.stop();
+			_convert_data+=chrono;
+			chrono.clear();
+			chrono.start();
 #endif
-					// perform multiplication componentwise
-					for (size_t i=0;i< rns_size; ++i)
-						cblas_dgemv(CblasRowMajor, CblasNoTrans, (int) _m, (int) _n,
-							    1, chunks+i*_m*_n, (int) _n, vchunks+i*_n, 1, 0, ctd+i*_m, 1);
+			// perform multiplication componentwise
+			size_t mk = _m*k;
+			std::vector<double> ctd(rns_size*mk);
+			_dgemmBatch(rns_size, _m, k, _n, chunks, _m*_n, V.data(), nk, ctd.data(), mk);
 #ifdef TIMING_APPLY
-					chrono.stop();
-					_apply+=chrono;
-					chrono.clear();
-					chrono.start();
+			chrono.stop();
+			_apply+=chrono;
+			chrono.clear();
+			chrono.start();
 #endif
-
-#ifdef DEBUG_CHUNK_APPLY
-					_rns->write(std::cout);
-					std::cout<<"- A RNS --------------------------\n";
-					for (size_t k=0;k<rns_size;++k){
-						for (size_t i=0;i<_m;i++){
-							for (size_t j=0;j<_n;j++)
-								std::cout<<integer(*(chunks+j+i*_n+k*_n*rns_size))<<",";
-							std::cout<<std::endl;
-						}
-						std::cout<<"\n";
-					}
-
-					std::cout<<"- x RNS-----------------------\n";
-					for (size_t i=0;i<_n;i++){
-						for (size_t j=0;j<rns_size;j++)
-							std::cout<<integer(*(vchunks+j+i*rns_size))<<",";
-						std::cout<<std::endl;
-					}
-					std::cout<<"- A.x RNS---------------------\n";
-					for (size_t i=0;i<_m;i++){
-						for (size_t j=0;j<rns_size;j++)
-							std::cout<<integer(*(ctd+j+i*rns_size))<<",";
-						std::cout<<std::endl;
-					}
+			// reconstruct the result modulo q, then modulo pq according to b
+			long m = (long) _m;
+#ifdef __LINBOX_USE_OPENMP
+#pragma omp parallel if (mk*rns_size > 1024)
 #endif
-
-
-					// reconstruct the result using CRT
-					std::vector<double> tmp(rns_size);
-					integer res;
-					for (size_t j=0;j<_m;++j){
-						for (size_t i=0;i<rns_size;++i)
-							_rns->getBase(i).init(tmp[i], ctd[j+i*_m]);
-						_rns->convert(res, tmp);
-						_domain.init(y[j], res);
-						//if (y[j] > hmod) y[j]-=mod;
-					}
-					delete[] ctd;
-
-#if 0
-					std::cout << "y mod q: ";
-					for (size_t i=0; i<y.size(); i++)
-						std::cout << y[i] << ' ';
-					std::cout << std::endl;
-					std::cout << "b: ";
-					for (size_t i=0; i<b.size(); i++)
-						std::cout << b[i] << ' ';
-					std::cout << std::endl;
-
-					std::cout<<"p: "<<_prime<<" q: "<<_q<<std::endl;
+			{
+				std::vector<double> tmp(rns_size);
+				integer res;
+				Element y_cur, b_cur;
+#ifdef __LINBOX_USE_OPENMP
+#pragma omp for schedule(static)
 #endif
-					Element y_cur, b_cur;
-					// finish crt according to b
-					for (size_t i=0;i<_m;++i){
-						_domain.mod(b_cur, b[i], _prime);
-						_domain.sub(y_cur, b_cur, y[i]);//std::cout<<"(b-y): "<<y_cur<<std::endl;
-						_domain.mulin(y_cur, _inv_q);//std::cout<<"((b-y)/q): "<<y_cur<<std::endl;
-						_domain.modin(y_cur, _prime);//std::cout<<"((b-y)/q mod p): "<<y_cur<<std::endl;
-						_domain.axpyin(y[i],_q, y_cur);//std::cout<<"y+p((b-y)/q mod p): "<<y[i]<<std::endl;
-						if ( y[i] > _h_pq) y[i]-=_pq;
+				for (long i=0; i<m; ++i)
+					for (size_t c=0; c<k; ++c) {
+						for (size_t l=0; l<rns_size; ++l)
+							_rns->getBase(l).init(tmp[l], ctd[l*mk+(size_t)i*k+c]);
+						_rns->convert(res, tmp);
+						Element& yi = y[(size_t)i*ldy+c];
+						_domain.init(yi, res);
+
+						_domain.mod(b_cur, b[(size_t)i*ldb+c], _prime);
+						_domain.sub(y_cur, b_cur, yi);
+						_domain.mulin(y_cur, _inv_q);
+						_domain.modin(y_cur, _prime);
+						if (_domain.compare(y_cur, _domain.zero)<0) _domain.addin(y_cur, _prime);
+						_domain.axpyin(yi, _q, y_cur);
+						if (yi > _h_pq) _domain.subin(yi, _pq);
 					}
-					/*
-					   std::cout << "y: ";
-					   for (size_t i=0; i<y.size(); i++)
-					   std::cout << y[i] << ' ';
-					   std::cout << std::endl;
-					   */
-
-#ifdef TIMING_APPLY
-					chrono.stop();
-					_convert_result+=chrono;
-#endif
-				}
-				break;
 			}
-
-#ifdef DEBUG_CHUNK_APPLY
-			std::cout << "y: ";
-			for (size_t i=0; i<y.size(); i++)
-				std::cout << y[i] << ' ';
-			std::cout << std::endl;
+#ifdef TIMING_APPLY
+			chrono.stop();
+			_convert_result+=chrono;
 #endif
-
-
-			return y;
 		}
 
-
-		Vector& applyVTrans(Vector& y, Vector& x) const
+		// whether X has a negative entry, bits gets the largest bit size of its entries
+		bool _scan(size_t& bits, const Element* x, size_t ldx, size_t k) const
 		{
-			TransposeMatrix<IMatrix> B(_matM);
-			return _MD.vectorMul (y, B, x);
+			bool neg = false;
+			integer tmp;
+			bits = 0;
+			for (size_t j=0; j<_n; ++j)
+				for (size_t c=0; c<k; ++c) {
+					_domain.convert(tmp, x[j*ldx+c]);
+					if (tmp < 0) neg = true;
+					if (tmp.bitsize() > bits) bits = tmp.bitsize();
+				}
+			return neg;
 		}
 
-
-		IMatrix& applyM (IMatrix &Y, const IMatrix &X) const
+		// acc[c] = shift * sum of the column c of X
+		void _shiftSums(std::vector<Element>& acc, const Element* x, size_t ldx, size_t k) const
 		{
-
-			linbox_check( _n == X.rowdim());
-			linbox_check( _m == Y.rowdim());
-			linbox_check( Y.coldim() == X.coldim());
-
-			if (!use_chunks){
-				_MD.mul (Y, _matM, X);
+			Element sh;
+			_domain.init(sh, shift);
+			for (size_t c=0; c<k; ++c) {
+				_domain.assign(acc[c], _domain.zero);
+				for (size_t j=0; j<_n; ++j)
+					_domain.addin(acc[c], x[j*ldx+c]);
+				_domain.mulin(acc[c], sh);
 			}
-			else{
-				size_t _k= X.coldim();
-				double* dX = new double[_n*_k];
-				for (size_t i=0; i<_n; i++)
-					for(size_t j=0;j<_k;++j)
-						_domain.convert(dX[i*_k+j], X.getEntry(i,j));
-
-#ifdef DEBUG_CHUNK_APPLYM
-				cout << "X: ";
-				X.write(cout,_domain);
-				cout << endl;
-#endif
-
-
-				if (num_chunks == 1) {
-					double *ctd = new double[_m*_k];
-					cblas_dgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans,
-						    (int) _m,(int) _k,(int) _n, 1,
-						    chunks,(int) _n, dX, (int) _k, 0, ctd, (int) _k);
+		}
 
-					for (size_t i=0;i<_m;++i)
-						for (size_t j=0;j<_k;++j)
-							_domain.init(Y.refEntry(i,j),ctd[i*_k+j]);
-					delete[] ctd;
-					delete[] dX;
-				}
-				else {
-					/*
-					 * rc: number of vectors to recombine
-					 *(the idea is that to compute a polynomial in the base 2^chunksize
-					 * with <= 53 bits in each coefficient, we can instead OR nonoverlapping blocks
-					 * of bits and then add them at the end, like this:
-					 *     AAAACCCCEEEEGGGG   instead  AAAA << 12 + BBBB << 10 + CCCC << 8 + ...
-					 *   +   BBBBDDDDFFFF00      of
-					 * also note that we need separate blocks for positive and negative entries)
-					 */
-
-					int rc = int(52 / chunk_size) + 1; //constant at 4 for now
-
-					//rclen: number of bytes in each of these OR-ed vectors
-					// needs room to hold (max long long) << (num_chunks * chunksize)
-
-					int rclen = (int)num_chunks*2 + 5;
-
-					// cout << "rc= " << rc << ", rclen = " << rclen << endl;
-
-					unsigned char* combined = new unsigned char[(size_t)rc*_m*_k*(size_t)rclen];
-					memset(combined, 0, (size_t)rc*_m*_k*(size_t)rclen);
-
-					//order from major index to minor: combining index, component of sol'n, byte
-
-					//compute a product (chunk times x) for each chunk
-					double* ctd = new double[_m*_k];
-
-					for (size_t i=0; i<num_chunks; i++) {//!@bug why not use FFLAS ?
-						cblas_dgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans,
-							    (int) _m,(int) _k,(int) _n, 1,
-							    chunks+(_m*_n*i),(int) _n, dX, (int) _k, 0, ctd, (int) _k);
-
-						if (!use_neg || i<num_chunks-1)
-							for (size_t j=0; j<_m*_k; j++) {
-								// up to 53 bits will be ored-in, to be summed later
-								unsigned char* bitDest = combined;
-								bitDest += (unsigned char)rclen*((i % (size_t)rc)*_m*_k+j);
-								long long mask = static_cast<long long>(ctd[j]);
-								bitDest += 2*i;
-								*(reinterpret_cast<long long*>(bitDest) ) |= mask;
-							}
-					}
+		// d[0..nv) gets the 16-bit chunks of a >= 0
+		static void _split(double* d, integer& a, size_t nv)
+		{
+			const size_t per = __LINBOX_SIZEOF_LONG / 2; // chunks per limb
+			size_t limbs = a.size();
+			for (size_t t=0; t<nv; ++t) {
+				size_t l = t / per;
+				d[t] = (l < limbs) ? double((a[l] >> (16*(t % per))) & 0xFFFF) : 0.;
+			}
+		}
 
-					delete[] dX;
+		/* res = sum_t v[t*stride] 2^(8 byte t), the v[t] being nonnegative doubles less than 2^53.
+		 * (the idea is that to compute a polynomial in the base 2^chunksize
+		 * with <= 53 bits in each coefficient, we can instead OR nonoverlapping blocks
+		 * of bits and then add them at the end, like this:
+		 *      AAAACCCCEEEEGGGG   instead  AAAA << 12 + BBBB << 10 + CCCC << 8 + ...
+		 *    +   BBBBDDDDFFFF00      of
+		 * rc blocks of rclen bytes in combined).
+		 */
+		static integer& _combine(integer& res, const double* v, size_t stride, size_t nchunks,
+					 size_t byte, size_t rc, size_t rclen, unsigned char* combined)
+		{
+			integer tmp;
+			memset(combined, 0, rc*rclen);
+			for (size_t t=0; t<nchunks; ++t) {
+				unsigned char* bitDest = combined + (t % rc)*rclen + byte*t;
+				uint64_t mask = static_cast<uint64_t>(v[t*stride]), cur;
+				memcpy(&cur, bitDest, sizeof(uint64_t));
+				cur |= mask;
+				memcpy(bitDest, &cur, sizeof(uint64_t));
+			}
+			res = 0;
+			for (size_t r=0; r<rc && r<nchunks; ++r) {
+				Givaro::Protected::importWords(tmp, rclen, -1, 1, 0, 0, combined + r*rclen);
+				res += tmp;
+			}
+			return res;
+		}
 
-					for (size_t i=0; i<_m*_k; i++) {
-						LinBox::integer result, tmp;
-						if (use_neg) {
-							result = -ctd[i];
-							result <<= uint64_t((num_chunks-1)*16);
-#ifdef DEBUG_CHUNK_APPLYM
-							cout << "rcneg: " << result << endl;
-#endif
-						}
-						else
-							result = 0;
-
-						for (int j=0; j<rc; j++) {
-							unsigned char* thispos = combined + (unsigned char) rclen*((size_t)j*_m*_k+i);
-							Givaro::Protected::importWords(tmp, (size_t)rclen, -1, 1, 0, 0, thispos);
-							result += tmp;
-#ifdef DEBUG_CHUNK_APPLYM
-							cout << "rc[" << j << "," << i << "]:" << tmp << endl;
+		/* C_l = A_l B_l for l < count, with A_l = A + l sa (m x n), B_l = B + l sb (n x k)
+		 * and C_l = C + l sc (m x k) row major; the products and row blocks of them
+		 * are shared among the threads.
+		 */
+		static void _dgemmBatch(size_t count, size_t m, size_t k, size_t n,
+					const double* A, size_t sa, const double* B, size_t sb, double* C, size_t sc)
+		{
+			size_t nb = 1;
+#ifdef __LINBOX_USE_OPENMP
+			if (count*m*n*k >= 65536) {
+				size_t nt = (size_t) omp_get_max_threads();
+				nb = std::min(m, (nt + count - 1) / count);
+				if (nb == 0) nb = 1;
+			}
 #endif
-						}
-#ifdef DEBUG_CHUNK_APPLYM
-						cout << "v2[" << i << "]:" << result  << endl;
+			size_t bs = (m + nb - 1) / nb;
+			long tasks = (long) (count*nb);
+#ifdef __LINBOX_USE_OPENMP
+#pragma omp parallel for schedule(static) if (tasks > 1)
 #endif
-
-						_domain.init(*(Y.getPointer()+i), result);
-					}
-					delete[] combined;
-					delete[] ctd;
-				}
+			for (long t=0; t<tasks; ++t) {
+				size_t l = (size_t)t / nb, i0 = ((size_t)t % nb)*bs;
+				if (i0 >= m) continue;
+				size_t mi = std::min(bs, m - i0);
+				const double *Al = A + l*sa + i0*n, *Bl = B + l*sb;
+				double *Cl = C + l*sc + i0*k;
+				if (k == 1)
+					cblas_dgemv(CblasRowMajor, CblasNoTrans, (int) mi, (int) n,
+						    1., Al, (int) n, Bl, 1, 0., Cl, 1);
+				else
+					cblas_dgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, (int) mi, (int) k, (int) n,
+						    1., Al, (int) n, Bl, (int) k, 0., Cl, (int) k);
 			}
-			return Y;
 		}
 
 
-
-	protected:
 		Domain                             _domain;
 		const IMatrix                     &_matM;
 		MatrixDomain<Domain>              _MD;
 		size_t                             _m;
 		size_t                             _n;
 
+		// bounds on the matrix computed by setup
+		integer          _maxValue;
+		size_t         _maxBitSize;
+		bool              _has_neg;
+		bool            _mqadic_ok;
+		bool            _vqadic_ok;
+
 		// data initialize by setup
-		bool           use_chunks;
 		bool              use_neg;
 		size_t         chunk_size;
 		size_t         num_chunks;
 		double *           chunks;
-		double *          vchunks;
 		integer             shift;
 		ApplyChoice     _switcher;
 		MultiModDouble      *_rns;
 		Element            _prime, _q, _inv_q, _pq, _h_pq;
 		mutable Timer              _apply, _convert_data, _convert_result;
 
-
-
-
 	};
 
 // #if !defined (__INTEL_COMPILER) && !defined(__clang__)
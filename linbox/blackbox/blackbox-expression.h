@@ -0,0 +1,203 @@
+/* linbox/blackbox/blackbox-expression.h
+ * Copyright (C) LinBox
+ *
+ * ========LICENCE========
+ * This file is part of the library LinBox.
+ *
+ * LinBox is free software: you can redistribute it and/or modify
+ * it under the terms of the  GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.	 See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ * ========LICENCE========
+ */
+
+/*! @file blackbox/blackbox-expression.h
+ * @ingroup blackbox
+ * @brief Fusion of products of diagonal, scalar and sparse blackboxes.
+ */
+
+#ifndef __LINBOX_blackbox_expression_H
+#define __LINBOX_blackbox_expression_H
+
+#include "linbox/util/error.h"
+#include "linbox/matrix/sparse-matrix.h"
+#include "linbox/blackbox/compose.h"
+#include "linbox/blackbox/diagonal.h"
+#include "linbox/blackbox/transpose.h"
+#include "linbox/blackbox/scalar-matrix.h"
+#include "linbox/blackbox/scaled-sparse.h"
+
+namespace LinBox
+{
+
+	/** Single blackbox equivalent to a Compose expression.
+	 *
+	 * The products of a sparse matrix (or its Transpose) by Diagonal and
+	 * ScalarMatrix factors are recognized from their type, and replaced by a
+	 * ScaledSparse with the factors folded into its entries; the product
+	 * \f$D_1 A^T D_2 A D_1\f$ of the symmetrized Wiedemann methods is
+	 * replaced by a ScaledGram. Any other expression is kept as is.
+	 *
+	 * \c value_type is the type of the equivalent blackbox, \c type what
+	 * make() returns: a new blackbox, or a reference to the expression.
+	 * \code
+	 * typename Fused<Blackbox>::type FB = Fused<Blackbox>::make(B);
+	 * \endcode
+	 \ingroup blackbox
+	 */
+	template <class Blackbox>
+	struct Fused {
+		typedef Blackbox value_type;
+		typedef const Blackbox& type;
+		static type make(const Blackbox &B) { return B; }
+	};
+
+	namespace Protected {
+		// the diagonals of a fused chain are read twice, they must agree
+		template <class Field>
+		void checkSameDiagonal(const Diagonal<Field> *D, const Diagonal<Field> *E)
+		{
+			if (D == E) return;
+			const BlasVector<Field> &d = D->getData(), &e = E->getData();
+			bool same = (d.size() == e.size());
+			for (size_t i = 0; same && i < d.size(); ++i)
+				same = D->field().areEqual(d[i], e[i]);
+			if (! same)
+				throw LinboxError("Fused: D1 A^T D2 A D1 with two different D1");
+		}
+	}
+
+	/// D A
+	template <class Field>
+	struct Fused<Compose<Diagonal<Field>, SparseMatrix<Field, SparseMatrixFormat::SparseSeq> > > {
+		typedef ScaledSparse<Field> value_type;
+		typedef value_type type;
+		static type make(const Compose<Diagonal<Field>, SparseMatrix<Field, SparseMatrixFormat::SparseSeq> > &B)
+		{
+			return type(*B.getRightPtr(), &B.getLeftPtr()->getData(), NULL);
+		}
+	};
+
+	/// A D
+	template <class Field>
+	struct Fused<Compose<SparseMatrix<Field, SparseMatrixFormat::SparseSeq>, Diagonal<Field> > > {
+		typedef ScaledSparse<Field> value_type;
+		typedef value_type type;
+		static type make(const Compose<SparseMatrix<Field, SparseMatrixFormat::SparseSeq>, Diagonal<Field> > &B)
+		{
+			return type(*B.getLeftPtr(), NULL, &B.getRightPtr()->getData());
+		}
+	};
+
+	/// D A E
+	template <class Field>
+	struct Fused<Compose<Compose<Diagonal<Field>, SparseMatrix<Field, SparseMatrixFormat::SparseSeq> >, Diagonal<Field> > > {
+		typedef ScaledSparse<Field> value_type;
+		typedef value_type type;
+		static type make(const Compose<Compose<Diagonal<Field>, SparseMatrix<Field, SparseMatrixFormat::SparseSeq> >, Diagonal<Field> > &B)
+		{
+			const Compose<Diagonal<Field>, SparseMatrix<Field, SparseMatrixFormat::SparseSeq> > *DA = B.getLeftPtr();
+			return type(*DA->getRightPtr(), &DA->getLeftPtr()->getData(), &B.getRightPtr()->getData());
+		}
+	};
+
+	/// D A^T
+	template <class Field>
+	struct Fused<Compose<Diagonal<Field>, Transpose<SparseMatrix<Field, SparseMatrixFormat::SparseSeq> > > > {
+		typedef ScaledSparse<Field> value_type;
+		typedef value_type type;
+		static type make(const Compose<Diagonal<Field>, Transpose<SparseMatrix<Field, SparseMatrixFormat::SparseSeq> > > &B)
+		{
+			return type(*B.getRightPtr()->getPtr(), &B.getLeftPtr()->getData(), NULL, true);
+		}
+	};
+
+	/// A^T D
+	template <class Field>
+	struct Fused<Compose<Transpose<SparseMatrix<Field, SparseMatrixFormat::SparseSeq> >, Diagonal<Field> > > {
+		typedef ScaledSparse<Field> value_type;
+		typedef value_type type;
+		static type make(const Compose<Transpose<SparseMatrix<Field, SparseMatrixFormat::SparseSeq> >, Diagonal<Field> > &B)
+		{
+			return type(*B.getLeftPtr()->getPtr(), NULL, &B.getRightPtr()->getData(), true);
+		}
+	};
+
+	/// alpha A
+	template <class Field>
+	struct Fused<Compose<ScalarMatrix<Field>, SparseMatrix<Field, SparseMatrixFormat::SparseSeq> > > {
+		typedef ScaledSparse<Field> value_type;
+		typedef value_type type;
+		static type make(const Compose<ScalarMatrix<Field>, SparseMatrix<Field, SparseMatrixFormat::SparseSeq> > &B)
+		{
+			typename Field::Element alpha;
+			B.field().init(alpha);
+			B.getLeftPtr()->getScalar(alpha);
+			type S(*B.getRightPtr(), NULL, NULL);
+			S.scale(alpha);
+			return S;
+		}
+	};
+
+	/// A^T A
+	template <class Field>
+	struct Fused<Compose<Transpose<SparseMatrix<Field, SparseMatrixFormat::SparseSeq> >, SparseMatrix<Field, SparseMatrixFormat::SparseSeq> > > {
+		typedef ScaledGram<Field> value_type;
+		typedef value_type type;
+		static type make(const Compose<Transpose<SparseMatrix<Field, SparseMatrixFormat::SparseSeq> >, SparseMatrix<Field, SparseMatrixFormat::SparseSeq> > &B)
+		{
+			if (B.getLeftPtr()->getPtr() != B.getRightPtr())
+				throw LinboxError("Fused: A^T B with B different from A");
+			return type(*B.getRightPtr(), NULL, NULL);
+		}
+	};
+
+	/// D1 A^T D2 A D1, as built by the symmetrized Wiedemann rank
+	template <class Field>
+	struct Fused<Compose<Compose<Compose<Compose<Diagonal<Field>, Transpose<SparseMatrix<Field, SparseMatrixFormat::SparseSeq> > >, Diagonal<Field> >, SparseMatrix<Field, SparseMatrixFormat::SparseSeq> >, Diagonal<Field> > > {
+		typedef SparseMatrix<Field, SparseMatrixFormat::SparseSeq> Matrix;
+		typedef Compose<Compose<Compose<Compose<Diagonal<Field>, Transpose<Matrix> >, Diagonal<Field> >, Matrix>, Diagonal<Field> > Expression;
+		typedef ScaledGram<Field> value_type;
+		typedef value_type type;
+		static type make(const Expression &B)
+		{
+			const Diagonal<Field> *D1 = B.getRightPtr();
+			const Matrix *A = B.getLeftPtr()->getRightPtr();
+			const Compose<Compose<Diagonal<Field>, Transpose<Matrix> >, Diagonal<Field> > *DATD = B.getLeftPtr()->getLeftPtr();
+			const Diagonal<Field> *D2 = DATD->getRightPtr();
+			const Compose<Diagonal<Field>, Transpose<Matrix> > *DAT = DATD->getLeftPtr();
+
+			if (DAT->getRightPtr()->getPtr() != A)
+				throw LinboxError("Fused: D1 B^T D2 A D1 with B different from A");
+			Protected::checkSameDiagonal(DAT->getLeftPtr(), D1);
+			return type(*A, &D1->getData(), &D2->getData());
+		}
+	};
+
+	/// Equivalent blackbox of B, see Fused.
+	template <class Blackbox>
+	typename Fused<Blackbox>::type fuse(const Blackbox &B)
+	{
+		return Fused<Blackbox>::make(B);
+	}
+
+} // LinBox
+
+#endif // __LINBOX_blackbox_expression_H
+
+// Local Variables:
+// mode: C++
+// tab-width: 4
+// indent-tabs-mode: nil
+// c-basic-offset: 4
+// End:
+// vim:sts=4:sw=4:ts=4:et:sr:cino=>s,f0,{0,g0,(0,\:0,t0,+0,=s
@@ -51,6 +51,25 @@ namespace LinBox
 #endif
 	};// empty class so doc++ makes a nice hierarchy.
 
+	/** Block blackboxes: applyLeft(Y, X) computes Y = A X and applyRight(Y, X)
+	 * computes Y = X A for dense blocks of vectors X and Y.
+	 * Specialize to true for them (see blackbox/blockbb.h).
+	 */
+	template<class _BB>
+	struct is_blockbb {
+		static const bool value = false;
+	};
+
+	/** Reentrant blackboxes: apply and applyTranspose of one object may run
+	 * concurrently in several threads. Specialize to true for them, so that
+	 * MatrixDomain::blackboxMulLeft and blackboxMulRight apply them to
+	 * batches of columns (rows) in parallel.
+	 */
+	template<class _BB>
+	struct is_reentrant {
+		static const bool value = false;
+	};
+
 } // namespace LinBox
 
 #endif //  __LINBOX_blackbox_interface_H
@@ -30,12 +30,8 @@
 #include "linbox/util/error.h"
 #include "linbox/matrix/dense-matrix.h"
 #include "linbox/matrix/matrix-domain.h"
+#include "linbox/blackbox/blackbox-interface.h"
 namespace LinBox {
-	
-template<class _BB> 
-struct is_blockbb { 
-	static const bool value = false;
-};
 
 /// converts a black box into a block black box
 template<class _BB>
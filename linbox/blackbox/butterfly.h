@@ -47,11 +47,17 @@
 #define __LINBOX_butterfly_H
 
 #include "linbox/blackbox/blackbox-interface.h"
+#include "linbox/blackbox/blockbb.h"
 #include "linbox/vector/vector-domain.h"
 
 /*! @file blackbox/butterfly.h
 */
 
+#ifndef __LINBOX_BUTTERFLY_BLOCK
+/// Number of elements kept in cache while applying the lower levels of a Butterfly.
+#define __LINBOX_BUTTERFLY_BLOCK 4096
+#endif
+
 namespace LinBox
 {
 
@@ -88,6 +94,13 @@ namespace LinBox
 	 * somehow be converted to dense vectors before this matrix may
 	 * be applied to them.
 	 *
+	 * The switches are stored level by level, those of a level in one
+	 * contiguous array, in the order the apply reads them. As in a radix
+	 * blocked FFT, the lower levels are applied to one cache sized chunk
+	 * of the vector after the other, and the chunks, as well as the switches
+	 * of a higher level, are shared among the OpenMP threads. A dense block
+	 * of vectors is switched row by row in one pass (applyLeft).
+	 *
 	 * @param Vector LinBox dense vector type
 	 * @param Switch switch object type
 	 \ingroup blackbox
@@ -159,6 +172,16 @@ namespace LinBox
 		template<class OutVector, class InVector>
 		OutVector& applyTranspose (OutVector& y, const InVector& x) const;
 
+		/** Y = A X, for a dense block X.
+		 * Each switch combines two rows of Y.
+		 */
+		template<class Matrix>
+		Matrix& applyLeft (Matrix& Y, const Matrix& X) const;
+
+		/// Y = X A, for a dense block X.
+		template<class Matrix>
+		Matrix& applyRight (Matrix& Y, const Matrix& X) const;
+
 		template<typename _Tp1, typename _Sw1 = typename Switch::template rebind<_Tp1>::other>
 		struct rebind {
 			typedef Butterfly<_Tp1, _Sw1> other;
@@ -245,14 +268,32 @@ namespace LinBox
 		// a given switch.
 		std::vector< std::pair< size_t, size_t > > _indices;
 
-		// Vector of switches
+		// Vector of switches, in the same order as the indices
 		std::vector<Switch> _switches;
 
 		// Build the vector of indices
 		void buildIndices ();
 
+		// Sort the indices and switches level by level
+		void levelOrder ();
+
+		// Apply op (switch, i, j) to the switches in the order of apply,
+		// resp. applyTranspose, width elements being switched at a time
+		template<class Op>
+		void forward (const Op& op, size_t width) const;
+		template<class Op>
+		void backward (const Op& op, size_t width) const;
+
+		// Number of levels applied chunk by chunk
+		size_t blockLevels (size_t l_p, size_t width) const;
+
 	}; // template <class Field, class Vector> class Butterfly
 
+	template <class Field, class Switch>
+	struct is_blockbb<Butterfly<Field, Switch> > {
+		static const bool value = true;
+	};
+
 	/** A function used with Butterfly Blackbox Matrices.
 	 * This function takes an STL vector x of booleans, and returns
 	 * a vector y of booleans such that setting the switches marked
@@ -48,10 +48,15 @@
 #define __LINBOX_butterfly_INL
 
 #include <vector>
+#include "linbox/util/debug.h"
 #include "linbox/blackbox/blackbox-interface.h"
 #include "linbox/vector/vector-domain.h"
 #include "linbox/field/hom.h"
 
+#ifdef __LINBOX_USE_OPENMP
+#include <omp.h>
+#endif
+
 /** @file blackbox/butterfly.inl
  *
  * First linbox block: butterfly method implementations
@@ -70,19 +75,19 @@ namespace LinBox
 
 		for (unsigned int i = 0; i < _indices.size (); ++i)
 			_switches.push_back (factory.makeSwitch ());
+
+		levelOrder ();
 	}
 
 	template <class Field, class Switch>
 	template<class OutVector, class InVector>
 	inline OutVector& Butterfly<Field, Switch>::apply (OutVector& y, const InVector& x) const
 	{
-		std::vector< std::pair<size_t, size_t> >::const_iterator idx_iter = _indices.begin ();
-		typename std::vector<Switch>::const_iterator switch_iter = _switches.begin ();
-
 		_VD.copy (y, x);
 
-		for (; idx_iter != _indices.end (); ++idx_iter, ++switch_iter)
-			switch_iter->apply (field(), y[idx_iter->first], y[idx_iter->second]);
+		forward ([&](const Switch &sw, size_t i, size_t j) {
+			sw.apply (field(), y[i], y[j]);
+		}, 1);
 
 		return y;
 	}
@@ -91,17 +96,200 @@ namespace LinBox
 	template <class OutVector, class InVector>
 	inline OutVector& Butterfly<Field, Switch>::applyTranspose (OutVector& y, const InVector& x) const
 	{
-		std::vector< std::pair<size_t, size_t> >::const_reverse_iterator idx_iter = _indices.rbegin ();
-		typename std::vector<Switch>::const_reverse_iterator switch_iter = _switches.rbegin ();
-
 		_VD.copy (y, x);
 
-		for (; idx_iter != _indices.rend (); ++idx_iter, ++switch_iter)
-			switch_iter->applyTranspose (field(), y[idx_iter->first], y[idx_iter->second]);
+		backward ([&](const Switch &sw, size_t i, size_t j) {
+			sw.applyTranspose (field(), y[i], y[j]);
+		}, 1);
 
 		return y;
 	}
 
+	template <class Field, class Switch>
+	template <class Matrix>
+	inline Matrix& Butterfly<Field, Switch>::applyLeft (Matrix& Y, const Matrix& X) const
+	{
+		linbox_check (X.rowdim () == _n && Y.rowdim () == _n);
+		linbox_check (X.coldim () == Y.coldim ());
+
+		size_t s = X.coldim (), ldx = X.getStride (), ldy = Y.getStride ();
+		const Element *xp = X.getPointer ();
+		Element *yp = Y.getPointer ();
+		for (size_t i = 0; i < _n; ++i)
+			for (size_t k = 0; k < s; ++k)
+				field().assign (yp[i*ldy+k], xp[i*ldx+k]);
+
+		forward ([&](const Switch &sw, size_t i, size_t j) {
+			Element *yi = yp + i*ldy, *yj = yp + j*ldy;
+			for (size_t k = 0; k < s; ++k)
+				sw.apply (field(), yi[k], yj[k]);
+		}, s);
+
+		return Y;
+	}
+
+	template <class Field, class Switch>
+	template <class Matrix>
+	inline Matrix& Butterfly<Field, Switch>::applyRight (Matrix& Y, const Matrix& X) const
+	{
+		linbox_check (X.coldim () == _n && Y.coldim () == _n);
+		linbox_check (X.rowdim () == Y.rowdim ());
+
+		// each row of Y is A^T times the row of X
+		size_t ldx = X.getStride (), ldy = Y.getStride ();
+		const Element *xp = X.getPointer ();
+		Element *yp = Y.getPointer ();
+		for (size_t l = 0; l < X.rowdim (); ++l) {
+			Element *yl = yp + l*ldy;
+			for (size_t k = 0; k < _n; ++k)
+				field().assign (yl[k], xp[l*ldx+k]);
+
+			backward ([&](const Switch &sw, size_t i, size_t j) {
+				sw.applyTranspose (field(), yl[i], yl[j]);
+			}, 1);
+		}
+
+		return Y;
+	}
+
+	/* The switches of a sub-group of size n_p = 2^l_p form l_p levels of
+	 * n_p/2 switches, level k pairing i and i+2^k within blocks of size 2^(k+1).
+	 * buildIndices lists them depth first; the switches of different blocks
+	 * commute, so they may be applied level by level instead, and the lower
+	 * levels chunk by chunk. A sub-group is followed by the switches (i, i+n_p),
+	 * i < start, mixing it with the previous ones.
+	 */
+	template <class Field, class Switch>
+	inline size_t Butterfly<Field, Switch>::blockLevels (size_t l_p, size_t width) const
+	{
+		size_t lb = 0;
+		while (lb < l_p && ((size_t)2 << lb) * width <= __LINBOX_BUTTERFLY_BLOCK)
+			++lb;
+		return lb;
+	}
+
+	template <class Field, class Switch>
+	template <class Op>
+	inline void Butterfly<Field, Switch>::forward (const Op &op, size_t width) const
+	{
+		const Switch *sw = _switches.data ();
+
+		for (size_t p = 0, start = 0; p < _n_vec.size (); start += _n_vec[p], ++p) {
+			size_t n_p = _n_vec[p], l_p = _l_vec[p], half = n_p / 2;
+			size_t lb = blockLevels (l_p, width), c = (size_t)1 << lb;
+			long chunks = (long) (n_p >> lb);
+
+			// lower levels, one chunk of 2^lb entries at a time
+#ifdef __LINBOX_USE_OPENMP
+#pragma omp parallel for schedule(static) if (n_p * width > 4 * __LINBOX_BUTTERFLY_BLOCK)
+#endif
+			for (long ch = 0; ch < chunks; ++ch) {
+				size_t first = start + (size_t)ch * c;
+				for (size_t k = 0, d = 1; k < lb; ++k, d <<= 1) {
+					const Switch *s = sw + k * half + (size_t)ch * (c / 2);
+					for (size_t b = 0; b < c; b += 2*d, s += d)
+						for (size_t i = 0; i < d; ++i)
+							op (s[i], first+b+i, first+b+i+d);
+				}
+			}
+
+			// higher levels, one after the other
+			for (size_t k = lb; k < l_p; ++k) {
+				const Switch *s = sw + k * half;
+				size_t d = (size_t)1 << k;
+#ifdef __LINBOX_USE_OPENMP
+#pragma omp parallel for schedule(static) if (n_p * width > 4 * __LINBOX_BUTTERFLY_BLOCK)
+#endif
+				for (long q = 0; q < (long)half; ++q) {
+					size_t i = start + (((size_t)q >> k) << (k+1)) + ((size_t)q & (d-1));
+					op (s[q], i, i+d);
+				}
+			}
+			sw += l_p * half;
+
+			for (size_t i = 0; i < start; ++i)
+				op (sw[i], i, i+n_p);
+			sw += start;
+		}
+	}
+
+	template <class Field, class Switch>
+	template <class Op>
+	inline void Butterfly<Field, Switch>::backward (const Op &op, size_t width) const
+	{
+		const Switch *sw = _switches.data () + _switches.size ();
+
+		for (size_t p = _n_vec.size (), start = _n - (_n_vec.empty () ? 0 : _n_vec.back ()); p-- > 0; ) {
+			size_t n_p = _n_vec[p], l_p = _l_vec[p], half = n_p / 2;
+			size_t lb = blockLevels (l_p, width), c = (size_t)1 << lb;
+			long chunks = (long) (n_p >> lb);
+
+			sw -= start;
+			for (size_t i = 0; i < start; ++i)
+				op (sw[i], i, i+n_p);
+			sw -= l_p * half;
+
+			for (size_t k = l_p; k-- > lb; ) {
+				const Switch *s = sw + k * half;
+				size_t d = (size_t)1 << k;
+#ifdef __LINBOX_USE_OPENMP
+#pragma omp parallel for schedule(static) if (n_p * width > 4 * __LINBOX_BUTTERFLY_BLOCK)
+#endif
+				for (long q = 0; q < (long)half; ++q) {
+					size_t i = start + (((size_t)q >> k) << (k+1)) + ((size_t)q & (d-1));
+					op (s[q], i, i+d);
+				}
+			}
+
+#ifdef __LINBOX_USE_OPENMP
+#pragma omp parallel for schedule(static) if (n_p * width > 4 * __LINBOX_BUTTERFLY_BLOCK)
+#endif
+			for (long ch = 0; ch < chunks; ++ch) {
+				size_t first = start + (size_t)ch * c;
+				for (size_t k = lb, d = c/2; k-- > 0; d >>= 1) {
+					const Switch *s = sw + k * half + (size_t)ch * (c / 2);
+					for (size_t b = 0; b < c; b += 2*d, s += d)
+						for (size_t i = 0; i < d; ++i)
+							op (s[i], first+b+i, first+b+i+d);
+				}
+			}
+
+			if (p > 0) start -= _n_vec[p-1];
+		}
+	}
+
+	template <class Field, class Switch>
+	void Butterfly<Field, Switch>::levelOrder ()
+	{
+		std::vector<size_t> pos (_indices.size ());
+		size_t t = 0, base = 0;
+
+		for (size_t p = 0, start = 0; p < _n_vec.size (); start += _n_vec[p], ++p) {
+			size_t n_p = _n_vec[p], half = n_p / 2;
+			for (size_t c = 0; c < half * _l_vec[p]; ++c, ++t) {
+				size_t i = _indices[t].first - start, d = _indices[t].second - _indices[t].first;
+				size_t k = 0;
+				while (((size_t)1 << k) < d) ++k;
+				pos[t] = base + k * half + (i >> (k+1)) * d + (i & (d-1));
+			}
+			base += half * _l_vec[p];
+
+			for (size_t i = 0; i < start; ++i, ++t)
+				pos[t] = base + _indices[t].first;
+			base += start;
+		}
+		linbox_check (t == _indices.size ());
+
+		std::vector< std::pair< size_t, size_t > > indices (_indices);
+		std::vector<Switch> switches (_switches);
+		for (t = 0; t < pos.size (); ++t) {
+			indices[pos[t]] = _indices[t];
+			switches[pos[t]] = _switches[t];
+		}
+		_indices.swap (indices);
+		_switches.swap (switches);
+	}
+
 	template <class Field, class Switch>
 	void Butterfly<Field, Switch>::buildIndices ()
 	{
@@ -32,6 +32,7 @@
 #include "linbox/linbox-config.h"
 #include "linbox/blackbox/blackbox-interface.h"
 #include "linbox/vector/blas-vector.h"
+#include "linbox/vector/scratch-vector.h"
 
 namespace LinBox
 {
@@ -81,14 +82,8 @@ namespace LinBox
 		 * @param B blackbox
 		 */
 		Compose (const Blackbox1 &A, const Blackbox2 &B) :
-			_A_ptr(&A), _B_ptr(&B),_z(A.field())
-		{
-			// Rich Seagraves - "It seems VectorWrapper somehow
-			// became depricated.  Makes the assumption that
-			// this vector type supports resize"
-			// VectorWrapper::ensureDim (_z, _A_ptr->coldim ());
-			_z.resize(_A_ptr->coldim());
-		}
+			_A_ptr(&A), _B_ptr(&B),_z(BlasVector<Field>(A.field(), A.coldim()))
+		{}
 
 		/** Constructor of C := (*A_ptr)*(*B_ptr).
 		 * This constructor creates a matrix that is a product of two black box
@@ -97,14 +92,11 @@ namespace LinBox
 		 * @param B_ptr blackbox
 		 */
 		Compose (const Blackbox1 *A_ptr, const Blackbox2 *B_ptr) :
-			_A_ptr(A_ptr), _B_ptr(B_ptr),_z(A_ptr->field())
+			_A_ptr(A_ptr), _B_ptr(B_ptr),_z(BlasVector<Field>(A_ptr->field(), A_ptr->coldim()))
 		{
 			linbox_check (A_ptr != (Blackbox1 *) 0);
 			linbox_check (B_ptr != (Blackbox2 *) 0);
 			linbox_check (A_ptr->coldim () == B_ptr->rowdim ());
-
-			//			VectorWrapper::ensureDim (_z, _A_ptr->coldim ());
-			_z.resize(_A_ptr->coldim());
 		}
 
 		/** Copy constructor.
@@ -113,10 +105,8 @@ namespace LinBox
 		 * @param[in] Mat blackbox to copy.
 		 */
 		Compose (const Compose<Blackbox1, Blackbox2>& Mat) :
-			_A_ptr ( Mat._A_ptr), _B_ptr ( Mat._B_ptr),_z(Mat.field())
-		{
-			_z.resize(_A_ptr->coldim());
-		}
+			_A_ptr ( Mat._A_ptr), _B_ptr ( Mat._B_ptr),_z(Mat._z)
+		{}
 
 		/// Destructor
 		~Compose () {}
@@ -135,16 +125,29 @@ namespace LinBox
 		/** Matrix * column vector product.
 		 * \f$ y \gets (A\cdot B)\cdot x\f$
 		 * Applies B, then A.
+		 * Several threads may apply the same Compose at once.
 		 * @return reference to vector y containing output.
 		 * @param  x constant reference to vector to contain input
 		 * @param[out] y the result.
 		 */
 		template <class OutVector, class InVector>
 		inline OutVector& apply (OutVector& y, const InVector& x) const
+		{
+			typename ScratchVector<BlasVector<Field> >::Guard z(_z);
+			return apply (y, x, *z);
+		}
+
+		/** Matrix * column vector product with the caller's intermediate vector.
+		 * @param[out] y the result.
+		 * @param  x input
+		 * @param  z vector of size <code>A.coldim()</code>, receives Bx.
+		 */
+		template <class OutVector, class InVector, class Vector>
+		inline OutVector& apply (OutVector& y, const InVector& x, Vector& z) const
 		{
 			if ((_A_ptr != 0) && (_B_ptr != 0)) {
-				_B_ptr->apply (_z, x);
-				_A_ptr->apply (y, _z);
+				_B_ptr->apply (z, x);
+				_A_ptr->apply (y, z);
 			}
 
 			return y;
@@ -159,10 +162,18 @@ namespace LinBox
 		 */
 		template <class OutVector, class InVector>
 		inline OutVector& applyTranspose (OutVector& y, const InVector& x) const
+		{
+			typename ScratchVector<BlasVector<Field> >::Guard z(_z);
+			return applyTranspose (y, x, *z);
+		}
+
+		/// row vector * matrix product with the caller's vector z of size <code>A.coldim()</code>.
+		template <class OutVector, class InVector, class Vector>
+		inline OutVector& applyTranspose (OutVector& y, const InVector& x, Vector& z) const
 		{
 			if ((_A_ptr != 0) && (_B_ptr != 0)) {
-				_A_ptr->applyTranspose (_z, x);
-				_B_ptr->applyTranspose (y, _z);
+				_A_ptr->applyTranspose (z, x);
+				_B_ptr->applyTranspose (y, z);
 			}
 
 			return y;
@@ -236,7 +247,7 @@ namespace LinBox
 		const Blackbox2 *_B_ptr;
 
 		// local intermediate vector
-		mutable BlasVector<Field> _z;
+		ScratchVector<BlasVector<Field> > _z;
 	};
 
 	/// specialization for _Blackbox1 = _Blackbox2
@@ -254,21 +265,18 @@ namespace LinBox
        * Build the product of any matrices of compatible dimensions.
        * Requires A.coldim() equals B.rowdim().
        */
-		Compose (const Blackbox& A, const Blackbox& B) {
+		Compose (const Blackbox& A, const Blackbox& B) :
+			_zl(std::vector<DenseVector<Field> >(1, DenseVector<Field>(B.field(), B.rowdim())))
+		{
 			_BlackboxL.push_back(&A);
 			_BlackboxL.push_back(&B);
-
-			_zl.clear();
-            _zl.emplace_back(B.field(), B.rowdim());
-
 		}
 
-		Compose (const Blackbox* Ap, const Blackbox* Bp) {
+		Compose (const Blackbox* Ap, const Blackbox* Bp) :
+			_zl(std::vector<DenseVector<Field> >(1, DenseVector<Field>(Bp->field(), Bp->rowdim())))
+		{
 			_BlackboxL.push_back(Ap);
 			_BlackboxL.push_back(Bp);
-
-			_zl.clear();
-            _zl.emplace_back(Bp->field(), Bp->rowdim());
 		}
 
 		/** Constructor of C := prod Ai from blackbox matrices Ai.
@@ -276,38 +284,26 @@ namespace LinBox
 		 */
 		template<class BPVector>
 		Compose (const BPVector& v) :
-			_BlackboxL(v.begin(), v.end())
+			_BlackboxL(v.begin(), v.end()), _zl(intermediates(_BlackboxL))
 		{
-
 			linbox_check(v.size() > 0);
-			_zl.clear();
-			// it would be good to use just 2 vectors and flip/flop.
-			for (const auto& b_p : _BlackboxL)
-                _zl.emplace_back( b_p.field(), b_p.coldim());
 		}
 
 		~Compose () {}
 
+		/// y = A_0 (A_1 (... A_{k-1} x)), several threads may apply at once.
 		template <class OutVector, class InVector>
 		inline OutVector& apply (OutVector& y, const InVector& x) const
 		{
+			size_t k = _BlackboxL.size();
+			if (k == 1) return _BlackboxL[0]->apply(y, x);
 
-			typename std::vector<const Blackbox*>::const_reverse_iterator b_p;
-			typename std::vector<DenseVector<Field> >::reverse_iterator z_p, pz_p;
-			b_p = _BlackboxL.rbegin();
-			pz_p = z_p = _zl.rbegin();
-			typedef DenseSubvector<Field> BSub;
-			BSub pz_p_vec(*pz_p);
-
-			(*b_p) -> apply(pz_p_vec, x);
-			++ b_p;  ++ z_p;
-
-			for (; z_p != _zl.rend(); ++ b_p, ++ z_p, ++ pz_p) {
-				 BSub z_p_vec(*z_p);
-				(*b_p) -> apply (z_p_vec,pz_p_vec);
-			}
-
-			(*b_p) -> apply(y, pz_p_vec);
+			// z[i] receives the output of A_{i+1}
+			typename ScratchVector<std::vector<DenseVector<Field> > >::Guard z(_zl);
+			_BlackboxL[k-1]->apply((*z)[k-2], x);
+			for (size_t i = k-2; i > 0; --i)
+				_BlackboxL[i]->apply((*z)[i-1], (*z)[i]);
+			_BlackboxL[0]->apply(y, (*z)[0]);
 
 			return y;
 		}
@@ -324,20 +320,14 @@ namespace LinBox
 		template <class OutVector, class InVector>
 		inline OutVector& applyTranspose (OutVector& y, const InVector& x) const
 		{
-			typename std::vector<const Blackbox*>::reverse_iterator b_p;
-			typename std::vector<std::vector<Element> >::reverse_iterator z_p, nz_p;
+			size_t k = _BlackboxL.size();
+			if (k == 1) return _BlackboxL[0]->applyTranspose(y, x);
 
-			b_p = _BlackboxL.rbegin();
-			z_p = nz_p = _zl.rbegin();
-
-			(*b_p) -> applyTranspose (*z_p, x);
-
-			++ b_p; ++ nz_p;
-
-			for (; nz_p != _zl.rend(); ++ z_p, ++ nz_p, ++ b_p)
-				(*b_p) -> applyTranspose (*nz_p, *z_p);
-
-			(*b_p) -> applyTranspose (y, *z_p);
+			typename ScratchVector<std::vector<DenseVector<Field> > >::Guard z(_zl);
+			_BlackboxL[0]->applyTranspose((*z)[0], x);
+			for (size_t i = 1; i < k-1; ++i)
+				_BlackboxL[i]->applyTranspose((*z)[i], (*z)[i-1]);
+			_BlackboxL[k-1]->applyTranspose(y, (*z)[k-2]);
 
 			return y;
 		}
@@ -391,11 +381,20 @@ namespace LinBox
 
 	protected:
 
+		// intermediate vectors of a product, z[i] of the size of the output of A_{i+1}
+		static std::vector<DenseVector<Field> > intermediates(const std::vector<const Blackbox*>& L)
+		{
+			std::vector<DenseVector<Field> > z;
+			for (size_t i = 1; i < L.size(); ++i)
+				z.emplace_back(L[i]->field(), L[i]->rowdim());
+			return z;
+		}
+
 		// Pointers to A and B matrices
 		std::vector<const Blackbox*> _BlackboxL;
 
-		// local intermediate vector
-		mutable std::vector<DenseVector<Field> > _zl;
+		// local intermediate vectors
+		ScratchVector<std::vector<DenseVector<Field> > > _zl;
 	};
 
 	//@}
@@ -466,14 +465,8 @@ namespace LinBox
 		 */
 		ComposeOwner (const Blackbox1 &A, const Blackbox2 &B) :
 			_A_data(A), _B_data(B)
-			,_z(A.field())
-		{
-			// Rich Seagraves - "It seems VectorWrapper somehow
-			// became depricated.  Makes the assumption that
-			// this vector type supports resize"
-			// VectorWrapper::ensureDim (_z, _A_data.coldim ());
-			_z.resize(_A_data.coldim());
-		}
+			,_z(BlasVector<Field>(A.field(), A.coldim()))
+		{}
 
 		/** Constructor of C := (*A_data)*(*B_data).
 		 * This constructor creates a matrix that is a product of two black box
@@ -481,14 +474,11 @@ namespace LinBox
 		 */
 		ComposeOwner (const Blackbox1 *A_data, const Blackbox2 *B_data) :
 			_A_data(*A_data), _B_data(*B_data)
-			,_z(A_data->field())
+			,_z(BlasVector<Field>(A_data->field(), A_data->coldim()))
 		{
 			linbox_check (A_data != (Blackbox1 *) 0);
 			linbox_check (B_data != (Blackbox2 *) 0);
 			linbox_check (A_data->coldim () == B_data->rowdim ());
-
-			// VectorWrapper::ensureDim (_z, _A_data.coldim ());
-			_z.resize(_A_data.coldim());
 		}
 
 		/** Copy constructor.
@@ -498,10 +488,8 @@ namespace LinBox
 		 */
 		ComposeOwner (const ComposeOwner<Blackbox1, Blackbox2>& Mat) :
 			_A_data ( Mat.getLeftData()), _B_data ( Mat.getRightData())
-			,_z(Mat.field())
-		{
-			_z.resize(_A_data.coldim());
-		}
+			,_z(Mat._z)
+		{}
 
 
 		/// Destructor
@@ -530,7 +518,15 @@ namespace LinBox
 		template <class OutVector, class InVector>
 		inline OutVector& apply (OutVector& y, const InVector& x) const
 		{
-			return _A_data.apply (y, _B_data.apply (_z, x));
+			typename ScratchVector<BlasVector<Field> >::Guard z(_z);
+			return _A_data.apply (y, _B_data.apply (*z, x));
+		}
+
+		/// y = A (B x) with the caller's vector z of size <code>A.coldim()</code>.
+		template <class OutVector, class InVector, class Vector>
+		inline OutVector& apply (OutVector& y, const InVector& x, Vector& z) const
+		{
+			return _A_data.apply (y, _B_data.apply (z, x));
 		}
 
 		/** row vector * matrix product \f$y= (A \times B)^T \cdot x\f$.
@@ -542,7 +538,15 @@ namespace LinBox
 		template <class OutVector, class InVector>
 		inline OutVector& applyTranspose (OutVector& y, const InVector& x) const
 		{
-			return _B_data.applyTranspose (y, _A_data.applyTranspose (_z, x));
+			typename ScratchVector<BlasVector<Field> >::Guard z(_z);
+			return _B_data.applyTranspose (y, _A_data.applyTranspose (*z, x));
+		}
+
+		/// y = (A B)^T x with the caller's vector z of size <code>A.coldim()</code>.
+		template <class OutVector, class InVector, class Vector>
+		inline OutVector& applyTranspose (OutVector& y, const InVector& x, Vector& z) const
+		{
+			return _B_data.applyTranspose (y, _A_data.applyTranspose (z, x));
 		}
 
 		template<typename _Tp1, typename _Tp2 = _Tp1>
@@ -564,7 +568,7 @@ namespace LinBox
 		ComposeOwner (const Compose<_BBt1, _BBt2> &Mat, const Field& F) :
 			_A_data(*(Mat.getLeftPtr()), F),
 			_B_data(*(Mat.getRightPtr()), F),
-			_z(F,_A_data.coldim())
+			_z(BlasVector<Field>(F, _A_data.coldim()))
 		{
 			typename Compose<_BBt1, _BBt2>::template rebind<Field>()(*this,Mat);
 		}
@@ -573,7 +577,7 @@ namespace LinBox
 		ComposeOwner (const ComposeOwner<_BBt1, _BBt2> &Mat, const Field& F) :
 			_A_data(Mat.getLeftData(), F),
 			_B_data(Mat.getRightData(), F) ,
-			_z(F,_A_data.coldim())
+			_z(BlasVector<Field>(F, _A_data.coldim()))
 		{
 			typename ComposeOwner<_BBt1, _BBt2>::template rebind<Field>()(*this,Mat);
 		}
@@ -620,7 +624,18 @@ namespace LinBox
 		Blackbox2 _B_data;
 
 		// local intermediate vector
-		mutable BlasVector<Field> _z;
+		ScratchVector<BlasVector<Field> > _z;
+	};
+
+	// reentrant when the factors are: the intermediate vector is a ScratchVector
+	template <class Blackbox1, class Blackbox2>
+	struct is_reentrant<Compose<Blackbox1, Blackbox2> > {
+		static const bool value = is_reentrant<Blackbox1>::value && is_reentrant<Blackbox2>::value;
+	};
+
+	template <class Blackbox1, class Blackbox2>
+	struct is_reentrant<ComposeOwner<Blackbox1, Blackbox2> > {
+		static const bool value = is_reentrant<Blackbox1>::value && is_reentrant<Blackbox2>::value;
 	};
 
 } // LinBox
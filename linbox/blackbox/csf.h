@@ -29,11 +29,16 @@
 #define __LINBOX_CSF_H
 
 #include "linbox/integer.h"
+#include "linbox/linbox-tags.h"
 //#include "linbox/vector/vector-traits.h"
 #include "linbox/util/debug.h"
 #include "linbox/util/matrix-stream.h"
 #include "linbox/ring/modular.h"
 #include "linbox/blackbox/blackbox-interface.h"
+#include "linbox/blackbox/blockbb.h"
+#include "linbox/algorithms/triangular-solve-levels.h"
+
+#include "fflas-ffpack/fflas/fflas.h"
 
 // For STL pair in IndexIterator
 #include <utility>
@@ -42,6 +47,10 @@
 #include <cstdlib> // For randomness in randomized quicksort
 #include <ctime>
 
+#if defined(__LINBOX_USE_OPENMP)
+#include <omp.h>
+#endif
+
 namespace LinBox
 {
 	/** \brief Space efficient representation of sparse matrices.
@@ -202,13 +211,122 @@ namespace LinBox
 			for(Index i = _ptrs[0]; (size_t)i < _ptrs.size()-1; ++i) {
 				for(Index j = _ptrs[i]; j < _ptrs[i+1]; ++j) {
 				// process row i:  yj += xi Aij , yindsj += xi valsj
-					field().axpyin(y[i], x[_inds[j]], _vals[j]);
+					field().axpyin(y[_inds[j]], x[i], _vals[j]);
 				}
 			}
 
 			return y;
 		}
 
+		/** Y = A X, for a dense block X of coldim() rows.
+		 *
+		 * Row i of Y is the combination of the rows of X given by row i of
+		 * A, as vector axpys of length X.coldim(). The rows of Y are shared
+		 * among the threads.
+		 */
+		template<class Matrix1, class Matrix2>
+		Matrix1 & applyLeft(Matrix1 & Y, const Matrix2 & X) const {
+			linbox_check(Y.rowdim() == rowdim() && X.rowdim() == coldim() && Y.coldim() == X.coldim());
+			size_t k = X.coldim(), nr = _ptrs.size() - 1;
+			size_t ldy = Y.getStride(), ldx = X.getStride();
+			typename Field::Element_ptr Yp = Y.getPointer();
+			typename Field::ConstElement_ptr Xp = X.getPointer();
+#ifdef __LINBOX_USE_OPENMP
+#pragma omp parallel for schedule(dynamic, 64) if (nnz()*k > 65536)
+#endif
+			for (long i = 0; i < (long) rowdim(); ++i) {
+				typename Field::Element_ptr y = Yp + (size_t)i*ldy;
+				FFLAS::fzero(field(), k, y, 1);
+				if ((size_t)i < nr)
+					for (Index j = _ptrs[(size_t)i]; j < _ptrs[(size_t)i+1]; ++j)
+						FFLAS::faxpy(field(), k, _vals[j], Xp + _inds[j]*ldx, 1, y, 1);
+			}
+			return Y;
+		}
+
+		/** Y = X A, for a dense block X of rowdim() columns.
+		 *
+		 * Each row of Y is applyTranspose of a row of X, the rows of Y are
+		 * shared among the threads.
+		 */
+		template<class Matrix1, class Matrix2>
+		Matrix1 & applyRight(Matrix1 & Y, const Matrix2 & X) const {
+			linbox_check(Y.coldim() == coldim() && X.coldim() == rowdim() && Y.rowdim() == X.rowdim());
+			size_t k = X.rowdim(), nr = _ptrs.size() - 1;
+			size_t ldy = Y.getStride(), ldx = X.getStride();
+			typename Field::Element_ptr Yp = Y.getPointer();
+			typename Field::ConstElement_ptr Xp = X.getPointer();
+#ifdef __LINBOX_USE_OPENMP
+#pragma omp parallel for schedule(static) if (nnz()*k > 65536)
+#endif
+			for (long r = 0; r < (long) k; ++r) {
+				typename Field::Element_ptr y = Yp + (size_t)r*ldy;
+				typename Field::ConstElement_ptr x = Xp + (size_t)r*ldx;
+				FFLAS::fzero(field(), coldim(), y, 1);
+				for (size_t i = 0; i < nr; ++i)
+					for (Index j = _ptrs[i]; j < _ptrs[i+1]; ++j)
+						field().axpyin(y[_inds[j]], x[i], _vals[j]);
+			}
+			return Y;
+		}
+
+		/** Y: A Y = X, for a triangular A and a dense block X.
+		 *
+		 * Level scheduled: row i is at level 1 + the highest level of the
+		 * rows it depends on, the rows of a level are solved in parallel,
+		 * each by vector axpys of length X.coldim(). Entries outside the
+		 * triangle \p uplo are ignored, as is the diagonal for a Unit \p diag.
+		 * Throws a LinboxError when a diagonal entry is zero or missing.
+		 */
+		template<class Matrix1, class Matrix2>
+		Matrix1 & triangularSolve(Matrix1 & Y, const Matrix2 & X,
+					  Tag::Shape uplo = Tag::Shape::Lower, Tag::Diag diag = Tag::Diag::NonUnit) const {
+			linbox_check(rowdim() == coldim() && X.rowdim() == rowdim() && Y.rowdim() == rowdim() && Y.coldim() == X.coldim());
+			size_t n = rowdim(), k = X.coldim(), nr = _ptrs.size() - 1;
+			size_t ldy = Y.getStride(), ldx = X.getStride();
+			bool lower = (uplo == Tag::Shape::Lower);
+
+			std::vector<size_t> start, order;
+			sortRowsByLevel(start, order, n, lower, _ptrs, _inds);
+
+			typename Field::Element_ptr Yp = Y.getPointer();
+			typename Field::ConstElement_ptr Xp = X.getPointer();
+			bool singular = false;
+			for (size_t l = 0; l + 1 < start.size(); ++l) {
+#ifdef __LINBOX_USE_OPENMP
+#pragma omp parallel for schedule(dynamic, 16) if ((start[l+1] - start[l])*k > 4096)
+#endif
+				for (long t = (long) start[l]; t < (long) start[l+1]; ++t) {
+					size_t i = order[(size_t)t];
+					typename Field::Element_ptr y = Yp + i*ldy;
+					FFLAS::fassign(field(), k, Xp + i*ldx, 1, y, 1);
+					Element a, d;
+					field().init(a); field().init(d);
+					field().assign(d, field().zero);
+					if (i < nr)
+						for (Index j = _ptrs[i]; j < _ptrs[i+1]; ++j) {
+							if (_inds[j] == i)
+								field().assign(d, _vals[j]);
+							else if (lower ? _inds[j] < i : _inds[j] > i)
+								FFLAS::faxpy(field(), k, field().neg(a, _vals[j]), Yp + _inds[j]*ldy, 1, y, 1);
+						}
+					if (diag == Tag::Diag::Unit)
+						continue;
+					if (field().isZero(d)) {
+#ifdef __LINBOX_USE_OPENMP
+#pragma omp atomic write
+#endif
+						singular = true;
+						continue;
+					}
+					FFLAS::fscalin(field(), k, field().invin(d), y, 1);
+				}
+				if (singular)
+					throw LinboxError("CSF::triangularSolve: zero diagonal entry");
+			}
+			return Y;
+		}
+
 		Element & getEntry(Element& x, Index i, Index j) {
 			size_t k;
 			for (k = _ptrs[i]; k < _ptrs[i+1]; ++k)
@@ -219,7 +337,8 @@ namespace LinBox
 
 		Element & setEntry(Index i, Index j, Element& x) {
 			// data must exist.
-			data.push_back(i, j, x);
+			_data.push_back(Triple(IndexPair(i, j), x));
+			return x;
 		}
 
 		void finalize() { // from data to csf
@@ -458,6 +577,11 @@ namespace LinBox
 
 	}; //CSF
 
+	template<class Field>
+	struct is_blockbb<CSF<Field> > {
+		static const bool value = true;
+	};
+
 }//End of LinBox
 
 //#include "csf.inl"
@@ -753,6 +753,11 @@ BlasMatrix<Field>& nullspaceBasisLeft(BlasMatrix<Field>& N) const
 	template<class Field, class Trait> struct GetEntryCategory<Diagonal<Field, Trait> >
 	{ typedef SolutionTags::Local Tag; };
 
+	template <class Field>
+	struct is_reentrant<Diagonal<Field, VectorCategories::DenseVectorTag> > {
+		static const bool value = true;
+	};
+
 } // namespace LinBox
 
 #endif // __LINBOX_diagonal_H
@@ -0,0 +1,425 @@
+/* linbox/blackbox/fft-toeplitz.h
+ * Copyright (C) LinBox
+ *
+ * ========LICENCE========
+ * This file is part of the library LinBox.
+ *
+ * LinBox is free software: you can redistribute it and/or modify
+ * it under the terms of the  GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.	 See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ * ========LICENCE========
+ */
+
+/*! @file blackbox/fft-toeplitz.h
+ * @ingroup blackbox
+ * @brief Toeplitz and Hankel blackboxes applied with LinBox's own FFT.
+ */
+
+#ifndef __LINBOX_fft_toeplitz_H
+#define __LINBOX_fft_toeplitz_H
+
+#include <vector>
+#include <memory>
+#include <algorithm>
+
+#include "linbox/linbox-config.h"
+#include "linbox/util/debug.h"
+#include "linbox/util/error.h"
+#include "linbox/integer.h"
+#include "givaro/modular.h"
+#include "linbox/blackbox/blackbox-interface.h"
+#include "linbox/blackbox/blockbb.h"
+#include "linbox/matrix/dense-matrix.h"
+#include "linbox/vector/scratch-vector.h"
+#include "linbox/randiter/random-fftprime.h"
+#include "linbox/algorithms/polynomial-matrix/fft.h"
+
+#if defined(__LINBOX_USE_OPENMP)
+#include <omp.h>
+#endif
+
+namespace LinBox
+{
+
+/**
+ * Blackbox of a (block) Toeplitz matrix, applied by FFT.
+ *
+ * The matrix has \f$m \times n\f$ blocks of size \f$b \times b\f$ (\f$b = 1\f$
+ * for a scalar matrix), its block \f$(i,j)\f$ is \f$T_{n-1+i-j}\f$: \f$T_0\f$
+ * is the top right block and \f$T_{m+n-2}\f$ the bottom left one, as for
+ * Toeplitz. An apply is the middle product of the input by the symbol
+ * \f$\sum T_k z^k\f$, computed with FFT over Givaro::Modular<double>: modulo
+ * the characteristic itself if it has a root of unity of the needed order,
+ * otherwise modulo a few FFT primes whose product bounds the integer result,
+ * which is then reduced by CRT.
+ *
+ * The transforms of the symbol (and of the symbol of the transpose) are
+ * computed once, by the constructor: an apply costs \f$2b\f$ FFT and
+ * \f$b^2\f$ pointwise products per prime. Blocks of vectors (applyLeft,
+ * applyRight) are shared among the OpenMP threads, one column per thread.
+ *
+ * The field must be a wordsize Givaro::Modular.
+ \ingroup blackbox
+ */
+template <class _Field>
+class FFTToeplitz : public BlackboxInterface {
+public:
+	typedef _Field                                  Field;
+	typedef typename Field::Element                 Element;
+	typedef Givaro::Modular<double>                 ModField;
+	typedef typename Simd<double>::aligned_vector   Buffer;
+
+	/** Scalar Toeplitz matrix.
+	 * @param F field
+	 * @param t the \f$m+n-1\f$ entries, \p t[0] top right, \p t[m+n-2] bottom left
+	 * @param m row dimension
+	 * @param n column dimension, \p m if 0
+	 */
+	template <class Vect>
+	FFTToeplitz(const Field &F, const Vect &t, size_t m, size_t n = 0) :
+		_field(&F)
+	{
+		std::vector<Element> sym(t.size());
+		for (size_t k = 0; k < t.size(); ++k)
+			F.assign(sym[k], t[k]);
+		init(sym, m, n ? n : m, 1, false);
+	}
+
+	/// Square scalar Toeplitz matrix from its \f$2n-1\f$ entries.
+	FFTToeplitz(const Field &F, const std::vector<Element> &t) :
+		_field(&F)
+	{
+		linbox_check(t.size() & 1);
+		init(t, (t.size()+1)/2, (t.size()+1)/2, 1, false);
+	}
+
+	/** Block Toeplitz matrix.
+	 * @param F field
+	 * @param T the \f$m+n-1\f$ square blocks
+	 * @param m number of block rows
+	 * @param n number of block columns, \p m if 0
+	 */
+	FFTToeplitz(const Field &F, const std::vector<BlasMatrix<Field> > &T, size_t m, size_t n = 0) :
+		_field(&F)
+	{
+		init(flatten(T), m, n ? n : m, T.front().rowdim(), false);
+	}
+
+	size_t rowdim() const { return _m * _b; }
+	size_t coldim() const { return _n * _b; }
+	size_t blockdim() const { return _b; }
+	const Field& field() const { return *_field; }
+
+	/// Number of FFT primes, 1 if the characteristic is one.
+	size_t nprimes() const { return _primes.size(); }
+
+	/// y = A x.
+	template <class OutVector, class InVector>
+	OutVector& apply(OutVector &y, const InVector &x) const
+	{
+		linbox_check(x.size() == coldim() && y.size() == rowdim());
+		typename ScratchVector<std::vector<Buffer> >::Guard w(_work);
+		mul(*w, false, [&](size_t j) -> const Element& { return x[j]; },
+		    [&](size_t i, const Element &e) { field().assign(y[i], e); });
+		return y;
+	}
+
+	/// y = A^T x.
+	template <class OutVector, class InVector>
+	OutVector& applyTranspose(OutVector &y, const InVector &x) const
+	{
+		linbox_check(x.size() == rowdim() && y.size() == coldim());
+		typename ScratchVector<std::vector<Buffer> >::Guard w(_work);
+		mul(*w, true, [&](size_t j) -> const Element& { return x[j]; },
+		    [&](size_t i, const Element &e) { field().assign(y[i], e); });
+		return y;
+	}
+
+	/// Y = A X, one column of X after the other.
+	template <class Matrix>
+	Matrix& applyLeft(Matrix &Y, const Matrix &X) const
+	{
+		linbox_check(X.rowdim() == coldim() && Y.rowdim() == rowdim());
+		linbox_check(X.coldim() == Y.coldim());
+		columns(Y.getPointer(), Y.getStride(), 1, X.getPointer(), X.getStride(), 1, X.coldim(), false);
+		return Y;
+	}
+
+	/// Y = X A, that is each row of Y is A^T times the row of X.
+	template <class Matrix>
+	Matrix& applyRight(Matrix &Y, const Matrix &X) const
+	{
+		linbox_check(X.coldim() == rowdim() && Y.coldim() == coldim());
+		linbox_check(X.rowdim() == Y.rowdim());
+		columns(Y.getPointer(), 1, Y.getStride(), X.getPointer(), 1, X.getStride(), X.rowdim(), true);
+		return Y;
+	}
+
+protected:
+
+	// transforms of the symbol modulo one FFT prime
+	struct Prime {
+		ModField          F;
+		FFT<ModField>   fft;
+		FFT<ModField>  ifft;
+		Buffer          sym;   // b^2 transforms, scaled by 1/N
+		Buffer         tsym;   // the same for the transpose (Toeplitz only)
+
+		Prime(double q, size_t lpts) :
+			F(q), fft(F, lpts), ifft(F, lpts, fft.invroot())
+		{}
+	};
+
+	const Field                              *_field;
+	size_t                                    _m, _n, _b;
+	size_t                                    _lpts, _pts;
+	bool                                      _hankel;
+	std::vector<std::shared_ptr<const Prime> > _primes;
+	std::vector<std::vector<double> >          _inv;    // _inv[i][j] = 1/q_j mod q_i
+	std::vector<Element>                       _radix;  // q_0...q_{i-1} mod p
+	ScratchVector<std::vector<Buffer> >        _work;   // 2 b N per prime
+
+	FFTToeplitz(const Field &F) :
+		_field(&F)
+	{}
+
+	static std::vector<Element> flatten(const std::vector<BlasMatrix<Field> > &T)
+	{
+		size_t b = T.front().rowdim();
+		std::vector<Element> sym(T.size()*b*b);
+		for (size_t k = 0; k < T.size(); ++k) {
+			linbox_check(T[k].rowdim() == b && T[k].coldim() == b);
+			for (size_t r = 0; r < b; ++r)
+				for (size_t c = 0; c < b; ++c)
+					T[k].field().assign(sym[(k*b+r)*b+c], T[k].getEntry(r, c));
+		}
+		return sym;
+	}
+
+	// sym holds the m+n-1 blocks, row major, one after the other
+	void init(const std::vector<Element> &sym, size_t m, size_t n, size_t b, bool hankel)
+	{
+		_m = m; _n = n; _b = b; _hankel = hankel;
+		size_t L = m + n - 1;
+		linbox_check(sym.size() == L*b*b);
+
+		// at least 16 points, so that every transform stays Simd aligned
+		for (_lpts = 4, _pts = 16; _pts < L; _pts <<= 1) ++_lpts;
+
+		// primes: the characteristic if it has 2^lpts-th roots of unity,
+		// otherwise FFT primes bounding the integer middle product
+		integer p;
+		field().characteristic(p);
+		integer qmax((uint64_t) ModField::maxCardinality());
+		std::vector<integer> primes;
+		if (p < qmax && ((p-1) % integer((uint64_t)_pts)) == 0)
+			primes.push_back(p);
+		else {
+			integer bound = (p-1)*(p-1)*integer((uint64_t)(std::max(m, n)*b)) + 1;
+			if (! RandomFFTPrime::generatePrimes(primes, qmax, bound, _lpts))
+				throw LinboxError("FFTToeplitz: not enough FFT primes for this dimension");
+		}
+
+		size_t np = primes.size();
+		_primes.clear();
+		for (size_t l = 0; l < np; ++l) {
+			std::shared_ptr<Prime> P(new Prime((double) primes[l], _lpts));
+			symbol(*P, sym, false, P->sym);
+			if (! hankel)
+				symbol(*P, sym, true, P->tsym);
+			_primes.push_back(P);
+		}
+
+		_inv.assign(np, std::vector<double>(np));
+		_radix.assign(np, field().one);
+		for (size_t i = 0; i < np; ++i) {
+			const ModField &Fi = _primes[i]->F;
+			for (size_t j = 0; j < i; ++j) {
+				Fi.init(_inv[i][j], (double) primes[j]);
+				Fi.invin(_inv[i][j]);
+			}
+			if (i > 0) {
+				Element q;
+				field().init(q, primes[i-1]);
+				field().mul(_radix[i], _radix[i-1], q);
+			}
+		}
+
+		_work = ScratchVector<std::vector<Buffer> >(std::vector<Buffer>(2*np, Buffer(_b*_pts)));
+	}
+
+	// transforms of the b^2 entries of the symbol, of its reversed
+	// transposed blocks for the transpose of a Toeplitz matrix
+	void symbol(const Prime &P, const std::vector<Element> &sym, bool transpose, Buffer &S) const
+	{
+		size_t L = _m + _n - 1, b = _b, N = _pts;
+		S.assign(b*b*N, 0.);
+		double invN;
+		P.F.init(invN, (double) N);
+		P.F.invin(invN);
+		for (size_t r = 0; r < b; ++r)
+			for (size_t c = 0; c < b; ++c) {
+				double *s = S.data() + (r*b+c)*N;
+				for (size_t k = 0; k < L; ++k) {
+					const Element &e = transpose ? sym[((L-1-k)*b+c)*b+r] : sym[(k*b+r)*b+c];
+					P.F.init(s[k], (uint64_t) e);
+				}
+				P.fft.FFT_direct(s);
+				for (size_t k = 0; k < N; ++k)
+					P.F.mulin(s[k], invN);
+			}
+	}
+
+	/* y = op(A) x, x read by in(j), y written by out(i, e).
+	 * The input is the vector polynomial x(z) = sum x_j z^j of degree
+	 * inL-1 (reversed for a Hankel matrix), the output is the coefficients
+	 * inL-1 ... inL+outL-2 of the product by the symbol: the cyclic product
+	 * of length N >= m+n-1 does not wrap onto them.
+	 */
+	template <class In, class Out>
+	void mul(std::vector<Buffer> &w, bool transpose, const In &in, const Out &out) const
+	{
+		size_t b = _b, N = _pts, np = _primes.size();
+		size_t inL = transpose ? _m : _n, outL = transpose ? _n : _m;
+
+		for (size_t l = 0; l < np; ++l) {
+			const Prime &P = *_primes[l];
+			double *X = w[2*l].data(), *Y = w[2*l+1].data();
+
+			for (size_t c = 0; c < b; ++c) {
+				double *xc = X + c*N;
+				for (size_t k = 0; k < inL; ++k)
+					P.F.init(xc[k], (uint64_t) in((_hankel ? inL-1-k : k)*b + c));
+				std::fill(xc + inL, xc + N, 0.);
+				P.fft.FFT_direct(xc);
+			}
+
+			// pointwise product by the symbol, a Hankel matrix is symmetric
+			// up to the transposition of its blocks
+			const double *S = (transpose && ! _hankel) ? P.tsym.data() : P.sym.data();
+			bool swap = transpose && _hankel;
+			for (size_t r = 0; r < b; ++r) {
+				double *yr = Y + r*N;
+				std::fill(yr, yr + N, 0.);
+				for (size_t c = 0; c < b; ++c) {
+					const double *s = S + (swap ? c*b+r : r*b+c)*N, *xc = X + c*N;
+					for (size_t k = 0; k < N; ++k)
+						P.F.axpyin(yr[k], s[k], xc[k]);
+				}
+				P.ifft.FFT_inverse(yr);
+			}
+		}
+
+		// mixed radix reconstruction, modulo the characteristic
+		double t, u;
+		Element e, d;
+		field().init(e); field().init(d);
+		for (size_t r = 0; r < b; ++r)
+			for (size_t i = 0; i < outL; ++i) {
+				size_t k = r*N + inL-1 + i;
+				field().init(e, (uint64_t) w[1][k]);
+				for (size_t l = 1; l < np; ++l) {
+					const ModField &Fl = _primes[l]->F;
+					double &v = w[2*l+1][k];
+					for (size_t j = 0; j < l; ++j) {
+						Fl.init(u, w[2*j+1][k]);
+						Fl.sub(t, v, u);
+						Fl.mul(v, t, _inv[l][j]);
+					}
+					field().init(d, (uint64_t) v);
+					field().axpyin(e, _radix[l], d);
+				}
+				out(i*b + r, e);
+			}
+	}
+
+	// k vectors: x_c = xp[c*xs + j*xi], y_c = yp[c*ys + i*yi]
+	void columns(Element *yp, size_t yi, size_t ys, const Element *xp, size_t xi, size_t xs,
+		     size_t k, bool transpose) const
+	{
+#ifdef __LINBOX_USE_OPENMP
+#pragma omp parallel if (k > 1 && _pts * _b > 4096)
+#endif
+		{
+			std::vector<Buffer> w(2*_primes.size(), Buffer(_b*_pts));
+#ifdef __LINBOX_USE_OPENMP
+#pragma omp for schedule(static)
+#endif
+			for (long c = 0; c < (long) k; ++c) {
+				const Element *x = xp + (size_t)c*xs;
+				Element *y = yp + (size_t)c*ys;
+				mul(w, transpose, [&](size_t j) -> const Element& { return x[j*xi]; },
+				    [&](size_t i, const Element &e) { field().assign(y[i*yi], e); });
+			}
+		}
+	}
+
+}; // class FFTToeplitz
+
+/**
+ * Blackbox of a (block) Hankel matrix, applied by FFT.
+ *
+ * The matrix has \f$m \times n\f$ blocks, its block \f$(i,j)\f$ is
+ * \f$H_{i+j}\f$. It is the Toeplitz matrix of the same symbol times the
+ * reversal of the columns, see FFTToeplitz. Its transpose is the Hankel
+ * matrix of the transposed blocks, so a single transform of the symbol
+ * serves both apply and applyTranspose.
+ \ingroup blackbox
+ */
+template <class _Field>
+class FFTHankel : public FFTToeplitz<_Field> {
+public:
+	typedef _Field                   Field;
+	typedef typename Field::Element  Element;
+
+	/// Scalar Hankel matrix, \p h[0] top left, \p h[m+n-2] bottom right.
+	template <class Vect>
+	FFTHankel(const Field &F, const Vect &h, size_t m, size_t n = 0) :
+		FFTToeplitz<Field>(F)
+	{
+		std::vector<Element> sym(h.size());
+		for (size_t k = 0; k < h.size(); ++k)
+			F.assign(sym[k], h[k]);
+		this->init(sym, m, n ? n : m, 1, true);
+	}
+
+	/// Block Hankel matrix of m x n blocks H_0 ... H_{m+n-2}.
+	FFTHankel(const Field &F, const std::vector<BlasMatrix<Field> > &H, size_t m, size_t n = 0) :
+		FFTToeplitz<Field>(F)
+	{
+		this->init(this->flatten(H), m, n ? n : m, H.front().rowdim(), true);
+	}
+
+}; // class FFTHankel
+
+template <class Field>
+struct is_blockbb<FFTToeplitz<Field> > {
+	static const bool value = true;
+};
+
+template <class Field>
+struct is_blockbb<FFTHankel<Field> > {
+	static const bool value = true;
+};
+
+} // LinBox
+
+#endif // __LINBOX_fft_toeplitz_H
+
+// Local Variables:
+// mode: C++
+// tab-width: 4
+// indent-tabs-mode: nil
+// c-basic-offset: 4
+// End:
+// vim:sts=4:sw=4:ts=4:et:sr:cino=>s,f0,{0,g0,(0,\:0,t0,+0,=s
@@ -0,0 +1,313 @@
+/* linbox/blackbox/implicit-random.h
+ * Copyright (C) LinBox
+ *
+ * ========LICENCE========
+ * This file is part of the library LinBox.
+ *
+ * LinBox is free software: you can redistribute it and/or modify
+ * it under the terms of the  GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.	 See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ * ========LICENCE========
+ */
+
+/*! @file blackbox/implicit-random.h
+ * @ingroup blackbox
+ * @brief Random preconditioners whose entries are recomputed at each apply.
+ */
+
+#ifndef __LINBOX_implicit_random_H
+#define __LINBOX_implicit_random_H
+
+#include <vector>
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+#include <unordered_set>
+#include <mutex>
+
+#include "linbox/linbox-config.h"
+#include "linbox/util/debug.h"
+#include "linbox/integer.h"
+#include "linbox/matrix/matrix-category.h"
+#include "linbox/blackbox/blackbox-interface.h"
+#include "linbox/randiter/counter-based.h"
+
+#if defined(__LINBOX_USE_OPENMP)
+#include <omp.h>
+#endif
+
+namespace LinBox
+{
+
+	/** Stateless random entries.
+	 *
+	 * The entry of index \f$(i,j)\f$ of the matrix of key \c seed is a
+	 * function of \f$(seed,i,j)\f$ only: the Philox block of counter
+	 * \f$(i,j)\f$ of the stream of \c seed (see CounterRandIter), so the
+	 * matrix needs no storage, its rows can be produced in any order by any
+	 * thread, and the same seed always gives the same matrix.
+	 */
+	struct RandomEntry {
+		static Philox4x32::Block block(uint64_t seed, uint64_t i, uint64_t j)
+		{
+			return Philox4x32::block(seed, i, j);
+		}
+
+		/// e: the field element of the random word h, nonzero if asked.
+		template <class Field>
+		static typename Field::Element& element(const Field &F, typename Field::Element &e, uint64_t h, bool nonzero)
+		{
+			F.init(e, h);
+			for (uint64_t k = 1; nonzero && F.isZero(e); ++k)
+				if (k <= 64) F.init(e, Philox4x32::block(h, k).word(0));
+				else F.assign(e, F.one);
+			return e;
+		}
+	};
+
+	/** Lambda-sparse matrix of (Mulders 2000) with implicit entries.
+	 *
+	 * Row \f$i\f$ has about \f$n\,p_i\f$ random nonzero entries with
+	 * \f$p_i = \min(1-1/q, \lambda \log_2 m / (m-i))\f$, as in
+	 * LambdaSparseMatrix. The entries are drawn from RandomEntry at each
+	 * apply instead of being stored: a preconditioner for huge systems takes
+	 * no memory, and is reproduced exactly from its seed. Sparse rows draw
+	 * their column indices, again on a collision so that they are distinct;
+	 * rows of density 1/4 or more test each column.
+	 *
+	 * apply is parallel over the rows, applyTranspose over the rows too, with
+	 * a partial result per thread. The partial results are allocated at the
+	 * first parallel applyTranspose and kept by the matrix; a call made while
+	 * another thread uses them runs sequentially.
+	 \ingroup blackbox
+	 */
+	template <class _Field>
+	class ImplicitLambdaSparse : public BlackboxInterface {
+	public:
+		typedef _Field                        Field;
+		typedef typename Field::Element       Element;
+		typedef MatrixCategories::BlackboxTag MatrixCategory;
+
+		ImplicitLambdaSparse(const Field &F, size_t m, size_t n, uint64_t seed, double LAMBDA = 3.) :
+			_field(&F), _m(m), _n(n), _seed(seed)
+		{
+			integer card;
+			F.cardinality(card);
+			_init_p = (card > 0) ? 1.0 - 1.0 / (double) card : 1.0;
+			_log_m = LAMBDA * log((double) m) / M_LN2;
+		}
+
+		// the copy does not share the partial results
+		ImplicitLambdaSparse(const ImplicitLambdaSparse &A) :
+			_field(A._field), _m(A._m), _n(A._n), _seed(A._seed), _init_p(A._init_p), _log_m(A._log_m)
+		{}
+
+		template <class OutVector, class InVector>
+		OutVector& apply(OutVector &y, const InVector &x) const
+		{
+			linbox_check(x.size() >= _n && y.size() >= _m);
+#ifdef __LINBOX_USE_OPENMP
+#pragma omp parallel for schedule(dynamic, 64) if (_m > 1024)
+#endif
+			for (long i = 0; i < (long) _m; ++i) {
+				Element &yi = y[(size_t)i];
+				field().assign(yi, field().zero);
+				row((size_t)i, [&](size_t j, const Element &a) { field().axpyin(yi, a, x[j]); });
+			}
+			return y;
+		}
+
+		template <class OutVector, class InVector>
+		OutVector& applyTranspose(OutVector &y, const InVector &x) const
+		{
+			linbox_check(x.size() >= _m && y.size() >= _n);
+			for (size_t j = 0; j < _n; ++j)
+				field().assign(y[j], field().zero);
+#ifdef __LINBOX_USE_OPENMP
+			if (_m > 1024 && omp_get_max_threads() > 1) {
+				std::unique_lock<std::mutex> lock(_partMutex, std::try_to_lock);
+				if (lock.owns_lock()) {
+					if (_part.size() < (size_t) omp_get_max_threads())
+						_part.resize((size_t) omp_get_max_threads());
+#pragma omp parallel
+					{
+						size_t T = (size_t) omp_get_num_threads();
+						std::vector<Element> &z = _part[(size_t) omp_get_thread_num()];
+						z.assign(_n, field().zero);
+#pragma omp for schedule(dynamic, 64)
+						for (long i = 0; i < (long) _m; ++i)
+							row((size_t)i, [&](size_t j, const Element &a) { field().axpyin(z[j], a, x[(size_t)i]); });
+#pragma omp for schedule(static)
+						for (long j = 0; j < (long) _n; ++j)
+							for (size_t t = 0; t < T; ++t)
+								field().addin(y[(size_t)j], _part[t][(size_t)j]);
+					}
+					return y;
+				}
+			}
+#endif
+			for (size_t i = 0; i < _m; ++i)
+				row(i, [&](size_t j, const Element &a) { field().axpyin(y[j], a, x[i]); });
+			return y;
+		}
+
+		size_t rowdim() const { return _m; }
+		size_t coldim() const { return _n; }
+		const Field& field() const { return *_field; }
+		uint64_t seed() const { return _seed; }
+
+		/// f(j, a) for the entries a of row i, in the order of their draw.
+		template <class Function>
+		void row(size_t i, Function f) const
+		{
+			double p = std::min(_init_p, _log_m / double(_m - i));
+			Element a;
+			field().init(a);
+			if (p >= 1./4) {
+				// dense enough to test every column
+				double t = p * 18446744073709551616.0;
+				uint64_t threshold = (t >= 18446744073709551615.0) ? UINT64_MAX : (uint64_t) t;
+				for (size_t j = 0; j < _n; ++j) {
+					Philox4x32::Block b = RandomEntry::block(_seed, i, j);
+					if (b.word(0) < threshold || threshold == UINT64_MAX)
+						f(j, RandomEntry::element(field(), a, b.word(1), true));
+				}
+				return;
+			}
+			// floor(n p) entries, one more with the probability of the fraction
+			double np = double(_n) * p;
+			size_t k = (size_t) np;
+			if ((double) (RandomEntry::block(_seed, i, UINT64_MAX).word(0) >> 11) < (np - double(k)) * 9007199254740992.0)
+				++k;
+			// k distinct columns: a drawn column already in the row is drawn again,
+			// which ends soon since k < n/4
+			std::vector<size_t> seen;
+			std::unordered_set<size_t> seenSet;
+			bool small = (k <= 32);
+			if (small) seen.reserve(k); else seenSet.reserve(2*k);
+			for (uint64_t t = 0, c = 0; c < k; ++t) {
+				Philox4x32::Block b = RandomEntry::block(_seed, i, t);
+				size_t j = (size_t)(b.word(0) % _n);
+				if (small) {
+					if (std::find(seen.begin(), seen.end(), j) != seen.end()) continue;
+					seen.push_back(j);
+				}
+				else if (! seenSet.insert(j).second)
+					continue;
+				f(j, RandomEntry::element(field(), a, b.word(1), true));
+				++c;
+			}
+		}
+
+	protected:
+		const Field *_field;
+		size_t       _m, _n;
+		uint64_t     _seed;
+		double       _init_p, _log_m;
+
+		// partial results of the threads in applyTranspose
+		mutable std::vector<std::vector<Element> > _part;
+		mutable std::mutex _partMutex;
+	}; // class ImplicitLambdaSparse
+
+	/** Random dense matrix with implicit entries.
+	 *
+	 * The entry \f$(i,j)\f$ is drawn from RandomEntry at each apply: the
+	 * matrix takes no memory, and is reproduced exactly from its seed. Both
+	 * apply (by rows) and applyTranspose (by columns) are parallel without
+	 * any partial result.
+	 \ingroup blackbox
+	 */
+	template <class _Field>
+	class ImplicitRandomDense : public BlackboxInterface {
+	public:
+		typedef _Field                        Field;
+		typedef typename Field::Element       Element;
+		typedef MatrixCategories::BlackboxTag MatrixCategory;
+
+		ImplicitRandomDense(const Field &F, size_t m, size_t n, uint64_t seed) :
+			_field(&F), _m(m), _n(n), _seed(seed)
+		{}
+
+		template <class OutVector, class InVector>
+		OutVector& apply(OutVector &y, const InVector &x) const
+		{
+			linbox_check(x.size() >= _n && y.size() >= _m);
+#ifdef __LINBOX_USE_OPENMP
+#pragma omp parallel for schedule(static) if (_m*_n > 65536)
+#endif
+			for (long i = 0; i < (long) _m; ++i) {
+				Element a, &yi = y[(size_t)i];
+				field().init(a);
+				field().assign(yi, field().zero);
+				for (size_t j = 0; j < _n; ++j)
+					field().axpyin(yi, getEntry(a, (size_t)i, j), x[j]);
+			}
+			return y;
+		}
+
+		template <class OutVector, class InVector>
+		OutVector& applyTranspose(OutVector &y, const InVector &x) const
+		{
+			linbox_check(x.size() >= _m && y.size() >= _n);
+#ifdef __LINBOX_USE_OPENMP
+#pragma omp parallel for schedule(static) if (_m*_n > 65536)
+#endif
+			for (long j = 0; j < (long) _n; ++j) {
+				Element a, &yj = y[(size_t)j];
+				field().init(a);
+				field().assign(yj, field().zero);
+				for (size_t i = 0; i < _m; ++i)
+					field().axpyin(yj, getEntry(a, i, (size_t)j), x[i]);
+			}
+			return y;
+		}
+
+		/// a = entry (i,j).
+		Element& getEntry(Element &a, size_t i, size_t j) const
+		{
+			return RandomEntry::element(field(), a, RandomEntry::block(_seed, i, j).word(0), false);
+		}
+
+		size_t rowdim() const { return _m; }
+		size_t coldim() const { return _n; }
+		const Field& field() const { return *_field; }
+		uint64_t seed() const { return _seed; }
+
+	protected:
+		const Field *_field;
+		size_t       _m, _n;
+		uint64_t     _seed;
+	}; // class ImplicitRandomDense
+
+	template <class Field>
+	struct is_reentrant<ImplicitLambdaSparse<Field> > {
+		static const bool value = true;
+	};
+
+	template <class Field>
+	struct is_reentrant<ImplicitRandomDense<Field> > {
+		static const bool value = true;
+	};
+
+} // namespace LinBox
+
+#endif // __LINBOX_implicit_random_H
+
+// Local Variables:
+// mode: C++
+// tab-width: 4
+// indent-tabs-mode: nil
+// c-basic-offset: 4
+// End:
+// vim:sts=4:sw=4:ts=4:et:sr:cino=>s,f0,{0,g0,(0,\:0,t0,+0,=s
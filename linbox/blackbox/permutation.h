@@ -36,6 +36,10 @@
 #include "linbox/randiter/mersenne-twister.h"
 #include "linbox/blackbox/fibb.h"
 
+#if defined(__LINBOX_USE_OPENMP)
+#include <omp.h>
+#endif
+
 namespace LinBox
 {
 
@@ -186,45 +190,20 @@ namespace LinBox
 			return y;
 		}
 
-            // Permutes the rows of X
+            // Permutes the rows of X: row i of Y is row _indices[i] of X
 		Matrix& applyRight(Matrix& Y, const Matrix& X) const
 		{
-			Element x; field().init(x);
-			for (size_t i = 0; i < Y.rowdim(); ++i){
-				size_t k = _indices[i];
-				for (size_t j = 0; j < Y.coldim(); ++j)
-					Y.setEntry(i,j, X.getEntry(x, k, j));
-			}
-		/* desired form
-			for (size_t i = 0; i < rowdim(); ++i)
-			{
-				Matrix Yrow(Y, i, 0, 1, Y.coldim());
-				Matrix Xrow(X, _indices[i], 0, 1, X.coldim());
-				Yrow.copy(Xrow); // right kind of copy?
-			}
-		*/
+			gatherRows(Y, X, false);
 			return Y;
 		}
 
-            // Permutes the columns of X
+            // Permutes the columns of X: column _indices[j] of Y is column j of X
 		Matrix& applyLeft(Matrix& Y, const Matrix& X) const
 		{
-			Element x; field().init(x);
-			for (size_t j = 0; j < Y.coldim(); ++j){
-				size_t k = _indices[j];
-				for (size_t i = 0; i < Y.rowdim(); ++i)
-					Y.setEntry(i,k, X.getEntry(x, i, j));
-			}
-		/* desired form
-			for (size_t i = 0; i < coldim(); ++i)
-			{
-				Matrix Ycol(Y, 0, _indices[i], Y.rowdim(), 1);
-				Matrix Xcol(X, 0, i, X.rowdim(), 1);
-				Ycol.copy(Xcol);
-			}
-		*/
+			gatherColumns(Y, X, true);
 			return Y;
 		}
+
 		/* FIBB functions */
 
 		BBType bbTag() const { return permutation; }
@@ -233,52 +212,31 @@ namespace LinBox
 		{ return r = rowdim(); }
 
 		Element& det(Element& d) const
-		{	size_t b = 0, i, j, k;
-			Storage marks(_indices.size());
+		{	// sign of the permutation: parity of the sum of (length - 1) of the cycles
+			size_t b = 0, i, j;
+			std::vector<bool> marks(_indices.size(), false);
 			for (i = 0; i < _indices.size(); ++i)
 			if (not marks[i])
-			{	for (k = 1, j = _indices[i]; i != j; ++k, j = _indices[j])
-				;
-				b &= k;
+			{	marks[i] = true;
+				for (j = (size_t)_indices[i]; i != j; j = (size_t)_indices[j])
+				{	marks[j] = true;
+					++b;
+				}
 			}
 			return d = b&1 ? field().mOne : field().one;
 		}
 
-            // Inverse permutation on the rows
+            // Inverse permutation on the rows: row _indices[i] of Y is row i of X
 		Matrix& solveRight(Matrix& Y, const Matrix& X) const
-		{	Element x; field().init(x);
-			for (size_t i = 0; i < Y.rowdim(); ++i){
-				size_t k = _indices[i];
-				for (size_t j = 0; j < Y.coldim(); ++j)
-					Y.setEntry(k,j, X.getEntry(x, i, j));
-			}
-		/* desired form
-		 	for (size_t i = 0; i < rowdim(); ++i)
-			{
-				Matrix Yrow(Y, _indices[i], 0, 1, Y.coldim());
-				Matrix Xrow(X, i, 0, 1, X.coldim());
-				Yrow.copy(Xrow);
-			}
-		*/
+		{
+			gatherRows(Y, X, true);
 			return Y;
 		}
 
-            // Inverse permutation on the columns
+            // Inverse permutation on the columns: column j of Y is column _indices[j] of X
 		Matrix& solveLeft(Matrix& Y, const Matrix& X) const
-		{	Element x; field().init(x);
-			for (size_t j = 0; j < Y.coldim(); ++j){
-				size_t k = _indices[j];
-				for (size_t i = 0; i < Y.rowdim(); ++i)
-					Y.setEntry(i,j, X.getEntry(x, i, k));
-			}
-		/* desired form
-			for (size_t i = 0; i < coldim(); ++i)
-			{
-				Matrix Ycol(Y, 0, i, Y.rowdim(), 1);
-				Matrix Xcol(X, 0, _indices[i], X.rowdim(), 1);
-				Ycol.copy(Xcol);
-			}
-		*/
+		{
+			gatherColumns(Y, X, false);
 			return Y;
 		}
 		Matrix& nullspaceRandomRight(Matrix& N) const
@@ -468,6 +426,48 @@ namespace LinBox
 		std::reverse(_indices.begin() + i + 1, _indices.end());
 	}
 
+protected:
+	// Y_i = X_{_indices[i]} (or Y_{_indices[i]} = X_i) for the rows, one copy
+	// of a row each, the rows shared among the threads
+	void gatherRows(Matrix& Y, const Matrix& X, bool scatter) const
+	{
+		linbox_check(X.rowdim() == rowdim() && Y.rowdim() == rowdim() && X.coldim() == Y.coldim());
+		size_t n = X.coldim(), ldx = X.getStride(), ldy = Y.getStride();
+		typename Field::ConstElement_ptr Xp = X.getPointer();
+		typename Field::Element_ptr Yp = Y.getPointer();
+#ifdef __LINBOX_USE_OPENMP
+#pragma omp parallel for schedule(static) if (rowdim()*n > 32768)
+#endif
+		for (long i = 0; i < (long)rowdim(); ++i) {
+			size_t s = (size_t)i, t = (size_t)_indices[(size_t)i];
+			if (scatter) std::swap(s, t);
+			FFLAS::fassign(field(), n, Xp + t*ldx, 1, Yp + s*ldy, 1);
+		}
+	}
+
+	// the same on the entries of each row of X: Y_{r,j} = X_{r,_indices[j]}
+	// (or Y_{r,_indices[j]} = X_{r,j})
+	void gatherColumns(Matrix& Y, const Matrix& X, bool scatter) const
+	{
+		linbox_check(X.coldim() == coldim() && Y.coldim() == coldim() && X.rowdim() == Y.rowdim());
+		size_t n = coldim(), ldx = X.getStride(), ldy = Y.getStride();
+		typename Field::ConstElement_ptr Xp = X.getPointer();
+		typename Field::Element_ptr Yp = Y.getPointer();
+#ifdef __LINBOX_USE_OPENMP
+#pragma omp parallel for schedule(static) if (X.rowdim()*n > 32768)
+#endif
+		for (long r = 0; r < (long)X.rowdim(); ++r) {
+			typename Field::ConstElement_ptr x = Xp + (size_t)r*ldx;
+			typename Field::Element_ptr y = Yp + (size_t)r*ldy;
+			if (scatter)
+				for (size_t j = 0; j < n; ++j)
+					field().assign(y[(size_t)_indices[j]], x[j]);
+			else
+				for (size_t j = 0; j < n; ++j)
+					field().assign(y[j], x[(size_t)_indices[j]]);
+		}
+	}
+
 }; // template <Vector> class Permutation
 
 } // namespace LinBox
@@ -25,8 +25,15 @@
 #ifndef __LINBOX_bb_polynomial_H
 #define __LINBOX_bb_polynomial_H
 
+#include <vector>
+#include <cmath>
+#include <type_traits>
+
 #include "linbox/blackbox/blackbox-interface.h"
+#include "linbox/blackbox/blockbb.h"
 #include "linbox/vector/vector-domain.h"
+#include "linbox/matrix/dense-matrix.h"
+#include "linbox/matrix/matrix-domain.h"
 // Namespace in which all LinBox library code resides
 namespace LinBox
 {
@@ -40,8 +47,193 @@ namespace LinBox
 namespace LinBox
 {
 
+	/** Krylov block \f$[X, AX, A^2X, \ldots]\f$ of a dense block X.
+	 *
+	 * Kept by the caller between the applies of several polynomials of the
+	 * same blackbox A to the same block X (see PolynomialBB::applyLeft): the
+	 * powers already computed are reused, the missing ones appended. A block
+	 * different from the one of the Krylov block restarts it.
+	 */
+	template <class Matrix>
+	class KrylovBlock {
+	public:
+		size_t size() const { return _K.size(); }
+		const Matrix& operator[] (size_t i) const { return _K[i]; }
+		void clear() { _K.clear(); }
+
+		/// Whether the block is the one of the Krylov block.
+		bool isFor(const Matrix &X) const
+		{
+			if (_K.empty() || _K[0].rowdim() != X.rowdim() || _K[0].coldim() != X.coldim())
+				return false;
+			for (size_t i = 0; i < X.rowdim(); ++i)
+				for (size_t j = 0; j < X.coldim(); ++j)
+					if (! X.field().areEqual(_K[0].getEntry(i, j), X.getEntry(i, j)))
+						return false;
+			return true;
+		}
+
+		/// Krylov block of X and A, up to \f$A^{d-1}X\f$.
+		template <class Blackbox>
+		void extend(const Blackbox &A, const Matrix &X, size_t d);
+
+	private:
+		std::vector<Matrix> _K;
+	};
+
+	namespace Protected {
+
+		// Y = A X, by the block apply of A when it has one
+		template <class Blackbox, class Matrix>
+		typename std::enable_if<is_blockbb<Blackbox>::value>::type
+		polyBlockApply(Matrix &Y, const Blackbox &A, const Matrix &X)
+		{
+			A.applyLeft(Y, X);
+		}
+
+		template <class Blackbox, class Matrix>
+		typename std::enable_if<!is_blockbb<Blackbox>::value>::type
+		polyBlockApply(Matrix &Y, const Blackbox &A, const Matrix &X)
+		{
+			typename Matrix::ColIterator p1 = Y.colBegin();
+			typename Matrix::ConstColIterator p2 = X.colBegin();
+			for (; p2 != X.colEnd(); ++p1, ++p2)
+				A.apply(*p1, *p2);
+		}
+
+		template <class Field, class Rep, class Matrix>
+		void polyBlockApply(Matrix &Y, const BlasMatrix<Field, Rep> &A, const Matrix &X)
+		{
+			BlasMatrixDomain<Field>(A.field()).mul(Y, A, X);
+		}
+
+		// Y = X A
+		template <class Blackbox, class Matrix>
+		typename std::enable_if<is_blockbb<Blackbox>::value>::type
+		polyBlockApplyRight(Matrix &Y, const Blackbox &A, const Matrix &X)
+		{
+			A.applyRight(Y, X);
+		}
+
+		template <class Blackbox, class Matrix>
+		typename std::enable_if<!is_blockbb<Blackbox>::value>::type
+		polyBlockApplyRight(Matrix &Y, const Blackbox &A, const Matrix &X)
+		{
+			typename Matrix::RowIterator p1 = Y.rowBegin();
+			typename Matrix::ConstRowIterator p2 = X.rowBegin();
+			for (; p2 != X.rowEnd(); ++p1, ++p2)
+				A.applyTranspose(*p1, *p2);
+		}
+
+		template <class Field, class Rep, class Matrix>
+		void polyBlockApplyRight(Matrix &Y, const BlasMatrix<Field, Rep> &A, const Matrix &X)
+		{
+			BlasMatrixDomain<Field>(A.field()).mul(Y, X, A);
+		}
+
+		// Y = a X + T, T = NULL for 0
+		template <class Matrix, class Element>
+		void polyAxpy(Matrix &Y, const Element &a, const Matrix &X, const Matrix *T)
+		{
+			const typename Matrix::Field &F = X.field();
+			for (size_t i = 0; i < X.rowdim(); ++i)
+				for (size_t j = 0; j < X.coldim(); ++j) {
+					Element &y = Y.refEntry(i, j);
+					if (T) F.assign(y, T->getEntry(i, j));
+					else F.assign(y, F.zero);
+					F.axpyin(y, a, X.getEntry(i, j));
+				}
+		}
+
+		// Y = P(A) X by block Horner, one block apply of A per coefficient
+		template <class Blackbox, class Poly, class Matrix>
+		Matrix& polyHorner(Matrix &Y, const Blackbox &A, const Poly &P, const Matrix &X, bool right)
+		{
+			size_t d = P.size();
+			Matrix T(X.field(), Y.rowdim(), Y.coldim());
+			polyAxpy(Y, d ? P[d-1] : X.field().zero, X, (const Matrix*) NULL);
+			for (size_t i = d ? d-1 : 0; i-- > 0; ) {
+				if (right) polyBlockApplyRight(T, A, Y);
+				else polyBlockApply(T, A, Y);
+				polyAxpy(Y, P[i], X, &T);
+			}
+			return Y;
+		}
+
+		template <class Blackbox, class Poly, class Matrix>
+		Matrix& polyApplyLeft(Matrix &Y, const Blackbox &A, const Poly &P, const Matrix &X)
+		{
+			return polyHorner(Y, A, P, X, false);
+		}
+
+		/* Dense A: Paterson-Stockmeyer when it is cheaper. With
+		 * \f$P = \sum_j Q_j z^{sj}\f$, \f$\deg Q_j < s\f$, it costs s-1
+		 * products by A for the Krylov block of X, about 2 log s products
+		 * A^2, A^4... for B = A^s, and t-1 products by B for the Horner scheme
+		 * in B of the \f$Q_j(A)X\f$: \f$(s+t) n^2 k + 2 \log s\, n^3\f$
+		 * instead of \f$d n^2 k\f$.
+		 */
+		template <class Field, class Rep, class Poly, class Matrix>
+		Matrix& polyApplyLeft(Matrix &Y, const BlasMatrix<Field, Rep> &A, const Poly &P, const Matrix &X)
+		{
+			size_t d = P.size(), n = A.rowdim(), k = X.coldim();
+			size_t s = (size_t) std::ceil(std::sqrt((double) d)), t = s ? (d + s - 1) / s : 0, hb = 0;
+			while ((s >> (hb + 1)) != 0) ++hb;
+			if (d < 8 || (double)(s + t) * n * n * k + 2. * hb * n * n * n >= (double) d * n * n * k)
+				return polyHorner(Y, A, P, X, false);
+
+			const Field &F = A.field();
+			BlasMatrixDomain<Field> BMD(F);
+			KrylovBlock<Matrix> K;
+			K.extend(A, X, s);
+
+			// B = A^s, by squarings
+			BlasMatrix<Field, Rep> B(A), W(F, n, n);
+			for (size_t b = hb; b-- > 0; ) {
+				BMD.mul(W, B, B);
+				if ((s >> b) & 1) BMD.mul(B, W, A);
+				else B = W;
+			}
+
+			// Y = sum_j B^j Q_j(A) X, Horner in B
+			Matrix Q(F, n, k), T(F, n, k);
+			for (size_t j = t; j-- > 0; ) {
+				polyAxpy(Q, F.zero, X, (const Matrix*) NULL);
+				for (size_t i = 0; i < s && j*s + i < d; ++i)
+					polyAxpy(Q, P[j*s + i], K[i], &Q);
+				if (j + 1 == t)
+					Y = Q;
+				else {
+					BMD.mul(T, B, Y);
+					polyAxpy(Y, F.one, T, &Q);
+				}
+			}
+			return Y;
+		}
+
+	} // namespace Protected
+
+	template <class Matrix>
+	template <class Blackbox>
+	void KrylovBlock<Matrix>::extend(const Blackbox &A, const Matrix &X, size_t d)
+	{
+		if (! isFor(X)) {
+			_K.clear();
+			_K.push_back(X);
+		}
+		while (_K.size() < d) {
+			_K.push_back(Matrix(X.field(), A.rowdim(), X.coldim()));
+			Protected::polyBlockApply(_K.back(), A, _K[_K.size() - 2]);
+		}
+	}
+
 	/** \brief represent the matrix P(A) where A is a blackbox and P a polynomial
 
+	  Blocks of vectors are applied by block Horner, one block apply of A
+	  (sparse matrix times dense block, for a sparse matrix) per coefficient;
+	  for a dense A and a polynomial of high degree by Paterson-Stockmeyer,
+	  see applyLeft.
+
 	  \ingroup blackbox
 
 */
@@ -128,6 +320,37 @@ namespace LinBox
 		}
 
 
+		/** Y = P(A) X for a dense block X.
+		 * Block Horner; Paterson-Stockmeyer for a dense A (BlasMatrix) when
+		 * the degree is large enough with respect to n / X.coldim().
+		 */
+		template <class Matrix>
+		Matrix &applyLeft (Matrix &Y, const Matrix &X) const
+		{
+			return Protected::polyApplyLeft(Y, *_A_ptr, *_P_ptr, X);
+		}
+
+		/** Y = P(A) X from the Krylov block K of X, computed or completed
+		 * as needed: the products by A are shared by all the polynomials of
+		 * A applied to the same X with the same K.
+		 */
+		template <class Matrix>
+		Matrix &applyLeft (Matrix &Y, const Matrix &X, KrylovBlock<Matrix> &K) const
+		{
+			K.extend(*_A_ptr, X, _P_ptr->size());
+			Protected::polyAxpy(Y, field().zero, X, (const Matrix*) NULL);
+			for (size_t i = 0; i < _P_ptr->size(); ++i)
+				Protected::polyAxpy(Y, _P_ptr->operator[](i), K[i], &Y);
+			return Y;
+		}
+
+		/// Y = X P(A), by block Horner.
+		template <class Matrix>
+		Matrix &applyRight (Matrix &Y, const Matrix &X) const
+		{
+			return Protected::polyHorner(Y, *_A_ptr, *_P_ptr, X, true);
+		}
+
 		template<typename _Tp1, class Poly1 = typename Polynomial::template rebind<_Tp1>::other>
 		struct rebind {
 			typedef PolynomialBBOwner<typename Blackbox::template rebind<_Tp1>::other, Poly1> other;
@@ -273,6 +496,20 @@ namespace LinBox
 		}
 
 
+		/// Y = P(A) X, see PolynomialBB::applyLeft.
+		template <class Matrix>
+		Matrix &applyLeft (Matrix &Y, const Matrix &X) const
+		{
+			return Protected::polyApplyLeft(Y, _A_data, _P_data, X);
+		}
+
+		/// Y = X P(A), by block Horner.
+		template <class Matrix>
+		Matrix &applyRight (Matrix &Y, const Matrix &X) const
+		{
+			return Protected::polyHorner(Y, _A_data, _P_data, X, true);
+		}
+
 		template<typename _Tp1, class Poly1 = typename Polynomial::template rebind<_Tp1>::other>
 		struct rebind {
 			typedef PolynomialBBOwner<typename Blackbox::template rebind<_Tp1>::other, Poly1> other;
@@ -337,6 +574,16 @@ namespace LinBox
 
 	};
 
+	template <class Blackbox, class Poly>
+	struct is_blockbb<PolynomialBB<Blackbox, Poly> > {
+		static const bool value = true;
+	};
+
+	template <class Blackbox, class Poly>
+	struct is_blockbb<PolynomialBBOwner<Blackbox, Poly> > {
+		static const bool value = true;
+	};
+
 } // namespace LinBox
 
 #endif // __LINBOX_bb_polynomial_H
@@ -360,6 +360,11 @@ namespace LinBox
 	struct RankCategory<ScalarMatrix<Field> >
 	{ typedef SolutionTags::Local Tag; };
 
+	template <class Field>
+	struct is_reentrant<ScalarMatrix<Field> > {
+		static const bool value = true;
+	};
+
 } // namespace LinBox
 
 #endif // __LINBOX_scalar_H
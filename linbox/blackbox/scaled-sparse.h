@@ -0,0 +1,247 @@
+/* linbox/blackbox/scaled-sparse.h
+ * Copyright (C) LinBox
+ *
+ * ========LICENCE========
+ * This file is part of the library LinBox.
+ *
+ * LinBox is free software: you can redistribute it and/or modify
+ * it under the terms of the  GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.	 See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ * ========LICENCE========
+ */
+
+/*! @file blackbox/scaled-sparse.h
+ * @ingroup blackbox
+ * @brief Sparse matrices with their diagonal scalings folded in.
+ */
+
+#ifndef __LINBOX_scaled_sparse_H
+#define __LINBOX_scaled_sparse_H
+
+#include <vector>
+
+#include "linbox/linbox-config.h"
+#include "linbox/util/debug.h"
+#include "linbox/blackbox/blockbb.h"
+#include "linbox/blackbox/sparse-blockbb.h"
+#include "linbox/vector/blas-vector.h"
+
+#if defined(__LINBOX_USE_OPENMP)
+#include <omp.h>
+#endif
+
+namespace LinBox
+{
+
+template <class _Field>
+class ScaledGram;
+
+/**
+ * Blackbox of \f$\alpha D_L \mathrm{op}(A) D_R\f$, with \f$A\f$ sparse,
+ * \f$\mathrm{op}(A)\f$ either \f$A\f$ or \f$A^T\f$ and \f$D_L, D_R\f$ diagonal.
+ *
+ * The scalings are applied once to the entries, which are then kept in the
+ * compressed rows of a SparseBlockBB without identity rows: an apply is a
+ * single pass over the nonzero entries, without intermediate vector, the
+ * rows being shared among the OpenMP threads. It is also a block blackbox.
+ *
+ * The matrix must provide rowBegin()/rowEnd() over rows of (column, value)
+ * pairs, as the default SparseMatrix does.
+ \ingroup blackbox
+ */
+template <class _Field>
+class ScaledSparse : public SparseBlockBB<_Field> {
+public:
+	typedef _Field                   Field;
+	typedef typename Field::Element  Element;
+	typedef ScaledSparse<Field>      Self_t;
+
+	/** Constructor from a sparse matrix and its scalings.
+	 * @param A sparse matrix over F
+	 * @param dl diagonal of \f$D_L\f$, or NULL for the identity
+	 * @param dr diagonal of \f$D_R\f$, or NULL for the identity
+	 * @param transpose whether \f$\mathrm{op}(A) = A^T\f$
+	 */
+	template <class Matrix>
+	ScaledSparse(const Matrix &A, const BlasVector<Field> *dl, const BlasVector<Field> *dr, bool transpose = false) :
+		SparseBlockBB<Field>(A, dl, dr, transpose)
+	{}
+
+	/// Multiplies the matrix by \p alpha.
+	Self_t& scale(const Element &alpha)
+	{
+		for (size_t k = 0; k < this->_data.size(); ++k)
+			this->field().mulin(this->_data[k], alpha);
+		return *this;
+	}
+
+	friend class ScaledGram<Field>;
+
+}; // class ScaledSparse
+
+/**
+ * Symmetric blackbox of \f$D_1 A^T D_2 A D_1\f$, with \f$A\f$ sparse and
+ * \f$D_1, D_2\f$ diagonal, as in the symmetrized Wiedemann methods.
+ *
+ * It keeps \f$B = A D_1\f$ in compressed rows and computes
+ * \f$B^T D_2 B x\f$ in a single pass over the rows of \f$B\f$: each row
+ * gives one entry of \f$D_2 B x\f$, which is at once scattered back along
+ * the same row. Neither \f$A D_1 x\f$ nor any other intermediate vector is
+ * stored, and the rows of \f$B\f$ are read once per apply instead of twice.
+ * The pass is sequential; block applies share their columns among the
+ * OpenMP threads.
+ \ingroup blackbox
+ */
+template <class _Field>
+class ScaledGram : public BlackboxInterface {
+public:
+	typedef _Field                   Field;
+	typedef typename Field::Element  Element;
+
+protected:
+	ScaledSparse<Field>    _B;
+	std::vector<Element>  _d2;
+
+public:
+
+	/** Constructor.
+	 * @param A sparse matrix over F
+	 * @param d1 diagonal of \f$D_1\f$, or NULL for the identity
+	 * @param d2 diagonal of \f$D_2\f$, or NULL for the identity
+	 */
+	template <class Matrix>
+	ScaledGram(const Matrix &A, const BlasVector<Field> *d1, const BlasVector<Field> *d2) :
+		_B(A, NULL, d1)
+	{
+		if (d2 != NULL) {
+			linbox_check(d2->size() == A.rowdim());
+			_d2.assign(d2->begin(), d2->end());
+		}
+	}
+
+	size_t rowdim() const { return _B.coldim(); }
+	size_t coldim() const { return _B.coldim(); }
+	const Field& field() const { return _B.field(); }
+
+	/// y = D1 A^T D2 A D1 x.
+	template <class OutVector, class InVector>
+	OutVector& apply(OutVector &y, const InVector &x) const
+	{
+		return _apply(y, x);
+	}
+
+	/// Same as apply, the matrix is symmetric.
+	template <class OutVector, class InVector>
+	OutVector& applyTranspose(OutVector &y, const InVector &x) const
+	{
+		return _apply(y, x);
+	}
+
+	/// Y = D1 A^T D2 A D1 X, one column of X per thread.
+	template <class Matrix>
+	Matrix& applyLeft(Matrix &Y, const Matrix &X) const
+	{
+		linbox_check(X.rowdim() == coldim() && Y.rowdim() == rowdim());
+		linbox_check(X.coldim() == Y.coldim());
+
+		size_t ldx = X.getStride(), ldy = Y.getStride();
+		const Element *xp = X.getPointer();
+		Element *yp = Y.getPointer();
+		long cols = (long) X.coldim();
+#ifdef __LINBOX_USE_OPENMP
+#pragma omp parallel for schedule(static) if (_B.size()*X.coldim() > 4096)
+#endif
+		for (long j = 0; j < cols; ++j) {
+			StridedRef<Element> yj(yp + j, ldy);
+			StridedRef<const Element> xj(xp + j, ldx);
+			_apply(yj, xj);
+		}
+		return Y;
+	}
+
+	/// Y = X D1 A^T D2 A D1, one row of X per thread.
+	template <class Matrix>
+	Matrix& applyRight(Matrix &Y, const Matrix &X) const
+	{
+		linbox_check(X.coldim() == rowdim() && Y.coldim() == coldim());
+		linbox_check(X.rowdim() == Y.rowdim());
+
+		size_t ldx = X.getStride(), ldy = Y.getStride();
+		const Element *xp = X.getPointer();
+		Element *yp = Y.getPointer();
+		long rows = (long) X.rowdim();
+#ifdef __LINBOX_USE_OPENMP
+#pragma omp parallel for schedule(static) if (_B.size()*X.rowdim() > 4096)
+#endif
+		for (long l = 0; l < rows; ++l) {
+			Element *yl = yp + (size_t)l*ldy;
+			_apply(yl, xp + (size_t)l*ldx);
+		}
+		return Y;
+	}
+
+protected:
+
+	// strided column of a dense block, indexed like a vector
+	template <class T>
+	struct StridedRef {
+		T *_p; size_t _ld;
+		StridedRef(T *p, size_t ld) : _p(p), _ld(ld) {}
+		T& operator[] (size_t i) const { return _p[i*_ld]; }
+	};
+
+	template <class OutVector, class InVector>
+	OutVector& _apply(OutVector &y, const InVector &x) const
+	{
+		const Field &F = field();
+		const size_t *start = &_B._start[0];
+		for (size_t j = 0; j < coldim(); ++j)
+			F.assign(y[j], F.zero);
+		Element t;
+		F.init(t);
+		for (size_t i = 0; i < _B.rowdim(); ++i) {
+			if (start[i] == start[i+1]) continue;
+			F.assign(t, F.zero);
+			for (size_t k = start[i]; k < start[i+1]; ++k)
+				F.axpyin(t, _B._data[k], x[_B._colid[k]]);
+			if (! _d2.empty()) F.mulin(t, _d2[i]);
+			if (F.isZero(t)) continue;
+			for (size_t k = start[i]; k < start[i+1]; ++k)
+				F.axpyin(y[_B._colid[k]], _B._data[k], t);
+		}
+		return y;
+	}
+
+}; // class ScaledGram
+
+template <class Field>
+struct is_blockbb<ScaledSparse<Field>> {
+	static const bool value = true;
+};
+
+template <class Field>
+struct is_blockbb<ScaledGram<Field>> {
+	static const bool value = true;
+};
+
+} // LinBox
+
+#endif // __LINBOX_scaled_sparse_H
+
+// Local Variables:
+// mode: C++
+// tab-width: 4
+// indent-tabs-mode: nil
+// c-basic-offset: 4
+// End:
+// vim:sts=4:sw=4:ts=4:et:sr:cino=>s,f0,{0,g0,(0,\:0,t0,+0,=s
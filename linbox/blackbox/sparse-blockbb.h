@@ -0,0 +1,282 @@
+/* linbox/blackbox/sparse-blockbb.h
+ * Copyright (C) LinBox
+ *
+ * ========LICENCE========
+ * This file is part of the library LinBox.
+ *
+ * LinBox is free software: you can redistribute it and/or modify
+ * it under the terms of the  GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.	 See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ * ========LICENCE========
+ */
+
+/*! @file blackbox/sparse-blockbb.h
+ * @ingroup blackbox
+ * @brief Row scaled sparse matrix with a sparse times dense block product.
+ */
+
+#ifndef __LINBOX_sparse_blockbb_H
+#define __LINBOX_sparse_blockbb_H
+
+#include <vector>
+
+#include "linbox/linbox-config.h"
+#include "linbox/util/debug.h"
+#include "linbox/blackbox/blackbox-interface.h"
+#include "linbox/blackbox/blockbb.h"
+#include "linbox/vector/blas-vector.h"
+
+#if defined(__LINBOX_USE_OPENMP)
+#include <omp.h>
+#endif
+
+namespace LinBox
+{
+
+/**
+ * Block blackbox of \f$D (A \oplus I)\f$, with \f$A\f$ sparse and \f$D\f$ diagonal.
+ *
+ * The entries of \f$D A\f$ are copied once in compressed rows, then
+ * applyLeft computes \f$Y = D A X\f$ for a dense block \f$X\f$ in a single
+ * pass over the nonzero entries (each row of \f$A\f$ updates a whole row of
+ * \f$Y\f$), the rows being shared among the OpenMP threads.
+ *
+ * The dimension may be larger than the one of \f$A\f$: the extra rows are
+ * rows of the identity scaled by \f$D\f$, so that block methods can pad a
+ * system to a multiple of their block size. The compressed rows may also
+ * hold a rectangular \f$D_L \mathrm{op}(A) D_R\f$, see ScaledSparse.
+ *
+ * The matrix must provide rowBegin()/rowEnd() over rows of (column, value)
+ * pairs, as the default SparseMatrix does.
+ \ingroup blackbox
+ */
+template <class _Field>
+class SparseBlockBB : public BlackboxInterface {
+public:
+	typedef _Field                   Field;
+	typedef typename Field::Element  Element;
+
+protected:
+	const Field          *_field;
+	size_t                 _rdim;
+	size_t                 _cdim;
+	size_t                 _arow; // rows stored, the next ones are those of D
+	std::vector<size_t>   _start;
+	std::vector<size_t>   _colid;
+	std::vector<Element>   _data;
+	std::vector<Element>   _diag;
+
+public:
+
+	/** Constructor from a sparse matrix and a diagonal.
+	 * @param A square sparse matrix over F
+	 * @param d diagonal of \f$D\f$, its size is the dimension, at least the one of \p A
+	 */
+	template <class Matrix>
+	SparseBlockBB(const Matrix &A, const BlasVector<Field> &d) :
+		_field(&d.field()), _rdim(d.size()), _cdim(d.size()), _arow(A.rowdim()), _start(A.rowdim()+1, 0)
+	{
+		linbox_check(A.rowdim() == A.coldim());
+		linbox_check(d.size() >= A.rowdim());
+
+		_diag.resize(_rdim);
+		for (size_t i = 0; i < _rdim; ++i)
+			field().assign(_diag[i], d[i]);
+		storeRows(A, &d, NULL);
+	}
+
+	size_t rowdim() const { return _rdim; }
+	size_t coldim() const { return _cdim; }
+	const Field& field() const { return *_field; }
+
+	/// Number of stored entries of \f$D A\f$.
+	size_t size() const { return _data.size(); }
+
+	/// y = D (A (+) I) x.
+	template <class OutVector, class InVector>
+	OutVector& apply(OutVector &y, const InVector &x) const
+	{
+		long arow = (long) _arow;
+#ifdef __LINBOX_USE_OPENMP
+#pragma omp parallel for schedule(static) if (_data.size() > 4096)
+#endif
+		for (long i = 0; i < arow; ++i) {
+			Element s;
+			field().assign(s, field().zero);
+			for (size_t k = _start[i]; k < _start[i+1]; ++k)
+				field().axpyin(s, _data[k], x[_colid[k]]);
+			field().assign(y[i], s);
+		}
+		for (size_t i = _arow; i < _rdim; ++i)
+			field().mul(y[i], _diag[i], x[i]);
+		return y;
+	}
+
+	/// y = (A (+) I)^T D x.
+	template <class OutVector, class InVector>
+	OutVector& applyTranspose(OutVector &y, const InVector &x) const
+	{
+		for (size_t j = 0; j < _cdim; ++j)
+			field().assign(y[j], field().zero);
+		for (size_t i = 0; i < _arow; ++i)
+			for (size_t k = _start[i]; k < _start[i+1]; ++k)
+				field().axpyin(y[_colid[k]], _data[k], x[i]);
+		for (size_t i = _arow; i < _rdim; ++i)
+			field().mul(y[i], _diag[i], x[i]);
+		return y;
+	}
+
+	/// Y = D (A (+) I) X, X and Y dense blocks with as many columns.
+	template <class Matrix>
+	Matrix& applyLeft(Matrix &Y, const Matrix &X) const
+	{
+		linbox_check(X.rowdim() == _cdim && Y.rowdim() == _rdim);
+		linbox_check(X.coldim() == Y.coldim());
+
+		size_t s = X.coldim();
+		size_t ldx = X.getStride(), ldy = Y.getStride();
+		const Element *xp = X.getPointer();
+		Element *yp = Y.getPointer();
+		long arow = (long) _arow;
+#ifdef __LINBOX_USE_OPENMP
+#pragma omp parallel for schedule(static) if (_data.size()*s > 4096)
+#endif
+		for (long i = 0; i < arow; ++i) {
+			Element *yi = yp + (size_t)i*ldy;
+			for (size_t j = 0; j < s; ++j)
+				field().assign(yi[j], field().zero);
+			for (size_t k = _start[i]; k < _start[i+1]; ++k) {
+				const Element *xk = xp + _colid[k]*ldx;
+				for (size_t j = 0; j < s; ++j)
+					field().axpyin(yi[j], _data[k], xk[j]);
+			}
+		}
+		for (size_t i = _arow; i < _rdim; ++i)
+			for (size_t j = 0; j < s; ++j)
+				field().mul(yp[i*ldy+j], _diag[i], xp[i*ldx+j]);
+		return Y;
+	}
+
+	/// Y = X D (A (+) I).
+	template <class Matrix>
+	Matrix& applyRight(Matrix &Y, const Matrix &X) const
+	{
+		linbox_check(X.coldim() == _rdim && Y.coldim() == _cdim);
+		linbox_check(X.rowdim() == Y.rowdim());
+
+		size_t r = X.rowdim();
+		size_t ldx = X.getStride(), ldy = Y.getStride();
+		const Element *xp = X.getPointer();
+		Element *yp = Y.getPointer();
+		long rows = (long) r;
+#ifdef __LINBOX_USE_OPENMP
+#pragma omp parallel for schedule(static) if (_data.size()*r > 4096)
+#endif
+		for (long l = 0; l < rows; ++l) {
+			Element *yl = yp + (size_t)l*ldy;
+			const Element *xl = xp + (size_t)l*ldx;
+			applyTranspose(yl, xl);
+		}
+		return Y;
+	}
+
+protected:
+
+	/** The rows of \f$D_L \mathrm{op}(A) D_R\f$, without identity rows.
+	 * @param A sparse matrix over F
+	 * @param dl diagonal of \f$D_L\f$, or NULL for the identity
+	 * @param dr diagonal of \f$D_R\f$, or NULL for the identity
+	 * @param transpose whether \f$\mathrm{op}(A) = A^T\f$
+	 */
+	template <class Matrix>
+	SparseBlockBB(const Matrix &A, const BlasVector<Field> *dl, const BlasVector<Field> *dr, bool transpose) :
+		_field(&A.field()),
+		_rdim(transpose ? A.coldim() : A.rowdim()),
+		_cdim(transpose ? A.rowdim() : A.coldim()),
+		_arow(_rdim),
+		_start(_rdim+1, 0)
+	{
+		linbox_check(dl == NULL || dl->size() == _rdim);
+		linbox_check(dr == NULL || dr->size() == _cdim);
+		if (transpose)
+			storeTransposedRows(A, dl, dr);
+		else
+			storeRows(A, dl, dr);
+	}
+
+	// the nonzero entries of dl A dr, row after row
+	template <class Matrix>
+	void storeRows(const Matrix &A, const BlasVector<Field> *dl, const BlasVector<Field> *dr)
+	{
+		size_t i = 0;
+		for (auto row = A.rowBegin(); row != A.rowEnd(); ++row, ++i) {
+			for (auto it = row->begin(); it != row->end(); ++it) {
+				if (field().isZero(it->second)) continue;
+				_colid.push_back(it->first);
+				_data.push_back(scaled(it->second, dl, i, dr, it->first));
+			}
+			_start[i+1] = _colid.size();
+		}
+	}
+
+	// the nonzero entries of dl A^T dr, by counting sort on the columns of A
+	template <class Matrix>
+	void storeTransposedRows(const Matrix &A, const BlasVector<Field> *dl, const BlasVector<Field> *dr)
+	{
+		for (auto row = A.rowBegin(); row != A.rowEnd(); ++row)
+			for (auto it = row->begin(); it != row->end(); ++it)
+				if (! field().isZero(it->second)) ++_start[it->first+1];
+		for (size_t j = 0; j < _arow; ++j)
+			_start[j+1] += _start[j];
+		_colid.resize(_start[_arow]);
+		_data.resize(_start[_arow]);
+		std::vector<size_t> pos(_start.begin(), _start.end()-1);
+		size_t i = 0;
+		for (auto row = A.rowBegin(); row != A.rowEnd(); ++row, ++i)
+			for (auto it = row->begin(); it != row->end(); ++it) {
+				if (field().isZero(it->second)) continue;
+				size_t k = pos[it->first]++;
+				_colid[k] = i;
+				_data[k] = scaled(it->second, dl, it->first, dr, i);
+			}
+	}
+
+	Element scaled(const Element &a, const BlasVector<Field> *dl, size_t i,
+		       const BlasVector<Field> *dr, size_t j) const
+	{
+		Element v;
+		field().init(v);
+		field().assign(v, a);
+		if (dl != NULL) field().mulin(v, (*dl)[i]);
+		if (dr != NULL) field().mulin(v, (*dr)[j]);
+		return v;
+	}
+
+}; // class SparseBlockBB
+
+template <class Field>
+struct is_blockbb<SparseBlockBB<Field>> {
+	static const bool value = true;
+};
+
+} // LinBox
+
+#endif // __LINBOX_sparse_blockbb_H
+
+// Local Variables:
+// mode: C++
+// tab-width: 4
+// indent-tabs-mode: nil
+// c-basic-offset: 4
+// End:
+// vim:sts=4:sw=4:ts=4:et:sr:cino=>s,f0,{0,g0,(0,\:0,t0,+0,=s
@@ -30,6 +30,7 @@
 #define __LINBOX_sum_H
 
 #include "linbox/vector/vector-domain.h"
+#include "linbox/vector/scratch-vector.h"
 #include "linbox/util/debug.h"
 #include "linbox/blackbox/blackbox-interface.h"
 
@@ -77,8 +78,8 @@ namespace LinBox
 			linbox_check (A.coldim () == B.coldim ());
 			linbox_check (A.rowdim () == B.rowdim ());
 
-			VectorWrapper::ensureDim (_z1, A.rowdim ());
-			VectorWrapper::ensureDim (_z2, A.coldim ());
+			VectorWrapper::ensureDim (_z1.get(), A.rowdim ());
+			VectorWrapper::ensureDim (_z2.get(), A.coldim ());
 		}
 
 		/** Constructor from black box pointers.
@@ -95,8 +96,8 @@ namespace LinBox
 			linbox_check (A_ptr->coldim () == B_ptr->coldim ());
 			linbox_check (A_ptr->rowdim () == B_ptr->rowdim ());
 
-			VectorWrapper::ensureDim (_z1, A_ptr->rowdim ());
-			VectorWrapper::ensureDim (_z2, A_ptr->coldim ());
+			VectorWrapper::ensureDim (_z1.get(), A_ptr->rowdim ());
+			VectorWrapper::ensureDim (_z2.get(), A_ptr->coldim ());
 		}
 
 		/** Copy constructor.
@@ -106,8 +107,8 @@ namespace LinBox
 		Sum (const Sum<Blackbox1, Blackbox2> &M) :
 			_A_ptr (M._A_ptr), _B_ptr (M._B_ptr), VD(M.VD)
 		{
-			VectorWrapper::ensureDim (_z1, _A_ptr->rowdim ());
-			VectorWrapper::ensureDim (_z2, _A_ptr->coldim ());
+			VectorWrapper::ensureDim (_z1.get(), _A_ptr->rowdim ());
+			VectorWrapper::ensureDim (_z2.get(), _A_ptr->coldim ());
 		}
 
 		/// Destructor
@@ -128,8 +129,9 @@ namespace LinBox
 		inline OutVector &apply (OutVector &y, const InVector &x) const
 		{
 			_A_ptr->apply (y, x);
-			_B_ptr->apply (_z1, x);
-			VD.addin (y, _z1);
+			typename ScratchVector<std::vector<Element> >::Guard z(_z1);
+			_B_ptr->apply (*z, x);
+			VD.addin (y, *z);
 
 			return y;
 		}
@@ -147,8 +149,9 @@ namespace LinBox
 		inline OutVector &applyTranspose (OutVector &y, const InVector &x) const
 		{
 			_A_ptr->applyTranspose (y, x);
-			_B_ptr->applyTranspose (_z2, x);
-			VD.addin (y, _z2);
+			typename ScratchVector<std::vector<Element> >::Guard z(_z2);
+			_B_ptr->applyTranspose (*z, x);
+			VD.addin (y, *z);
 
 			return y;
 		}
@@ -201,8 +204,8 @@ namespace LinBox
 		const Blackbox1       *_A_ptr;
 		const Blackbox2       *_B_ptr;
 
-		mutable std::vector<Element>  _z1;
-		mutable std::vector<Element>  _z2;
+		ScratchVector<std::vector<Element> >  _z1;
+		ScratchVector<std::vector<Element> >  _z2;
 
 		VectorDomain<Field> VD;
 	}; // template <Field, Vector> class Sum
@@ -242,8 +245,8 @@ namespace LinBox
 			linbox_check (A.coldim () == B.coldim ());
 			linbox_check (A.rowdim () == B.rowdim ());
 
-			VectorWrapper::ensureDim (_z1, A.rowdim ());
-			VectorWrapper::ensureDim (_z2, A.coldim ());
+			VectorWrapper::ensureDim (_z1.get(), A.rowdim ());
+			VectorWrapper::ensureDim (_z2.get(), A.coldim ());
 		}
 
 		/** Constructor from black box pointers.
@@ -260,8 +263,8 @@ namespace LinBox
 			linbox_check (A_data->coldim () == B_data->coldim ());
 			linbox_check (A_data->rowdim () == B_data->rowdim ());
 
-			VectorWrapper::ensureDim (_z1, A_data->rowdim ());
-			VectorWrapper::ensureDim (_z2, A_data->coldim ());
+			VectorWrapper::ensureDim (_z1.get(), A_data->rowdim ());
+			VectorWrapper::ensureDim (_z2.get(), A_data->coldim ());
 		}
 
 		/** Copy constructor.
@@ -271,8 +274,8 @@ namespace LinBox
 		SumOwner (const SumOwner<Blackbox1, Blackbox2> &M) :
 			_A_data (M._A_data), _B_data (M._B_data), VD(M.VD)
 		{
-			VectorWrapper::ensureDim (_z1, _A_data.rowdim ());
-			VectorWrapper::ensureDim (_z2, _A_data.coldim ());
+			VectorWrapper::ensureDim (_z1.get(), _A_data.rowdim ());
+			VectorWrapper::ensureDim (_z2.get(), _A_data.coldim ());
 		}
 
 		/// Destructor
@@ -293,8 +296,9 @@ namespace LinBox
 		inline OutVector &apply (OutVector &y, const InVector &x) const
 		{
 			_A_data.apply (y, x);
-			_B_data.apply (_z1, x);
-			VD.addin (y, _z1);
+			typename ScratchVector<std::vector<Element> >::Guard z(_z1);
+			_B_data.apply (*z, x);
+			VD.addin (y, *z);
 			return y;
 		}
 
@@ -311,8 +315,9 @@ namespace LinBox
 		inline OutVector &applyTranspose (OutVector &y, const InVector &x) const
 		{
 			_A_data.applyTranspose (y, x);
-			_B_data.applyTranspose (_z2, x);
-			VD.addin (y, _z2);
+			typename ScratchVector<std::vector<Element> >::Guard z(_z2);
+			_B_data.applyTranspose (*z, x);
+			VD.addin (y, *z);
 
 			return y;
 		}
@@ -333,8 +338,8 @@ namespace LinBox
 		SumOwner (const Sum<_BBt1, _BBt2> &M, const Field& F) :
 			_A_data(*(M.getLeftPtr()), F),
 			_B_data(*(M.getRightPtr()), F),
-			_z1(_A_data.rowdim()),
-			_z2(_A_data.coldim()),
+			_z1(std::vector<Element>(_A_data.rowdim())),
+			_z2(std::vector<Element>(_A_data.coldim())),
 			VD(F)
 		{
 			typename Sum<_BBt1, _BBt2>::template rebind<Field>()(*this,M);
@@ -344,8 +349,8 @@ namespace LinBox
 		SumOwner (const SumOwner<_BBt1, _BBt2> &M, const Field& F) :
 			_A_data(M.getLeftData(), F),
 			_B_data(M.getRightData(), F) ,
-			_z1(_A_data.rowdim()),
-			_z2(_A_data.coldim()) ,
+			_z1(std::vector<Element>(_A_data.rowdim())),
+			_z2(std::vector<Element>(_A_data.coldim())) ,
 			VD(F)
 		{
 			typename SumOwner<_BBt1, _BBt2>::template rebind<Field>()(*this,M);
@@ -410,12 +415,23 @@ namespace LinBox
 		Blackbox1       _A_data;
 		Blackbox2       _B_data;
 
-		mutable std::vector<Element>  _z1;
-		mutable std::vector<Element>  _z2;
+		ScratchVector<std::vector<Element> >  _z1;
+		ScratchVector<std::vector<Element> >  _z2;
 
 		VectorDomain<Field> VD;
 	}; // template <Field, Vector> class SumOwner
 
+	// reentrant when the terms are: the intermediate vectors are ScratchVectors
+	template <class Blackbox1, class Blackbox2>
+	struct is_reentrant<Sum<Blackbox1, Blackbox2> > {
+		static const bool value = is_reentrant<Blackbox1>::value && is_reentrant<Blackbox2>::value;
+	};
+
+	template <class Blackbox1, class Blackbox2>
+	struct is_reentrant<SumOwner<Blackbox1, Blackbox2> > {
+		static const bool value = is_reentrant<Blackbox1>::value && is_reentrant<Blackbox2>::value;
+	};
+
 } // namespace LinBox
 
 #endif // __LINBOX_sum_H
@@ -323,6 +323,16 @@ namespace LinBox
 
 	};
 
+	template <class Blackbox>
+	struct is_reentrant<Transpose<Blackbox> > {
+		static const bool value = is_reentrant<Blackbox>::value;
+	};
+
+	template <class Blackbox>
+	struct is_reentrant<TransposeOwner<Blackbox> > {
+		static const bool value = is_reentrant<Blackbox>::value;
+	};
+
 } // namespace LinBox
 
 
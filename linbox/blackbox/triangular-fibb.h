@@ -32,6 +32,10 @@
 #include "linbox/randiter/mersenne-twister.h"
 #include "linbox/blackbox/fibb.h"
 
+#if defined(__LINBOX_USE_OPENMP)
+#include <omp.h>
+#endif
+
 namespace LinBox
 {
 
@@ -94,19 +98,21 @@ namespace LinBox
 
 		Matrix& applyMatrix(Matrix& B, const Matrix& A, const FFLAS::FFLAS_SIDE side) const {
 			B=A;
-			FFLAS::ftrmm<Field> (field(), 
-				side,
-				FFLAS::FFLAS_UPLO(rep_->getUpLo()), //const FFLAS_UPLO Uplo,
-		    	FFLAS::FflasNoTrans, //const FFLAS_TRANSPOSE TransA,
-				FFLAS::FFLAS_DIAG(rep_->getDiag()), //const FFLAS_DIAG Diag,
-				B.rowdim(), //const size_t M,
-				B.coldim(), //const size_t N,
-				field().one, //const typename Field::Element alpha,
-				rep_->getPointer(), //typename Field::Element_ptr A,
-				rep_->getStride(), //const size_t lda,
-				B.getPointer(), //typename Field::Element_ptr B,
-				B.getStride() //const size_t ldb)
-			);
+			byBlocks(B, side, [&](size_t M, size_t N, typename Field::Element_ptr Bp) {
+				FFLAS::ftrmm<Field> (field(),
+					side,
+					FFLAS::FFLAS_UPLO(rep_->getUpLo()), //const FFLAS_UPLO Uplo,
+					FFLAS::FflasNoTrans, //const FFLAS_TRANSPOSE TransA,
+					FFLAS::FFLAS_DIAG(rep_->getDiag()), //const FFLAS_DIAG Diag,
+					M, //const size_t M,
+					N, //const size_t N,
+					field().one, //const typename Field::Element alpha,
+					rep_->getPointer(), //typename Field::Element_ptr A,
+					rep_->getStride(), //const size_t lda,
+					Bp, //typename Field::Element_ptr B,
+					B.getStride() //const size_t ldb)
+				);
+			});
 			return B;
 		}
 
@@ -193,18 +199,20 @@ namespace LinBox
 		{
 			//B.copy(A);
             B=A;
-			FFLAS::ftrsm<Field> (field(), FFLAS::FFLAS_SIDE(side),
-				FFLAS::FFLAS_UPLO(rep_->getUpLo()), //const FFLAS_UPLO Uplo,
-		    	FFLAS::FflasNoTrans, //const FFLAS_TRANSPOSE TransA,
-				FFLAS::FFLAS_DIAG(rep_->getDiag()), //const FFLAS_DIAG Diag,
-				B.rowdim(), //const size_t M,
-				B.coldim(), //const size_t N,
-				field().one, //const typename Field::Element alpha,
-				rep_->getPointer(), //typename Field::Element_ptr A,
-				rep_->getStride(), //const size_t lda,
-				B.getPointer(), //typename Field::Element_ptr B,
-				B.getStride() //const size_t ldb)
-			);
+			byBlocks(B, FFLAS::FFLAS_SIDE(side), [&](size_t M, size_t N, typename Field::Element_ptr Bp) {
+				FFLAS::ftrsm<Field> (field(), FFLAS::FFLAS_SIDE(side),
+					FFLAS::FFLAS_UPLO(rep_->getUpLo()), //const FFLAS_UPLO Uplo,
+					FFLAS::FflasNoTrans, //const FFLAS_TRANSPOSE TransA,
+					FFLAS::FFLAS_DIAG(rep_->getDiag()), //const FFLAS_DIAG Diag,
+					M, //const size_t M,
+					N, //const size_t N,
+					field().one, //const typename Field::Element alpha,
+					rep_->getPointer(), //typename Field::Element_ptr A,
+					rep_->getStride(), //const size_t lda,
+					Bp, //typename Field::Element_ptr B,
+					B.getStride() //const size_t ldb)
+				);
+			});
 			return B;
 		}
 
@@ -306,6 +314,30 @@ namespace LinBox
 			return is ;
 		}
 
+	protected:
+		/* The columns of B (side Left, T B) or its rows (side Right, B T)
+		 * are independent: kernel(M, N, p) runs on contiguous slices of them,
+		 * one per thread, each slice a BLAS-3 call of its own.
+		 */
+		template<class Kernel>
+		void byBlocks(Matrix& B, const FFLAS::FFLAS_SIDE side, Kernel kernel) const
+		{
+			bool left = (side == FFLAS::FflasLeft);
+			size_t m = B.rowdim(), n = B.coldim(), free = left ? n : m, nb = 1;
+#ifdef __LINBOX_USE_OPENMP
+			if ((left ? m : n) * free > 65536)
+				nb = std::max((size_t)1, std::min((size_t) omp_get_max_threads(), free / 32));
+#pragma omp parallel for schedule(static) if (nb > 1)
+#endif
+			for (long b = 0; b < (long) nb; ++b) {
+				size_t lo = (size_t)b * free / nb, hi = ((size_t)b + 1) * free / nb;
+				if (left)
+					kernel(m, hi - lo, B.getPointer() + lo);
+				else
+					kernel(hi - lo, n, B.getPointer() + lo * B.getStride());
+			}
+		}
+
 }; // template <Vector> class TriangularFIBB
 
 
@@ -30,9 +30,14 @@
 
 
 #include <vector>
+#include <algorithm>
 
 #include <fflas-ffpack/fflas-ffpack.h>
 
+#if defined(__LINBOX_USE_OPENMP)
+#include <omp.h>
+#endif
+
 #include "linbox/matrix/densematrix/blas-matrix.h"
 
 #include "linbox/matrix/permutation-matrix.h"
@@ -61,6 +66,13 @@ namespace LinBox
 	 * and they build a \c PLUQ factorisation of a \c BlasMatrix/\c BlasBlackbox on
 	 * a finite field.  There are methods for retrieving \p P \p L,\p U and \p Q
 	 * matrices and methods for solving systems.
+	 *
+	 * The solves with a block of right hand sides share its columns (left
+	 * solves) or rows (right solves) among the OpenMP threads. When the
+	 * factorization solves many blocks, precomputeInverse() turns these
+	 * solves into products by \f$A^{-1}\f$ (\c fgemm) instead of triangular
+	 * solves; the in place ones then reuse a workspace from call to call,
+	 * so they must not be concurrent on the same factorization.
 	 */
 	//! @bug Should really be tempalted by Matrix and be a (sub)domain
 	template <class Field>
@@ -81,6 +93,8 @@ namespace LinBox
 		size_t                 _rank;
 		bool                  _alloc;
 		bool                  _plloc;
+		std::vector<Element>    _inv;  // A^{-1} if precomputed, else empty
+		mutable std::vector<Element> _work; // for the in place solves with _inv
 
 	public:
 
@@ -182,6 +196,24 @@ namespace LinBox
 		*/
 		size_t getStride() const ;
 
+		/*! Precompute \f$A^{-1}\f$, for \c A square and invertible, so that
+		 * the solves with blocks of right hand sides are products by it.
+		 * @return false, and nothing is done, if \c A is singular.
+		 */
+		bool precomputeInverse() ;
+
+		//! is \f$A^{-1}\f$ precomputed ?
+		bool hasInverse() const ;
+
+		/*! @internal get a pointer to \f$A^{-1}\f$ (stride \c coldim()).
+		*/
+		const Element* getInverse() const ;
+
+		/*! @internal get a workspace of at least \p size elements.
+		 * It is kept for the next calls.
+		*/
+		Element* getWorkspace(size_t size) const ;
+
 		/*!
 		 * Solvers with matrices or vectors
 		 * Operand can be a BlasMatrix<Field,_Rep> or a std::vector<Element>
@@ -119,6 +119,30 @@ namespace LinBox
 		 * Solvers with Matrices: Operand= BlasMatrix<Field,_Rep>
 		 */
 
+		/*! @internal f(lo, w) on the slices [lo, lo+w) of [0, k), one per
+		 * thread when the k right hand sides of size n are many enough.
+		 * @return the largest of the \c info returned by \p f.
+		 */
+		template <class Function>
+		int solveBySlices (size_t k, size_t n, Function f)
+		{
+			size_t nb = 1;
+#ifdef __LINBOX_USE_OPENMP
+			if (k * n > 32768)
+				nb = std::max((size_t)1, std::min((size_t)omp_get_max_threads(), k / 16));
+#endif
+			int info = 0;
+#ifdef __LINBOX_USE_OPENMP
+#pragma omp parallel for schedule(static) reduction(max:info) if (nb > 1)
+#endif
+			for (long b = 0; b < (long)nb; ++b) {
+				size_t lo = (size_t)b * k / nb, hi = ((size_t)b + 1) * k / nb;
+				int i = (hi > lo) ? f(lo, hi - lo) : 0;
+				if (i > info) info = i;
+			}
+			return info;
+		}
+
 		template <class Field, class Matrix1, class Matrix2>
 		Matrix1&
 		FactorizedMatrixLeftSolve<Field,Matrix1,Matrix2>::operator() ( const Field& F,
@@ -129,18 +153,28 @@ namespace LinBox
 			linbox_check (A.coldim() == X.rowdim());
 			linbox_check (A.rowdim() == B.rowdim());
 			linbox_check (B.coldim() == X.coldim());
-			int info;
 			// we don't really need that...
 			typedef typename Matrix1::subMatrixType subMatrixType ;
 			typedef typename Matrix1::constSubMatrixType constSubMatrixType ;
 			subMatrixType X_v(X);
 			constSubMatrixType B_v(B);
-
-
-			FFPACK::fgetrs (F, FFLAS::FflasLeft, A.rowdim(), A.coldim(), B_v.coldim(), A.getRank(),
-					A.getPointer(), A.getStride(), A.getP().getPointer(), A.getQ().getPointer(),
-					X_v.getPointer(), X_v.getStride(),
-					B_v.getPointer(), B_v.getStride(), &info);
+			typename Field::Element_ptr Xp = X_v.getPointer();
+			typename Field::ConstElement_ptr Bp = B_v.getPointer();
+			size_t ldx = X_v.getStride(), ldb = B_v.getStride();
+
+			// the columns of B by slices
+			int info = solveBySlices (B_v.coldim(), A.rowdim(), [&](size_t lo, size_t w) {
+				int inf = 0;
+				if (A.hasInverse())
+					FFLAS::fgemm (F, FFLAS::FflasNoTrans, FFLAS::FflasNoTrans, A.coldim(), w, A.rowdim(),
+						      F.one, A.getInverse(), A.coldim(), Bp + lo, ldb,
+						      F.zero, Xp + lo, ldx);
+				else
+					FFPACK::fgetrs (F, FFLAS::FflasLeft, A.rowdim(), A.coldim(), w, A.getRank(),
+							A.getPointer(), A.getStride(), A.getP().getPointer(), A.getQ().getPointer(),
+							Xp + lo, ldx, Bp + lo, ldb, &inf);
+				return inf;
+			});
 			if (info > 0)
 				throw LinboxMathInconsistentSystem ("Linear system is inconsistent");
 
@@ -154,18 +188,31 @@ namespace LinBox
 									 Matrix1& B ) const
 		{
 
-			int info;
 			linbox_check (A.coldim() == A.rowdim());
 			linbox_check (A.coldim() == B.rowdim());
 
 			typedef typename Matrix1::subMatrixType subMatrixType ;
 			subMatrixType B_v(B);
-
-
-			FFPACK::fgetrs (F, FFLAS::FflasLeft, B_v.rowdim(), B_v.coldim(), A.getRank(),
-					A.getPointer(), A.getStride(),
-					A.getP().getPointer(), A.getQ().getPointer(),
-					B_v.getPointer(), B_v.getStride(), &info);
+			typename Field::Element_ptr Bp = B_v.getPointer();
+			size_t n = B_v.rowdim(), k = B_v.coldim(), ldb = B_v.getStride();
+			typename Field::Element_ptr W = A.hasInverse() ? A.getWorkspace(n * k) : NULL;
+
+			// the columns of B by slices, through W with the inverse
+			int info = solveBySlices (k, n, [&](size_t lo, size_t w) {
+				int inf = 0;
+				if (A.hasInverse()) {
+					FFLAS::fgemm (F, FFLAS::FflasNoTrans, FFLAS::FflasNoTrans, n, w, n,
+						      F.one, A.getInverse(), n, Bp + lo, ldb,
+						      F.zero, W + lo, k);
+					FFLAS::fassign (F, n, w, W + lo, k, Bp + lo, ldb);
+				}
+				else
+					FFPACK::fgetrs (F, FFLAS::FflasLeft, n, w, A.getRank(),
+							A.getPointer(), A.getStride(),
+							A.getP().getPointer(), A.getQ().getPointer(),
+							Bp + lo, ldb, &inf);
+				return inf;
+			});
 			if (info > 0)
 				throw LinboxMathInconsistentSystem ("Linear system is inconsistent");
 
@@ -183,20 +230,32 @@ namespace LinBox
 			linbox_check (A.rowdim() == X.coldim());
 			linbox_check (A.coldim() == B.coldim());
 			linbox_check (B.rowdim() == X.rowdim());
-			int info;
 			typedef typename Matrix1::subMatrixType subMatrixType ;
 			typedef typename Matrix1::constSubMatrixType constSubMatrixType ;
 			subMatrixType X_v(X);
 			constSubMatrixType B_v(B);
-
-			FFPACK::fgetrs (F, FFLAS::FflasRight, A.rowdim(), A.coldim(), B_v.rowdim(), A.getRank(),
-                            A.getPointer(), A.getStride(),
-                            A.getP().getPointer(), A.getQ().getPointer(),
-                            X_v.getPointer(), X_v.getStride(),
-                            B_v.getPointer(), B_v.getStride(), &info);
+			typename Field::Element_ptr Xp = X_v.getPointer();
+			typename Field::ConstElement_ptr Bp = B_v.getPointer();
+			size_t ldx = X_v.getStride(), ldb = B_v.getStride();
+
+			// the rows of B by slices
+			int info = solveBySlices (B_v.rowdim(), A.coldim(), [&](size_t lo, size_t w) {
+				int inf = 0;
+				if (A.hasInverse())
+					FFLAS::fgemm (F, FFLAS::FflasNoTrans, FFLAS::FflasNoTrans, w, A.rowdim(), A.coldim(),
+						      F.one, Bp + lo * ldb, ldb, A.getInverse(), A.coldim(),
+						      F.zero, Xp + lo * ldx, ldx);
+				else
+					FFPACK::fgetrs (F, FFLAS::FflasRight, A.rowdim(), A.coldim(), w, A.getRank(),
+							A.getPointer(), A.getStride(),
+							A.getP().getPointer(), A.getQ().getPointer(),
+							Xp + lo * ldx, ldx,
+							Bp + lo * ldb, ldb, &inf);
+				return inf;
+			});
 			if (info > 0)
 				throw LinboxMathInconsistentSystem ("Linear system is inconsistent");
-            
+
 			return X;
 		}
 
@@ -207,16 +266,30 @@ namespace LinBox
 										Matrix1& B ) const
 		{
 
-			int info;
 			linbox_check (A.coldim() == A.rowdim());
 			linbox_check (A.rowdim() == B.coldim());
 			typedef typename Matrix1::subMatrixType subMatrixType ;
 			subMatrixType B_v(B);
-
-			FFPACK::fgetrs (F, FFLAS::FflasRight, B_v.rowdim(), B_v.coldim(), A.getRank(),
-                            A.getPointer(), A.getStride(),
-                            A.getP().getPointer(), A.getQ().getPointer(),
-                            B_v.getPointer(), B_v.getStride(), &info);
+			typename Field::Element_ptr Bp = B_v.getPointer();
+			size_t m = B_v.rowdim(), n = B_v.coldim(), ldb = B_v.getStride();
+			typename Field::Element_ptr W = A.hasInverse() ? A.getWorkspace(m * n) : NULL;
+
+			// the rows of B by slices, through W with the inverse
+			int info = solveBySlices (m, n, [&](size_t lo, size_t w) {
+				int inf = 0;
+				if (A.hasInverse()) {
+					FFLAS::fgemm (F, FFLAS::FflasNoTrans, FFLAS::FflasNoTrans, w, n, n,
+						      F.one, Bp + lo * ldb, ldb, A.getInverse(), n,
+						      F.zero, W + lo * n, n);
+					FFLAS::fassign (F, w, n, W + lo * n, n, Bp + lo * ldb, ldb);
+				}
+				else
+					FFPACK::fgetrs (F, FFLAS::FflasRight, w, n, A.getRank(),
+							A.getPointer(), A.getStride(),
+							A.getP().getPointer(), A.getQ().getPointer(),
+							Bp + lo * ldb, ldb, &inf);
+				return inf;
+			});
 			if (info > 0)
 				throw LinboxMathInconsistentSystem ("Linear system is inconsistent");
 
@@ -1310,6 +1383,48 @@ namespace LinBox
 		return _factLU.getStride();
 	}
 
+	template <class Field>
+	bool PLUQMatrix<Field>::precomputeInverse()
+	{
+		if (_m != _n || _rank != _n)
+			return false;
+		if (_inv.size())
+			return true;
+		// A^{-1} = A \ I, by slices of columns of I
+		std::vector<Element> inv(_n * _n, _field.zero);
+		for (size_t i = 0; i < _n; ++i)
+			_field.assign(inv[i * _n + i], _field.one);
+		Protected::solveBySlices (_n, _n, [&](size_t lo, size_t w) {
+			int info = 0;
+			FFPACK::fgetrs (_field, FFLAS::FflasLeft, _n, w, _rank,
+					getPointer(), getStride(), _permP.getPointer(), _permQ.getPointer(),
+					inv.data() + lo, _n, &info);
+			return info;
+		});
+		_inv.swap(inv);
+		return true;
+	}
+
+	template <class Field>
+	bool PLUQMatrix<Field>::hasInverse() const
+	{
+		return _inv.size() != 0;
+	}
+
+	template <class Field>
+	const typename Field::Element* PLUQMatrix<Field>::getInverse() const
+	{
+		return _inv.data();
+	}
+
+	template <class Field>
+	typename Field::Element* PLUQMatrix<Field>::getWorkspace(size_t size) const
+	{
+		if (_work.size() < size)
+			_work.resize(size);
+		return _work.data();
+	}
+
 	// solve AX=B
 	template <class Field>
 	template <class Operand>
@@ -336,6 +336,7 @@ namespace LinBox
 
 			D=C;
 
+			LINBOX_PERF_SCOPE("fgemm");
 			FFLAS::fgemm( C.field(), FFLAS::FflasNoTrans, FFLAS::FflasNoTrans,
 				     C.rowdim(), C.coldim(), A.coldim(),
 				     alpha,
@@ -359,6 +360,7 @@ namespace LinBox
 			linbox_check( C.rowdim() == A.rowdim());
 			linbox_check( C.coldim() == B.coldim());
 
+			LINBOX_PERF_SCOPE("fgemm");
 			FFLAS::fgemm( C.field(), FFLAS::FflasNoTrans, FFLAS::FflasNoTrans,
 				     C.rowdim(), C.coldim(), A.coldim(),
 				     alpha,
@@ -403,6 +405,7 @@ namespace LinBox
 			constSubMatrixType C_v(C);
 			subMatrixType D_v(D);
 
+            LINBOX_PERF_SCOPE("fgemm");
             FFLAS::fgemm( C.field(), FFLAS::FflasNoTrans, FFLAS::FflasNoTrans,
                           C_v.rowdim(), C_v.coldim(), A_v.coldim(),
                           alpha,
@@ -429,6 +432,7 @@ namespace LinBox
 			constSubMatrixType B_v(B);
 			subMatrixType C_v(C);
 
+			LINBOX_PERF_SCOPE("fgemm");
 			FFLAS::fgemm( C.field(), FFLAS::FflasNoTrans, FFLAS::FflasNoTrans,
 				     C_v.rowdim(), C_v.coldim(), A_v.coldim(),
 				     alpha,
@@ -464,6 +468,7 @@ namespace LinBox
 
 			D.copy(C);
 
+			LINBOX_PERF_SCOPE("fgemm");
 			FFLAS::fgemm( C.field(), FFLAS::FflasNoTrans, FFLAS::FflasNoTrans,
 				     C.rowdim(), C.coldim(), A.coldim(),
 				     alpha,
@@ -486,6 +491,7 @@ namespace LinBox
 			linbox_check( C.rowdim() == A.rowdim());
 			linbox_check( C.coldim() == B.coldim());
 
+			LINBOX_PERF_SCOPE("fgemm");
 			FFLAS::fgemm( C.field(), FFLAS::FflasNoTrans, FFLAS::FflasNoTrans,
 				     C.rowdim(), C.coldim(), A.coldim(),
 				     alpha,
@@ -517,6 +523,7 @@ namespace LinBox
 
 			D.copy(C);
 
+			LINBOX_PERF_SCOPE("fgemm");
 			FFLAS::fgemm( C.field(), FFLAS::FflasNoTrans, FFLAS::FflasNoTrans,
 				     C.rowdim(), C.coldim(), A.coldim(),
 				     alpha,
@@ -539,6 +546,7 @@ namespace LinBox
 			linbox_check( C.rowdim() == A.rowdim());
 			linbox_check( C.coldim() == B.coldim());
 
+			LINBOX_PERF_SCOPE("fgemm");
 			FFLAS::fgemm( C.field(), FFLAS::FflasNoTrans, FFLAS::FflasNoTrans,
 				     C.rowdim(), C.coldim(), A.coldim(),
 				     alpha,
@@ -570,6 +578,7 @@ namespace LinBox
 
 			D=C;
 
+			LINBOX_PERF_SCOPE("fgemm");
 			FFLAS::fgemm( B.field(), FFLAS::FflasTrans, FFLAS::FflasNoTrans,
 				     C.rowdim(), C.coldim(), B.rowdim(),
 				     alpha,
@@ -593,6 +602,7 @@ namespace LinBox
 			linbox_check( C.rowdim() == A.getMatrix().coldim());
 			linbox_check( C.coldim() == B.coldim());
 
+			LINBOX_PERF_SCOPE("fgemm");
 			FFLAS::fgemm( B.field(), FFLAS::FflasTrans, FFLAS::FflasNoTrans,
 				     C.rowdim(), C.coldim(), B.rowdim(),
 				     alpha,
@@ -623,6 +633,7 @@ namespace LinBox
 
 			D=C;
 
+			LINBOX_PERF_SCOPE("fgemm");
 			FFLAS::fgemm( C.field(), FFLAS::FflasTrans, FFLAS::FflasTrans,
 				     C.rowdim(), C.coldim(), A.getMatrix().rowdim(),
 				     alpha,
@@ -645,6 +656,7 @@ namespace LinBox
 			linbox_check( C.rowdim() == A.getMatrix().coldim());
 			linbox_check( C.coldim() == B.getMatrix().rowdim());
 
+			LINBOX_PERF_SCOPE("fgemm");
 			FFLAS::fgemm( C.field(), FFLAS::FflasTrans, FFLAS::FflasTrans,
 				     C.rowdim(), C.coldim(), A.getMatrix().rowdim(),
 				     alpha,
@@ -674,6 +686,7 @@ namespace LinBox
 			linbox_check( D.coldim() == C.coldim());
 
 			D=C;
+			LINBOX_PERF_SCOPE("fgemm");
 			FFLAS::fgemm( C.field(), FFLAS::FflasNoTrans, FFLAS::FflasTrans,
 				     C.rowdim(), C.coldim(), A.coldim(),
 				     alpha,
@@ -696,6 +709,7 @@ namespace LinBox
 			linbox_check( C.rowdim() == A.rowdim());
 			linbox_check( C.coldim() == B.getMatrix().rowdim());
 
+			LINBOX_PERF_SCOPE("fgemm");
 			FFLAS::fgemm( C.field(), FFLAS::FflasNoTrans, FFLAS::FflasTrans,
 				     C.rowdim(), C.coldim(), A.coldim(),
 				     alpha,
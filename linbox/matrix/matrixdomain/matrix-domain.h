@@ -45,12 +45,19 @@
 #include <linbox/linbox-config.h>
 #include <iostream>
 #include <vector>
+#include <algorithm>
+#include <type_traits>
 
 #include "linbox/blackbox/archetype.h"
+#include "linbox/blackbox/blackbox-interface.h"
 #include "linbox/matrix/matrix-traits.h"
 
 #include "linbox/vector/blas-vector.h"
 
+#if defined(__LINBOX_USE_OPENMP)
+#include <omp.h>
+#endif
+
 namespace LinBox
 {
 
@@ -537,7 +544,11 @@ namespace LinBox
 		/** Matrix-black box left-multiply
 		 * C <- A * B.
 		 *
-		 * Both C and B must support column iterators
+		 * Both C and B must support column iterators.
+		 * A block blackbox (see is_blockbb) does it with its applyLeft.
+		 * Otherwise each column of C is an apply of A; for a reentrant
+		 * blackbox (see is_reentrant) the columns are shared among the
+		 * threads by batches, each thread with its own scratch vectors.
 		 *
 		 * @param C Output matrix
 		 * @param A Black box for A
@@ -549,7 +560,9 @@ namespace LinBox
 		/** Matrix-black box right-multiply
 		 * C <- A * B.
 		 *
-		 * Both C and A must support row iterators
+		 * Both C and A must support row iterators.
+		 * As blackboxMulLeft, with applyRight of a block blackbox B, or an
+		 * applyTranspose of B for each row of C.
 		 *
 		 * @param C Output matrix
 		 * @param A Matrix A
@@ -615,6 +628,11 @@ namespace LinBox
 		}
 	protected:
 
+		// *i = f(*j) for the k vectors from i and j, of dimensions m and n
+		template <class OutIterator, class InIterator, class Apply>
+		void applyByBatches (OutIterator i, InIterator j, size_t k, size_t m, size_t n,
+				     bool reentrant, const Apply &f) const;
+
 		// Specialized function implementations
 		template <class Matrix1, class Matrix2> Matrix1 &copyRow (Matrix1 &B, const Matrix2 &A) const;
 		template <class Matrix1, class Matrix2> Matrix1 &copyCol (Matrix1 &B, const Matrix2 &A) const;
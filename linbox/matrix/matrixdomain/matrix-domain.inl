@@ -1001,6 +1001,78 @@ namespace LinBox
 		return y;
 	}
 
+	namespace Protected {
+		// the vector applies of a blackbox, as function objects
+		template <class Blackbox>
+		struct BlackboxApply {
+			const Blackbox &_A;
+			BlackboxApply (const Blackbox &A) : _A(A) {}
+			template <class Vector1, class Vector2>
+			Vector1 &operator() (Vector1 &y, const Vector2 &x) const { return _A.apply (y, x); }
+		};
+
+		template <class Blackbox>
+		struct BlackboxApplyTranspose {
+			const Blackbox &_A;
+			BlackboxApplyTranspose (const Blackbox &A) : _A(A) {}
+			template <class Vector1, class Vector2>
+			Vector1 &operator() (Vector1 &y, const Vector2 &x) const { return _A.applyTranspose (y, x); }
+		};
+
+		// C = A B and C = B A by the block applies of A, when it has them
+		template <class Matrix1, class Blackbox, class Matrix2>
+		struct BlackboxMulHelper {
+			static const bool block = is_blockbb<Blackbox>::value && std::is_same<Matrix1, Matrix2>::value;
+
+			template <class MD>
+			static bool left (const MD &, Matrix1 &C, const Blackbox &A, const Matrix2 &B,
+					  typename std::enable_if<block, MD>::type * = 0)
+			{ A.applyLeft (C, B); return true; }
+			template <class MD>
+			static bool left (const MD &, Matrix1 &, const Blackbox &, const Matrix2 &,
+					  typename std::enable_if<!block, MD>::type * = 0)
+			{ return false; }
+
+			template <class MD>
+			static bool right (const MD &, Matrix1 &C, const Blackbox &A, const Matrix2 &B,
+					   typename std::enable_if<block, MD>::type * = 0)
+			{ A.applyRight (C, B); return true; }
+			template <class MD>
+			static bool right (const MD &, Matrix1 &, const Blackbox &, const Matrix2 &,
+					   typename std::enable_if<!block, MD>::type * = 0)
+			{ return false; }
+		};
+	}
+
+	template<class Field>
+	template <class OutIterator, class InIterator, class Apply>
+	void MatrixDomain<Field>::applyByBatches (OutIterator i, InIterator j, size_t k, size_t m, size_t n,
+						  bool reentrant, const Apply &f) const
+	{
+#ifdef __LINBOX_USE_OPENMP
+		size_t nb = reentrant ? std::min ((size_t) omp_get_max_threads (), k) : 1;
+		if (nb > 1) {
+#pragma omp parallel for schedule(static)
+			for (long b = 0; b < (long) nb; ++b) {
+				size_t lo = (size_t) b * k / nb, hi = ((size_t) b + 1) * k / nb;
+				OutIterator ib = i;
+				InIterator jb = j;
+				for (size_t c = 0; c < lo; ++c, ++ib, ++jb) ;
+				// contiguous vectors of this thread
+				DenseVector x (field (), n), y (field (), m);
+				for (size_t c = lo; c < hi; ++c, ++ib, ++jb) {
+					_VD.copy (x, *jb);
+					f (y, x);
+					_VD.copy (*ib, y);
+				}
+			}
+			return;
+		}
+#endif
+		for (size_t c = 0; c < k; ++c, ++i, ++j)
+			f (*i, *j);
+	}
+
 	template<class Field>
 	template <class Matrix1, class Blackbox, class Matrix2>
 	Matrix1 &MatrixDomain<Field>::blackboxMulLeft (Matrix1 &C, const Blackbox &A, const Matrix2 &B) const
@@ -1009,11 +1081,11 @@ namespace LinBox
 		linbox_check (A.rowdim () == C.rowdim ());
 		linbox_check (B.coldim () == C.coldim ());
 
-		typename Matrix1::ColIterator i = C.colBegin ();
-		typename Matrix2::ConstColIterator j = B.colBegin ();
+		if (Protected::BlackboxMulHelper<Matrix1, Blackbox, Matrix2>::left (*this, C, A, B))
+			return C;
 
-		for (; i != C.colEnd (); ++i, ++j)
-			A.apply (*i, *j);
+		applyByBatches (C.colBegin (), B.colBegin (), B.coldim (), A.rowdim (), A.coldim (),
+				is_reentrant<Blackbox>::value, Protected::BlackboxApply<Blackbox> (A));
 
 		return C;
 	}
@@ -1026,11 +1098,11 @@ namespace LinBox
 		linbox_check (A.rowdim () == C.rowdim ());
 		linbox_check (B.coldim () == C.coldim ());
 
-		typename Matrix1::RowIterator i = C.rowBegin ();
-		typename Matrix2::ConstRowIterator j = A.rowBegin ();
+		if (Protected::BlackboxMulHelper<Matrix1, Blackbox, Matrix2>::right (*this, C, B, A))
+			return C;
 
-		for (; i != C.rowEnd (); ++i, ++j)
-			B.applyTranspose (*i, *j);
+		applyByBatches (C.rowBegin (), A.rowBegin (), A.rowdim (), B.coldim (), B.rowdim (),
+				is_reentrant<Blackbox>::value, Protected::BlackboxApplyTranspose<Blackbox> (B));
 
 		return C;
 	}
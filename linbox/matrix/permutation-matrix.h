@@ -32,6 +32,8 @@
  * We provide a \ref LinBox::BlasPermutation class that stores the
  * permutation packed in a Lapack style and a \ref LinBox::MatrixPermutation
  * class that represents a permutation naturally.  Converstions are provided.
+ * The \ref LinBox::IndexPermutation class is the one to apply a permutation
+ * many times to vectors and dense blocks.
  */
 
 #ifndef __LINBOX_matrix_permutation_H
@@ -40,6 +42,8 @@
 #include <vector>
 #include <ostream>
 
+#include "linbox/linbox-tags.h"
+
 
 // BlasPermutation
 namespace LinBox
@@ -267,6 +271,112 @@ namespace LinBox
 
 } // LinBox
 
+// IndexPermutation
+namespace LinBox
+{
+
+	/*! Permutation precomputed for its applications.
+	 * @ingroup permutation
+	 *
+	 * \f$P\f$ has a 1 in the positions \f$(i, g_i)\f$: \f$y = P x\f$ is the
+	 * gather \f$y_i = x_{g_i}\f$, \f$y = P^T x\f$ the scatter
+	 * \f$y_{g_i} = x_i\f$, as for MatrixPermutation. The out of place
+	 * applications to vectors and dense blocks are such gathers and scatters
+	 * of entries, or of whole rows; the in place ones walk the cycles of
+	 * \f$P\f$, so that each entry moves once. The blocks are shared among
+	 * the OpenMP threads: by rows, or by slices of columns to permute the
+	 * rows in place.
+	 *
+	 * mulin() only records its factor: the factors are composed in a single
+	 * pass over the indices at their next use, and the cycles are computed
+	 * at the first in place application after a change. Then, the first
+	 * application after a change must not be concurrent. The in place
+	 * applications allocate nothing once the calling threads have their
+	 * buffer of a block row.
+	 *
+	 * The blocks are BlasMatrix like (\c getPointer(), \c getStride()).
+	 */
+	template<class _UnsignedInt = size_t>
+	class IndexPermutation {
+		typedef IndexPermutation<_UnsignedInt> Self_t ;
+	public :
+		typedef _UnsignedInt Index ;
+
+		//! identity of size \p n
+		IndexPermutation(size_t n = 0) ;
+		//! from the gather indices
+		IndexPermutation(const std::vector<_UnsignedInt> & g) ;
+		//! same permutation as \p P
+		IndexPermutation(const MatrixPermutation<_UnsignedInt> & P) ;
+		//! same permutation as \p P, of size \p n
+		IndexPermutation(const BlasPermutation<_UnsignedInt> & P, size_t n) ;
+
+		size_t getSize() const { return g_.size(); }
+		_UnsignedInt operator[] (const _UnsignedInt i) const { Compose_(); return g_[i]; }
+		const std::vector<_UnsignedInt> & getStorage() const { Compose_(); return g_; }
+
+		//! this = this Q, composed at the next use
+		Self_t & mulin(const Self_t & Q) ;
+		void Invert() ;
+		void Transpose() { Invert(); }
+
+		//! (-1)^(n - number of cycles)
+		int sign() const ;
+
+		/*! y = P x */
+		template<class OutVector, class InVector>
+		OutVector &apply (OutVector &y, const InVector &x) const ;
+		/*! y = P^T x */
+		template<class OutVector, class InVector>
+		OutVector &applyTranspose (OutVector &y, const InVector &x) const ;
+
+		/*! Y = P X, one gather of rows */
+		template<class Matrix1, class Matrix2>
+		Matrix1 &applyLeft (Matrix1 &Y, const Matrix2 &X) const ;
+		/*! Y = X P, one gather of entries by row */
+		template<class Matrix1, class Matrix2>
+		Matrix1 &applyRight (Matrix1 &Y, const Matrix2 &X) const ;
+
+		/*! x = P x or x = P^T x, in place */
+		template<class Vector>
+		Vector &applyIn (Vector &x, Tag::Transpose trans = Tag::Transpose::NoTrans) const ;
+		/*! A = P A (side Left) or A = A P (side Right), or with P^T, in place */
+		template<class Matrix>
+		Matrix &applyIn (Matrix &A, Tag::Side side, Tag::Transpose trans = Tag::Transpose::NoTrans) const ;
+
+		std::ostream & write(std::ostream & o) const ;
+
+	protected :
+		mutable std::vector<_UnsignedInt>	g_ ;      // gather indices, before the pending factors
+		mutable std::vector<std::vector<_UnsignedInt> >	pending_ ; // right factors of mulin
+		mutable std::vector<_UnsignedInt>	cycles_ ; // cycles of length > 1, one after the other
+		mutable std::vector<size_t>	        starts_ ; // start of each cycle, and the end
+		mutable bool	                    built_ ;  // are the cycles those of g_ ?
+
+		void Compose_() const { if (!pending_.empty()) ComposePending_() ; }
+		void ComposePending_() const ;
+		void BuildCycles_() const ;
+
+		// f(c, l): the cycle c[0], c[1] = g[c[0]], ..., of length l
+		template<class Function>
+		void ForCycles_(Function f) const ;
+
+		// x = P x, or x = P^T x if tr, along the cycles
+		template<class Element, class Array>
+		void WalkCycles_(Array &x, bool tr) const ;
+
+		// at least w elements, kept by the calling thread for the next calls
+		template<class Element>
+		static std::vector<Element> & Buffer_(size_t w)
+		{
+			static thread_local std::vector<Element> b ;
+			if (b.size() < w) b.resize(w) ;
+			return b ;
+		}
+	};
+
+} // LinBox
+
 
 #include "permutation-matrix.inl"
 
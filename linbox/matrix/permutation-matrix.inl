@@ -35,6 +35,10 @@
 #include <algorithm>
 #include "linbox/util/debug.h"
 
+#if defined(__LINBOX_USE_OPENMP)
+#include <omp.h>
+#endif
+
 // BlasPermutation
 namespace LinBox
 {
@@ -606,6 +610,280 @@ namespace LinBox
 
 }
 
+// IndexPermutation
+namespace LinBox
+{
+	template<class _Uint>
+	IndexPermutation<_Uint>::IndexPermutation(size_t n) :
+		g_(n), built_(false)
+	{
+		for (size_t i = 0 ; i < n ; ++i) g_[i] = (_Uint)i ;
+	}
+
+	template<class _Uint>
+	IndexPermutation<_Uint>::IndexPermutation(const std::vector<_Uint> & g) :
+		g_(g), built_(false)
+	{ }
+
+	template<class _Uint>
+	IndexPermutation<_Uint>::IndexPermutation(const MatrixPermutation<_Uint> & P) :
+		g_(P.getSize()), built_(false)
+	{
+		for (size_t i = 0 ; i < g_.size() ; ++i) g_[i] = P[(_Uint)i] ;
+	}
+
+	// the transpositions (i, P_i) applied to the identity, as in Convert.
+	template<class _Uint>
+	IndexPermutation<_Uint>::IndexPermutation(const BlasPermutation<_Uint> & P, size_t n) :
+		g_(n), built_(false)
+	{
+		for (size_t i = 0 ; i < n ; ++i) g_[i] = (_Uint)i ;
+		std::vector<_Uint> T = P.getStorage() ;
+		size_t r = std::min((size_t)P.getOrder(), T.size()) ;
+		for (size_t i = 0 ; i < r ; ++i) {
+			linbox_check((size_t)T[i] < n);
+			std::swap(g_[i], g_[(size_t)T[i]]) ;
+		}
+	}
+
+	template<class _Uint>
+	IndexPermutation<_Uint> & IndexPermutation<_Uint>::mulin(const IndexPermutation<_Uint> & Q)
+	{
+		linbox_check(Q.getSize() == getSize());
+		pending_.push_back(Q.getStorage()) ;
+		built_ = false ;
+		return *this ;
+	}
+
+	// g_i = q_k[...q_1[g_i]], all the factors for each index
+	template<class _Uint>
+	void IndexPermutation<_Uint>::ComposePending_() const
+	{
+		const size_t k = pending_.size() ;
+#ifdef __LINBOX_USE_OPENMP
+#pragma omp parallel for schedule(static) if (getSize()*k > 65536)
+#endif
+		for (long i = 0 ; i < (long)g_.size() ; ++i) {
+			_Uint j = g_[(size_t)i] ;
+			for (size_t f = 0 ; f < k ; ++f)
+				j = pending_[f][(size_t)j] ;
+			g_[(size_t)i] = j ;
+		}
+		pending_.clear() ;
+	}
+
+	template<class _Uint>
+	void IndexPermutation<_Uint>::Invert()
+	{
+		Compose_() ;
+		std::vector<_Uint> s(g_.size()) ;
+		for (size_t i = 0 ; i < g_.size() ; ++i)
+			s[(size_t)g_[i]] = (_Uint)i ;
+		g_.swap(s) ;
+		built_ = false ;
+	}
+
+	template<class _Uint>
+	void IndexPermutation<_Uint>::BuildCycles_() const
+	{
+		Compose_() ;
+		cycles_.clear() ;
+		starts_.assign(1, 0) ;
+		std::vector<bool> seen(g_.size(), false) ;
+		for (size_t i = 0 ; i < g_.size() ; ++i) {
+			if (seen[i] || (size_t)g_[i] == i)
+				continue ;
+			for (size_t j = i ; !seen[j] ; j = (size_t)g_[j]) {
+				seen[j] = true ;
+				cycles_.push_back((_Uint)j) ;
+			}
+			starts_.push_back(cycles_.size()) ;
+		}
+		built_ = true ;
+	}
+
+	template<class _Uint>
+	template<class Function>
+	void IndexPermutation<_Uint>::ForCycles_(Function f) const
+	{
+		if (!built_)
+			BuildCycles_() ;
+		for (size_t c = 0 ; c + 1 < starts_.size() ; ++c)
+			f(&cycles_[starts_[c]], starts_[c+1] - starts_[c]) ;
+	}
+
+	template<class _Uint>
+	template<class Element, class Array>
+	void IndexPermutation<_Uint>::WalkCycles_(Array &x, bool tr) const
+	{
+		ForCycles_([&](const _Uint *c, size_t l) {
+			if (!tr) {
+				// x_{c_k} = x_{c_{k+1}}
+				Element t = x[(size_t)c[0]] ;
+				for (size_t k = 0 ; k + 1 < l ; ++k)
+					x[(size_t)c[k]] = x[(size_t)c[k+1]] ;
+				x[(size_t)c[l-1]] = t ;
+			}
+			else {
+				// x_{c_{k+1}} = x_{c_k}
+				Element t = x[(size_t)c[l-1]] ;
+				for (size_t k = l-1 ; k > 0 ; --k)
+					x[(size_t)c[k]] = x[(size_t)c[k-1]] ;
+				x[(size_t)c[0]] = t ;
+			}
+		}) ;
+	}
+
+	template<class _Uint>
+	int IndexPermutation<_Uint>::sign() const
+	{
+		size_t t = 0 ;
+		ForCycles_([&](const _Uint *, size_t l) { t += l - 1 ; }) ;
+		return (t & 1) ? -1 : 1 ;
+	}
+
+	template<class _Uint>
+	template<class OutVector, class InVector>
+	OutVector &IndexPermutation<_Uint>::apply (OutVector &y, const InVector &x) const
+	{
+		linbox_check(x.size() == getSize() && y.size() == getSize());
+		Compose_() ;
+#ifdef __LINBOX_USE_OPENMP
+#pragma omp parallel for schedule(static) if (getSize() > 65536)
+#endif
+		for (long i = 0 ; i < (long)g_.size() ; ++i)
+			y[(size_t)i] = x[(size_t)g_[(size_t)i]] ;
+		return y ;
+	}
+
+	template<class _Uint>
+	template<class OutVector, class InVector>
+	OutVector &IndexPermutation<_Uint>::applyTranspose (OutVector &y, const InVector &x) const
+	{
+		linbox_check(x.size() == getSize() && y.size() == getSize());
+		Compose_() ;
+#ifdef __LINBOX_USE_OPENMP
+#pragma omp parallel for schedule(static) if (getSize() > 65536)
+#endif
+		for (long i = 0 ; i < (long)g_.size() ; ++i)
+			y[(size_t)g_[(size_t)i]] = x[(size_t)i] ;
+		return y ;
+	}
+
+	template<class _Uint>
+	template<class Matrix1, class Matrix2>
+	Matrix1 &IndexPermutation<_Uint>::applyLeft (Matrix1 &Y, const Matrix2 &X) const
+	{
+		linbox_check(X.rowdim() == getSize() && Y.rowdim() == getSize() && X.coldim() == Y.coldim());
+		Compose_() ;
+		size_t n = X.coldim(), ldx = X.getStride(), ldy = Y.getStride() ;
+#ifdef __LINBOX_USE_OPENMP
+#pragma omp parallel for schedule(static) if (getSize()*n > 32768)
+#endif
+		for (long i = 0 ; i < (long)g_.size() ; ++i) {
+			const typename Matrix2::Element *x = X.getPointer() + (size_t)g_[(size_t)i] * ldx ;
+			std::copy(x, x + n, Y.getPointer() + (size_t)i * ldy) ;
+		}
+		return Y ;
+	}
+
+	template<class _Uint>
+	template<class Matrix1, class Matrix2>
+	Matrix1 &IndexPermutation<_Uint>::applyRight (Matrix1 &Y, const Matrix2 &X) const
+	{
+		linbox_check(X.coldim() == getSize() && Y.coldim() == getSize() && X.rowdim() == Y.rowdim());
+		Compose_() ;
+		size_t n = getSize(), ldx = X.getStride(), ldy = Y.getStride() ;
+		const _Uint *g = g_.data() ;
+#ifdef __LINBOX_USE_OPENMP
+#pragma omp parallel for schedule(static) if (X.rowdim()*n > 32768)
+#endif
+		for (long r = 0 ; r < (long)X.rowdim() ; ++r) {
+			const typename Matrix2::Element *x = X.getPointer() + (size_t)r * ldx ;
+			typename Matrix1::Element *y = Y.getPointer() + (size_t)r * ldy ;
+			for (size_t i = 0 ; i < n ; ++i)
+				y[(size_t)g[i]] = x[i] ;
+		}
+		return Y ;
+	}
+
+	template<class _Uint>
+	template<class Vector>
+	Vector &IndexPermutation<_Uint>::applyIn (Vector &x, Tag::Transpose trans) const
+	{
+		linbox_check(x.size() == getSize());
+		WalkCycles_<typename Vector::value_type>(x, trans == Tag::Transpose::Trans) ;
+		return x ;
+	}
+
+	template<class _Uint>
+	template<class Matrix>
+	Matrix &IndexPermutation<_Uint>::applyIn (Matrix &A, Tag::Side side, Tag::Transpose trans) const
+	{
+		typedef typename Matrix::Element Element ;
+		size_t ld = A.getStride() ;
+		if (!built_)
+			BuildCycles_() ;
+
+		if (side == Tag::Side::Right) {
+			linbox_check(A.coldim() == getSize());
+			// each row is permuted in place as a vector by (A P)^T = P^T A^T
+			bool rt = (trans != Tag::Transpose::Trans) ;
+#ifdef __LINBOX_USE_OPENMP
+#pragma omp parallel for schedule(static) if (A.rowdim()*getSize() > 32768)
+#endif
+			for (long r = 0 ; r < (long)A.rowdim() ; ++r) {
+				Element *row = A.getPointer() + (size_t)r * ld ;
+				WalkCycles_<Element>(row, rt) ;
+			}
+			return A ;
+		}
+
+		// rows moved along the cycles, the columns by slices, one per thread
+		linbox_check(A.rowdim() == getSize());
+		bool tr = (trans == Tag::Transpose::Trans) ;
+		size_t n = A.coldim(), nb = 1 ;
+#ifdef __LINBOX_USE_OPENMP
+		if (cycles_.size() * n > 32768)
+			nb = std::max((size_t)1, std::min((size_t)omp_get_max_threads(), n / 16)) ;
+#pragma omp parallel for schedule(static) if (nb > 1)
+#endif
+		for (long b = 0 ; b < (long)nb ; ++b) {
+			size_t lo = (size_t)b * n / nb, w = ((size_t)b + 1) * n / nb - lo ;
+			std::vector<Element> &t = Buffer_<Element>(w) ;
+			Element *p = A.getPointer() + lo ;
+			for (size_t c = 0 ; c + 1 < starts_.size() ; ++c) {
+				const _Uint *cy = &cycles_[starts_[c]] ;
+				size_t l = starts_[c+1] - starts_[c] ;
+				if (!tr) {
+					std::copy(p + (size_t)cy[0] * ld, p + (size_t)cy[0] * ld + w, t.begin()) ;
+					for (size_t k = 0 ; k + 1 < l ; ++k)
+						std::copy(p + (size_t)cy[k+1] * ld, p + (size_t)cy[k+1] * ld + w, p + (size_t)cy[k] * ld) ;
+					std::copy(t.begin(), t.begin() + w, p + (size_t)cy[l-1] * ld) ;
+				}
+				else {
+					std::copy(p + (size_t)cy[l-1] * ld, p + (size_t)cy[l-1] * ld + w, t.begin()) ;
+					for (size_t k = l-1 ; k > 0 ; --k)
+						std::copy(p + (size_t)cy[k-1] * ld, p + (size_t)cy[k-1] * ld + w, p + (size_t)cy[k] * ld) ;
+					std::copy(t.begin(), t.begin() + w, p + (size_t)cy[0] * ld) ;
+				}
+			}
+		}
+		return A ;
+	}
+
+	template<class _Uint>
+	std::ostream & IndexPermutation<_Uint>::write(std::ostream & o) const
+	{
+		Compose_() ;
+		o << '[' ;
+		for (size_t i = 0 ; i < g_.size() ; ++i)
+			o << (i ? "," : "") << g_[i] ;
+		return o << ']' ;
+	}
+
+}
+
 #endif //__LINBOX_matrix_permutation_INL
 
 // Local Variables:
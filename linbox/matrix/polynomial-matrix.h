@@ -58,6 +58,72 @@ namespace LinBox{
 
 	template<typename Field> uint64_t element_storage(const Field& F)      { integer p;F.characteristic(p); return length(p);}
 	template<> uint64_t element_storage(const Givaro::Modular<Givaro::Integer> &F) { integer p;F.characteristic(p); return length(p)+sizeof(Givaro::Integer);}
+
+	// Cache-oblivious kernels to switch between polfirst and matfirst storage.
+	// The polfirst storage is seen as a (rc x s) row major matrix with leading
+	// dimension ld, the matfirst storage as s contiguous arrays of length rc.
+	// The index space is recursively halved along its largest dimension until
+	// a COPY_BLOCKSIZE x COPY_BLOCKSIZE tile is reached, hence each tile of
+	// both sides fits in L1 whatever the degree and the matrix dimension are.
+	namespace PMConvert {
+
+		// tile copy: dst[k][e] <- src[e*ld+k] for e in [e0,e1[ and k in [k0,k1[
+		// the innermost loop runs along the contiguous destination, which lets
+		// the compiler emit vector gathers for 32/64-bit elements
+		template<typename Elt>
+		inline void pol2mat_tile(Elt* const * dst, const Elt* src, size_t ld,
+					 size_t e0, size_t e1, size_t k0, size_t k1){
+			for (size_t k=k0;k<k1;k++){
+				Elt* d=dst[k];
+				const Elt* s=src+k;
+				for (size_t e=e0;e<e1;e++)
+					d[e]=s[e*ld];
+			}
+		}
+
+		// tile copy: dst[e*ld+k] <- src[k][e] for e in [e0,e1[ and k in [k0,k1[
+		template<typename Elt>
+		inline void mat2pol_tile(Elt* dst, size_t ld, const Elt* const * src,
+					 size_t e0, size_t e1, size_t k0, size_t k1){
+			for (size_t e=e0;e<e1;e++){
+				Elt* d=dst+e*ld;
+				for (size_t k=k0;k<k1;k++)
+					d[k]=src[k][e];
+			}
+		}
+
+		template<typename Elt>
+		void pol2mat(Elt* const * dst, const Elt* src, size_t ld,
+			     size_t e0, size_t e1, size_t k0, size_t k1){
+			size_t de=e1-e0, dk=k1-k0;
+			if (de<=COPY_BLOCKSIZE && dk<=COPY_BLOCKSIZE)
+				return pol2mat_tile(dst,src,ld,e0,e1,k0,k1);
+			if (de>=dk){
+				pol2mat(dst,src,ld,e0,e0+de/2,k0,k1);
+				pol2mat(dst,src,ld,e0+de/2,e1,k0,k1);
+			}
+			else {
+				pol2mat(dst,src,ld,e0,e1,k0,k0+dk/2);
+				pol2mat(dst,src,ld,e0,e1,k0+dk/2,k1);
+			}
+		}
+
+		template<typename Elt>
+		void mat2pol(Elt* dst, size_t ld, const Elt* const * src,
+			     size_t e0, size_t e1, size_t k0, size_t k1){
+			size_t de=e1-e0, dk=k1-k0;
+			if (de<=COPY_BLOCKSIZE && dk<=COPY_BLOCKSIZE)
+				return mat2pol_tile(dst,ld,src,e0,e1,k0,k1);
+			if (de>=dk){
+				mat2pol(dst,ld,src,e0,e0+de/2,k0,k1);
+				mat2pol(dst,ld,src,e0+de/2,e1,k0,k1);
+			}
+			else {
+				mat2pol(dst,ld,src,e0,e1,k0,k0+dk/2);
+				mat2pol(dst,ld,src,e0,e1,k0+dk/2,k1);
+			}
+		}
+	} // end of namespace PMConvert
 	
 	// Class for Polynomial Matrix stored as a Matrix of Polynomials
 	template<class _Field>
@@ -216,13 +282,10 @@ namespace LinBox{
 		template <size_t storage>
 		void copy(const PolynomialMatrix<PMType::matfirst,storage,Field>& M, size_t beg, size_t end){
 			//std::cout<<"copying.....matfirst to polfirst.....same field"<<std::endl;
-			const size_t ls = COPY_BLOCKSIZE;
-			for (size_t i = beg; i <= end; i+=ls)
-				for (size_t j = 0; j < _col * _row; j+=ls)
-					// Rk: the two loop must be interchanged in some cases
-					for (size_t _i = i; _i < std::min(end+1, i + ls); _i++)
-						for (size_t _j = j; _j < std::min(_col * _row, j + ls);++_j)
-							ref(_j,_i-beg)= M.get(_j,_i);
+			std::vector<const Element*> src(end-beg+1);
+			for (size_t k=beg;k<=end;k++)
+				src[k-beg]=M[k].getPointer();
+			PMConvert::mat2pol(_rep.data(),_store,src.data(),0,_row*_col,0,end-beg+1);
 		}
 
 		// copy elt from M[beg..end], _size must be >= end-beg+1
@@ -440,13 +503,10 @@ namespace LinBox{
 		// M is stored as a Matrix of Polynomials
 		void copy(const Other_t& M, size_t beg, size_t end, size_t start=0){
 			//cout<<"copying.....polfirst to matfirst.....same field"<<endl;
-			const size_t ls = COPY_BLOCKSIZE; // Loop unrooling to be more cache-friendly (cache block transposition)
-			for(size_t i = beg; i < end+1; i+=ls)
-				for (size_t j = 0; j < _col * _row; j+=ls)
-					for (size_t _i = i; _i < std::min(end+1, i + ls); _i++) {
-						for (size_t _j = j; _j < std::min(_col * _row, j + ls); _j++)
-							ref(_j,start+_i-beg) = M.get(_j,_i);
-					}
+			std::vector<Element*> dst(end-beg+1);
+			for (size_t k=beg;k<=end;k++)
+				dst[k-beg]=_rep[start+k-beg].getPointer();
+			PMConvert::pol2mat(dst.data(),M.getPointer()+beg,M.storage(),0,_row*_col,0,end-beg+1);
 		}
 
 		// copy elt from M[beg..end], _size must be >= end-beg+1
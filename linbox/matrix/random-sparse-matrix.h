@@ -0,0 +1,554 @@
+/* linbox/matrix/random-sparse-matrix.h
+ * Copyright (C) LinBox
+ *
+ * ========LICENCE========
+ * This file is part of the library LinBox.
+ *
+ * LinBox is free software: you can redistribute it and/or modify
+ * it under the terms of the  GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ * ========LICENCE========
+ */
+
+/** @file matrix/random-sparse-matrix.h
+ * @ingroup matrix
+ * @brief Structured random sparse matrices, streamed row by row.
+ *
+ * RandomSparseMatrix generates families of sparse matrices with the
+ * structures met in practice: power law row lengths, banded, block diagonal
+ * plus noise, 0/1 and 0/±1 incidence, graph Laplacians, and matrices with a
+ * prescribed rank and Smith form.
+ *
+ * Each row is computed from its own random generator, seeded by the global
+ * seed and the row index: the result only depends on the seed and the
+ * parameters, and the rows are produced in order without keeping the matrix
+ * in memory. They are handed to a sink, which can be a SparseMatrix
+ * (SparseMatrixSink) or a stream in SMS (SMSSink) or binary (BinarySparseSink)
+ * format, so that inputs with billions of nonzeros can be written directly.
+ */
+
+#ifndef __LINBOX_matrix_random_sparse_matrix_H
+#define __LINBOX_matrix_random_sparse_matrix_H
+
+#include <stdint.h>
+#include <cmath>
+#include <vector>
+#include <algorithm>
+#include <utility>
+#include <unordered_set>
+#include <ostream>
+#include <istream>
+
+#include "linbox/linbox-config.h"
+#include "linbox/integer.h"
+#include "linbox/util/debug.h"
+#include "linbox/util/error.h"
+
+namespace LinBox
+{
+	/** Counter based generator for the rows (splitmix64).
+	 * Cheap to seed, so that each row gets its own stream.
+	 */
+	class RowRandom {
+	public:
+		RowRandom (uint64_t seed, uint64_t stream = 0) : _state(seed)
+		{
+			_state = next() ^ (stream * 0xD1B54A32D192ED03ULL);
+			next();
+		}
+
+		uint64_t next ()
+		{
+			uint64_t z = (_state += 0x9E3779B97F4A7C15ULL);
+			z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+			z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+			return z ^ (z >> 31);
+		}
+
+		/// uniform in [0,bound[
+		uint64_t uniform (uint64_t bound) { return bound ? next() % bound : 0; }
+
+		/// uniform in ]0,1]
+		double unit () { return (double)((next() >> 11) + 1) * (1.0 / 9007199254740992.0); }
+
+	protected:
+		uint64_t _state;
+	};
+
+	/// Sink filling a matrix providing setEntry (e.g. SparseMatrix).
+	template<class Matrix>
+	class SparseMatrixSink {
+	public:
+		SparseMatrixSink (Matrix& A) : _A(A) {}
+
+		void begin (size_t m, size_t n)
+		{
+			linbox_check(_A.rowdim() == m && _A.coldim() == n);
+		}
+
+		template<class Row>
+		void row (size_t i, const Row& r)
+		{
+			for (typename Row::const_iterator it = r.begin(); it != r.end(); ++it)
+				_A.setEntry(i, it->first, it->second);
+		}
+
+		void end () { _A.finalize(); }
+
+	protected:
+		Matrix& _A;
+	};
+
+	/// Sink writing the SMS format ("m n M", 1-based triples, "0 0 0").
+	template<class Field>
+	class SMSSink {
+	public:
+		SMSSink (const Field& F, std::ostream& os) : _field(&F), _os(os) {}
+
+		void begin (size_t m, size_t n) { _os << m << ' ' << n << " M\n"; }
+
+		template<class Row>
+		void row (size_t i, const Row& r)
+		{
+			for (typename Row::const_iterator it = r.begin(); it != r.end(); ++it) {
+				_os << i+1 << ' ' << it->first+1 << ' ';
+				_field->write(_os, it->second) << '\n';
+			}
+		}
+
+		void end () { _os << "0 0 0" << std::endl; }
+
+	protected:
+		const Field*  _field;
+		std::ostream& _os;
+	};
+
+	/** Sink writing a compact binary format.
+	 * Header: the 8 bytes "LBXSPRS1", then the row and column dimensions as
+	 * uint64_t. Then for each nonempty row: the row index and the number of
+	 * entries as uint64_t, followed by the entries as (uint64_t column,
+	 * int64_t value) pairs. The last row index is UINT64_MAX.
+	 * The values must fit 64 bits, as is always the case over word size fields.
+	 * Integers are in the native byte order, use readBinarySparse to load.
+	 */
+	template<class Field>
+	class BinarySparseSink {
+	public:
+		BinarySparseSink (const Field& F, std::ostream& os) : _field(&F), _os(os) {}
+
+		void begin (size_t m, size_t n)
+		{
+			_os.write(binaryMagic(), 8);
+			put((uint64_t)m);
+			put((uint64_t)n);
+		}
+
+		template<class Row>
+		void row (size_t i, const Row& r)
+		{
+			if (r.empty()) return;
+			put((uint64_t)i);
+			put((uint64_t)r.size());
+			Integer v;
+			for (typename Row::const_iterator it = r.begin(); it != r.end(); ++it) {
+				_field->convert(v, it->second);
+				if (v > Integer(INT64_MAX) || v < Integer(INT64_MIN))
+					throw LinboxError("BinarySparseSink: value does not fit 64 bits");
+				put((uint64_t)it->first);
+				put((int64_t)v);
+			}
+		}
+
+		void end () { put(UINT64_MAX); _os.flush(); }
+
+		static const char* binaryMagic () { return "LBXSPRS1"; }
+
+	protected:
+		const Field*  _field;
+		std::ostream& _os;
+
+		template<class T>
+		void put (const T& x) { _os.write(reinterpret_cast<const char*>(&x), sizeof(T)); }
+	};
+
+	/** Load a matrix written by BinarySparseSink.
+	 * @param A resized to the stored dimensions, then filled with setEntry.
+	 */
+	template<class Matrix>
+	Matrix& readBinarySparse (Matrix& A, std::istream& is)
+	{
+		char magic[8];
+		uint64_t m, n, i, k, j;
+		int64_t v;
+		is.read(magic, 8);
+		if (!is || !std::equal(magic, magic+8, BinarySparseSink<typename Matrix::Field>::binaryMagic()))
+			throw LinboxError("readBinarySparse: not a binary sparse matrix");
+		is.read(reinterpret_cast<char*>(&m), sizeof(m));
+		is.read(reinterpret_cast<char*>(&n), sizeof(n));
+		A.resize((size_t)m, (size_t)n);
+		typename Matrix::Field::Element x;
+		A.field().init(x);
+		while (is.read(reinterpret_cast<char*>(&i), sizeof(i)) && i != UINT64_MAX) {
+			is.read(reinterpret_cast<char*>(&k), sizeof(k));
+			for (uint64_t e = 0; e < k; ++e) {
+				is.read(reinterpret_cast<char*>(&j), sizeof(j));
+				is.read(reinterpret_cast<char*>(&v), sizeof(v));
+				A.setEntry((size_t)i, (size_t)j, A.field().init(x, Integer(v)));
+			}
+		}
+		if (!is) throw LinboxError("readBinarySparse: truncated input");
+		A.finalize();
+		return A;
+	}
+
+	/** Generator of structured random sparse matrices.
+	 *
+	 * The random values are integers in [-bound, bound] mapped into the field,
+	 * the incidence, Laplacian and Smith form families have their own values.
+	 * Every family streams the rows in increasing order to a sink providing
+	 * <code>begin(m,n)</code>, <code>row(i,r)</code>, where r is a vector of
+	 * (column, nonzero value) sorted by column, and <code>end()</code>.
+	 */
+	template<class _Field>
+	class RandomSparseMatrix {
+	public:
+		typedef _Field                               Field;
+		typedef typename Field::Element            Element;
+		typedef std::vector<std::pair<size_t,Element> > Row;
+
+		/// @param bound the random values are in [-bound, bound]
+		RandomSparseMatrix (const Field& F, uint64_t seed, uint64_t bound = 1<<20) :
+			_field(&F), _seed(seed), _bound(bound ? bound : 1)
+		{}
+
+		const Field& field () const { return *_field; }
+
+		/** Row lengths following a power law (Pareto, exponent alpha > 1).
+		 * The columns of a row are distinct and uniformly distributed.
+		 * For alpha > 2 the average row length is about avg.
+		 */
+		template<class Sink>
+		Sink& powerLaw (Sink& S, size_t m, size_t n, double avg, double alpha = 2.5) const
+		{
+			linbox_check(alpha > 1.);
+			double xmin = (alpha > 2.) ? std::max(1., avg*(alpha-2.)/(alpha-1.)) : 1.;
+			S.begin(m, n);
+			Row r;
+			std::vector<size_t> cols;
+			for (size_t i = 0; i < m; ++i) {
+				RowRandom R(_seed, i);
+				double len = std::floor(xmin * std::pow(R.unit(), -1./(alpha-1.)));
+				size_t l = (len >= (double)n) ? n : (size_t)len;
+				distinctColumns(cols, R, n, l);
+				r.clear();
+				for (size_t k = 0; k < cols.size(); ++k)
+					push(r, cols[k], R);
+				emit(S, i, r);
+			}
+			S.end();
+			return S;
+		}
+
+		/** Banded n x n matrix, entries of the band [i-lower, i+upper] are
+		 * nonzero with probability density, the diagonal always is.
+		 */
+		template<class Sink>
+		Sink& banded (Sink& S, size_t n, size_t lower, size_t upper, double density = 1.) const
+		{
+			S.begin(n, n);
+			Row r;
+			for (size_t i = 0; i < n; ++i) {
+				RowRandom R(_seed, i);
+				r.clear();
+				size_t jmin = (i > lower) ? i-lower : 0;
+				size_t jmax = std::min(n-1, i+upper);
+				for (size_t j = jmin; j <= jmax; ++j)
+					if (j == i || R.unit() <= density)
+						pushNonZero(r, j, R);
+				emit(S, i, r);
+			}
+			S.end();
+			return S;
+		}
+
+		/** Block diagonal n x n matrix with blocks of size bs and the given
+		 * density (nonzero diagonal), plus \p noise random entries per row
+		 * anywhere in the matrix.
+		 */
+		template<class Sink>
+		Sink& blockDiagonal (Sink& S, size_t n, size_t bs, double density, size_t noise = 0) const
+		{
+			linbox_check(bs > 0);
+			S.begin(n, n);
+			Row r;
+			std::vector<size_t> cols;
+			for (size_t i = 0; i < n; ++i) {
+				RowRandom R(_seed, i);
+				r.clear();
+				size_t b0 = i - i%bs, b1 = std::min(n, b0+bs);
+				for (size_t j = b0; j < b1; ++j)
+					if (j == i || R.unit() <= density)
+						pushNonZero(r, j, R);
+				distinctColumns(cols, R, n, noise);
+				for (size_t k = 0; k < cols.size(); ++k)
+					push(r, cols[k], R);
+				emit(S, i, r);
+			}
+			S.end();
+			return S;
+		}
+
+		/** Incidence matrix: each row has \p perRow distinct columns,
+		 * with value 1, or a random sign when \p isSigned.
+		 */
+		template<class Sink>
+		Sink& incidence (Sink& S, size_t m, size_t n, size_t perRow, bool isSigned = false) const
+		{
+			S.begin(m, n);
+			Row r;
+			std::vector<size_t> cols;
+			for (size_t i = 0; i < m; ++i) {
+				RowRandom R(_seed, i);
+				distinctColumns(cols, R, n, perRow);
+				r.clear();
+				for (size_t k = 0; k < cols.size(); ++k)
+					r.push_back(std::make_pair(cols[k], (isSigned && (R.next() & 1)) ? field().mOne : field().one));
+				emit(S, i, r);
+			}
+			S.end();
+			return S;
+		}
+
+		/** Weighted Laplacian D - W of a random circulant graph on n vertices:
+		 * vertex i is adjacent to i +- o_k mod n for \p degree/2 random offsets
+		 * o_k, the symmetric weights are in [1, maxWeight] (all 1 if
+		 * \p maxWeight is 0).
+		 * It is symmetric, singular, and the rows sum to zero.
+		 */
+		template<class Sink>
+		Sink& laplacian (Sink& S, size_t n, size_t degree, uint64_t maxWeight = 1) const
+		{
+			if (maxWeight == 0) maxWeight = 1;
+			std::vector<size_t> offsets;
+			RowRandom G(_seed, UINT64_MAX);
+			if (n > 2) distinctColumns(offsets, G, (n-1)/2, std::min(degree/2, (n-1)/2));
+			for (size_t k = 0; k < offsets.size(); ++k) ++offsets[k]; // in [1, (n-1)/2]
+
+			S.begin(n, n);
+			Row r;
+			Element deg, w;
+			field().init(deg);
+			field().init(w);
+			for (size_t i = 0; i < n; ++i) {
+				r.clear();
+				field().assign(deg, field().zero);
+				for (size_t k = 0; k < offsets.size(); ++k) {
+					size_t nb[2] = { (i+offsets[k]) % n, (i+n-offsets[k]) % n };
+					// offsets are at most (n-1)/2, so all the neighbours are distinct
+					for (size_t s = 0; s < 2; ++s) {
+						uint64_t wij = 1 + edgeHash(i, nb[s]) % maxWeight;
+						field().init(w, Integer(wij));
+						field().addin(deg, w);
+						field().negin(w);
+						r.push_back(std::make_pair(nb[s], w));
+					}
+				}
+				r.push_back(std::make_pair(i, deg));
+				emit(S, i, r);
+			}
+			S.end();
+			return S;
+		}
+
+		/** n x n matrix with prescribed Smith form.
+		 * A = P (I+L) D (I+U) Q where D = diag(invariants, 0, ..., 0),
+		 * L (resp. U) is strictly lower (upper) triangular with at most
+		 * \p fill entries ±1 per row, and P, Q are affine permutations.
+		 * Over the integers the Smith form of A is D when the invariants
+		 * divide each other, over a field its rank is the number of
+		 * invariants nonzero in the field.
+		 * Rows have at most (fill+1)^2 nonzeros.
+		 */
+		template<class Sink>
+		Sink& smithForm (Sink& S, size_t n, const std::vector<Integer>& invariants, size_t fill = 2) const
+		{
+			linbox_check(invariants.size() <= n);
+			AffinePermutation P(n, _seed, 1), Q(n, _seed, 2);
+			std::vector<Element> d(invariants.size());
+			for (size_t l = 0; l < d.size(); ++l)
+				field().init(d[l], invariants[l]);
+
+			S.begin(n, n);
+			Row r, Lrow, Urow;
+			Element c;
+			field().init(c);
+			for (size_t i = 0; i < n; ++i) {
+				size_t pi = P(i);
+				r.clear();
+				// row pi of (I+L)
+				unitTriangularRow(Lrow, pi, n, fill, 3, true);
+				for (size_t a = 0; a < Lrow.size(); ++a) {
+					size_t l = Lrow[a].first;
+					if (l >= d.size() || field().isZero(d[l])) continue;
+					field().mul(c, Lrow[a].second, d[l]);
+					// row l of (I+U)
+					unitTriangularRow(Urow, l, n, fill, 4, false);
+					for (size_t b = 0; b < Urow.size(); ++b) {
+						Element e;
+						field().init(e);
+						field().mul(e, c, Urow[b].second);
+						r.push_back(std::make_pair(Q(Urow[b].first), e));
+					}
+				}
+				emit(S, i, r);
+			}
+			S.end();
+			return S;
+		}
+
+	protected:
+		const Field* _field;
+		uint64_t      _seed;
+		uint64_t     _bound;
+
+		/// i -> (a i + b) mod n with gcd(a,n) = 1, no storage.
+		class AffinePermutation {
+		public:
+			AffinePermutation (size_t n, uint64_t seed, uint64_t stream) : _n(n), _a(1), _b(0)
+			{
+				if (n < 2) return;
+				RowRandom R(seed, UINT64_MAX-stream);
+				do _a = 1 + R.uniform(n-1); while (gcd(_a, n) != 1);
+				_b = R.uniform(n);
+			}
+			size_t operator() (size_t i) const
+			{
+				if (_n < 2) return i;
+				uint64_t y = mulmod(_a, (uint64_t)i % _n, _n);
+				return (size_t)(y >= _n - _b ? y - (_n - _b) : y + _b);
+			}
+		protected:
+			uint64_t _n, _a, _b;
+			static uint64_t gcd (uint64_t a, uint64_t b) { while (b) { uint64_t t = a%b; a = b; b = t; } return a; }
+
+			// a b mod n, for a, b < n
+			static uint64_t mulmod (uint64_t a, uint64_t b, uint64_t n)
+			{
+#ifdef __SIZEOF_INT128__
+				return (uint64_t)((unsigned __int128)a * b % n);
+#else
+				// double and add, without overflow
+				uint64_t r = 0;
+				for (; b; b >>= 1) {
+					if (b & 1) r = (r >= n - a) ? r - (n - a) : r + a;
+					a = (a >= n - a) ? a - (n - a) : a + a;
+				}
+				return r;
+#endif
+			}
+		};
+
+		void randomValue (Element& x, RowRandom& R) const
+		{
+			int64_t v = (int64_t)R.uniform(2*_bound+1) - (int64_t)_bound;
+			field().init(x, Integer(v));
+		}
+
+		void push (Row& r, size_t j, RowRandom& R) const
+		{
+			Element x;
+			field().init(x);
+			randomValue(x, R);
+			r.push_back(std::make_pair(j, x));
+		}
+
+		void pushNonZero (Row& r, size_t j, RowRandom& R) const
+		{
+			Element x;
+			field().init(x);
+			do randomValue(x, R); while (field().isZero(x));
+			r.push_back(std::make_pair(j, x));
+		}
+
+		/// l distinct columns in [0,n[, sorted (Floyd's sampling).
+		static void distinctColumns (std::vector<size_t>& cols, RowRandom& R, size_t n, size_t l)
+		{
+			cols.clear();
+			l = std::min(l, n);
+			if (2*l >= n) {
+				// dense row, selection sampling
+				for (size_t j = 0; j < n && cols.size() < l; ++j)
+					if (R.uniform(n-j) < l-cols.size()) cols.push_back(j);
+				return;
+			}
+			std::unordered_set<size_t> chosen;
+			for (size_t j = n-l; j < n; ++j) {
+				size_t t = (size_t)R.uniform(j+1);
+				if (! chosen.insert(t).second) chosen.insert(t = j);
+				cols.push_back(t);
+			}
+			std::sort(cols.begin(), cols.end());
+		}
+
+		/// Row k of the unit triangular I+L (lower) or I+U (upper), ±1 entries.
+		void unitTriangularRow (Row& r, size_t k, size_t n, size_t fill, uint64_t stream, bool lower) const
+		{
+			RowRandom R(_seed ^ (stream * 0x632BE59BD9B4E019ULL), k);
+			std::vector<size_t> cols;
+			size_t span = lower ? k : n-1-k;
+			distinctColumns(cols, R, span, fill);
+			r.clear();
+			r.push_back(std::make_pair(k, field().one));
+			for (size_t a = 0; a < cols.size(); ++a)
+				r.push_back(std::make_pair(lower ? cols[a] : k+1+cols[a], (R.next() & 1) ? field().mOne : field().one));
+		}
+
+		uint64_t edgeHash (size_t i, size_t j) const
+		{
+			RowRandom R(_seed ^ ((uint64_t)std::min(i,j) * 0x9E3779B97F4A7C15ULL), std::max(i,j));
+			return R.next();
+		}
+
+		/// Sort by column, merge the duplicates, drop the zeros, and hand over.
+		template<class Sink>
+		void emit (Sink& S, size_t i, Row& r) const
+		{
+			std::sort(r.begin(), r.end(),
+				  [](const std::pair<size_t,Element>& a, const std::pair<size_t,Element>& b) { return a.first < b.first; });
+			size_t k = 0;
+			for (size_t a = 0; a < r.size(); ++a) {
+				if (k > 0 && r[k-1].first == r[a].first)
+					field().addin(r[k-1].second, r[a].second);
+				else
+					r[k++] = r[a];
+			}
+			r.resize(k);
+			k = 0;
+			for (size_t a = 0; a < r.size(); ++a)
+				if (! field().isZero(r[a].second)) r[k++] = r[a];
+			r.resize(k);
+			S.row(i, r);
+		}
+	};
+
+} // namespace LinBox
+
+#endif // __LINBOX_matrix_random_sparse_matrix_H
+
+// Local Variables:
+// mode: C++
+// tab-width: 4
+// indent-tabs-mode: nil
+// c-basic-offset: 4
+// End:
+// vim:sts=4:sw=4:ts=4:et:sr:cino=>s,f0,{0,g0,(0,\:0,t0,+0,=s
@@ -38,6 +38,7 @@
 
 #include "linbox/linbox-config.h"
 #include "linbox/util/debug.h"
+#include "linbox/util/perf-counters.h"
 #include "linbox/field/hom.h"
 #include "sparse-domain.h"
 #include "givaro/zring.h"
@@ -822,6 +823,7 @@ namespace LinBox {
 		template<class inVector, class outVector>
 		outVector& apply(outVector &y, const inVector& x, const Element & a ) const
 		{
+			LINBOX_PERF_SCOPE("sparse apply");
 			// linbox_check(consistent());
 			prepare(field(),y,a);
 
@@ -697,6 +697,17 @@ namespace LinBox
 	} ; // SparseMatrix
 
 
+#ifndef __LINBOX_PARALLEL
+	// the applies only read the rows. With __LINBOX_PARALLEL they go through
+	// BlackboxParallel instead, which fills the sub_list of sub-blackboxes of
+	// the matrix at its first call and runs its own threads on them: two
+	// concurrent applies would build and share that list.
+	template <class Field>
+	struct is_reentrant<SparseMatrix<Field, SparseMatrixFormat::SparseSeq> > {
+		static const bool value = true;
+	};
+#endif
+
 } // namespace LinBox
 
 #endif // __LINBOX_matrix_sparsematrix_sparse_sequence_vector_H
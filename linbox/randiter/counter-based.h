@@ -0,0 +1,226 @@
+/* linbox/randiter/counter-based.h
+ * Copyright (C) LinBox
+ *
+ * ========LICENCE========
+ * This file is part of the library LinBox.
+ *
+ * LinBox is free software: you can redistribute it and/or modify
+ * it under the terms of the  GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.	 See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ * ========LICENCE========
+ */
+
+/*! @file randiter/counter-based.h
+ * @ingroup randiter
+ * @brief Counter-based random generator, random access and thread count independent.
+ */
+
+#ifndef __LINBOX_randiter_counter_based_H
+#define __LINBOX_randiter_counter_based_H
+
+#include <cstdint>
+#include <ctime>
+
+#include "linbox/linbox-config.h"
+#include "linbox/integer.h"
+
+#if defined(__LINBOX_USE_OPENMP)
+#include <omp.h>
+#endif
+
+namespace LinBox
+{
+
+	/** Philox4x32-10 block function (Salmon et al., SC 2011).
+	 *
+	 * Four random 32 bits words as a function of a 128 bits counter and a
+	 * 64 bits key: ten rounds of multiplications and xors, no state. Any
+	 * block can be computed independently, the random stream of a key can
+	 * thus be split among threads or jumped into at no cost.
+	 */
+	struct Philox4x32 {
+		struct Block {
+			uint32_t v[4];
+			uint64_t word(int k) const { return ((uint64_t) v[2*k+1] << 32) | v[2*k]; }
+		};
+
+		/// Block of index (lo, hi) of the stream of key \p key.
+		static Block block(uint64_t key, uint64_t lo, uint64_t hi = 0)
+		{
+			Block c;
+			c.v[0] = (uint32_t) lo; c.v[1] = (uint32_t) (lo >> 32);
+			c.v[2] = (uint32_t) hi; c.v[3] = (uint32_t) (hi >> 32);
+			uint32_t k0 = (uint32_t) key, k1 = (uint32_t) (key >> 32);
+			for (int r = 0; r < 10; ++r) {
+				uint64_t p0 = (uint64_t) 0xD2511F53U * c.v[0];
+				uint64_t p1 = (uint64_t) 0xCD9E8D57U * c.v[2];
+				uint32_t x0 = (uint32_t) (p1 >> 32) ^ c.v[1] ^ k0;
+				uint32_t x2 = (uint32_t) (p0 >> 32) ^ c.v[3] ^ k1;
+				c.v[0] = x0; c.v[1] = (uint32_t) p1;
+				c.v[2] = x2; c.v[3] = (uint32_t) p0;
+				k0 += 0x9E3779B9U; k1 += 0xBB67AE85U;
+			}
+			return c;
+		}
+	};
+
+	/** Random element generator from a counter-based generator.
+	 *
+	 * The element of index \f$i\f$ of the stream of a seed is a function of
+	 * \f$(seed, i)\f$ only: the first candidate below the sampling size drawn
+	 * from the Philox blocks \f$(i, 0), (i, 1), \ldots\f$, with four 32 bits
+	 * or two 64 bits candidates per block (rejection sampling, so that every
+	 * value is equally likely). random() returns the elements in the order of
+	 * their indices, seek() jumps to any index, and fill() / fillMatrix()
+	 * give the consecutive elements to the entries of a vector or a matrix
+	 * in row major order, shared among the OpenMP threads: the result is the
+	 * same for any number of threads, and the same as with random().
+	 *
+	 * The elements are \c F.init of integers in [0, size), uniform on the
+	 * field when this is a bijection, as for prime fields. The sampling size
+	 * defaults to the cardinality, it must be below \f$2^{63}\f$.
+	 */
+	template <class _Field>
+	class CounterRandIter {
+	public:
+		typedef _Field                    Field;
+		typedef typename Field::Element   Element;
+
+		/** Constructor.
+		 * @param F field
+		 * @param seed key of the stream, 0 for a seed from the clock
+		 * @param size sampling size, 0 for the cardinality of F
+		 */
+		CounterRandIter(const Field &F, uint64_t seed = 0, uint64_t size = 0) :
+			_field(&F), _seed(seed ? seed : (uint64_t) time(NULL)), _pos(0)
+		{
+			if (size == 0) {
+				integer card;
+				F.cardinality(card);
+				if (card > 0 && card < integer((uint64_t) 1 << 63))
+					size = (uint64_t) card;
+			}
+			_size = size;
+			_mask = 0;
+			while (_mask < _size - 1 || _size == 0) {
+				_mask = (_mask << 1) | 1;
+				if (_mask == UINT64_MAX) break;
+			}
+		}
+
+		const Field& ring() const { return *_field; }
+		const Field& field() const { return *_field; }
+		uint64_t seed() const { return _seed; }
+
+		/// Index of the next element of random().
+		uint64_t tell() const { return _pos; }
+
+		/// Make the element of index \p i the next one.
+		void seek(uint64_t i) { _pos = i; }
+
+		/// Next element.
+		Element& random(Element &a) const
+		{
+			return element(a, _pos++);
+		}
+
+		Element& operator() (Element &a) const
+		{
+			return random(a);
+		}
+
+		/// Element of index \p i, without moving the stream.
+		Element& element(Element &a, uint64_t i) const
+		{
+			return field().init(a, draw(i));
+		}
+
+		/// The next v.size() elements into v.
+		template <class Vector>
+		Vector& fill(Vector &v) const
+		{
+			uint64_t base = _pos;
+			_pos += v.size();
+#ifdef __LINBOX_USE_OPENMP
+#pragma omp parallel for schedule(static) if (v.size() > 4096)
+#endif
+			for (long k = 0; k < (long) v.size(); ++k)
+				element(v[(size_t)k], base + (uint64_t)k);
+			return v;
+		}
+
+		/// The next m n elements into the entries of A, row after row.
+		template <class Matrix>
+		Matrix& fillMatrix(Matrix &A) const
+		{
+			uint64_t base = _pos;
+			size_t m = A.rowdim(), n = A.coldim();
+			_pos += (uint64_t) m * n;
+			Element *p = A.getPointer();
+			size_t ld = A.getStride();
+#ifdef __LINBOX_USE_OPENMP
+#pragma omp parallel for schedule(static) if (m*n > 4096)
+#endif
+			for (long i = 0; i < (long) m; ++i) {
+				Element *r = p + (size_t)i * ld;
+				uint64_t k = base + (uint64_t)i * n;
+				for (size_t j = 0; j < n; ++j)
+					element(r[j], k + j);
+			}
+			return A;
+		}
+
+	protected:
+		// the first candidate below _size of the blocks of index i
+		uint64_t draw(uint64_t i) const
+		{
+			for (uint64_t t = 0; ; ++t) {
+				Philox4x32::Block b = Philox4x32::block(_seed, i, t);
+				if (_size == 0)
+					return b.word(0);
+				if (_mask <= UINT32_MAX) {
+					for (int k = 0; k < 4; ++k)
+						if ((b.v[k] & _mask) < _size)
+							return b.v[k] & _mask;
+				}
+				else
+					for (int k = 0; k < 2; ++k)
+						if ((b.word(k) & _mask) < _size)
+							return b.word(k) & _mask;
+			}
+		}
+
+		const Field       *_field;
+		uint64_t           _seed;
+		uint64_t           _size, _mask;
+		mutable uint64_t   _pos;
+	}; // class CounterRandIter
+
+	/// v gets the next elements of r, in parallel (see RandomDenseStream).
+	template <class Field, class Vector>
+	Vector& randomFill(CounterRandIter<Field> &r, Vector &v)
+	{
+		return r.fill(v);
+	}
+
+} // namespace LinBox
+
+#endif // __LINBOX_randiter_counter_based_H
+
+// Local Variables:
+// mode: C++
+// tab-width: 4
+// indent-tabs-mode: nil
+// c-basic-offset: 4
+// End:
+// vim:sts=4:sw=4:ts=4:et:sr:cino=>s,f0,{0,g0,(0,\:0,t0,+0,=s
@@ -0,0 +1,451 @@
+/* linbox/randiter/sieve-prime.h
+ * Copyright (C) LinBox
+ *
+ * ========LICENCE========
+ * This file is part of the library LinBox.
+ *
+ * LinBox is free software: you can redistribute it and/or modify
+ * it under the terms of the  GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.	 See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ * ========LICENCE========
+ */
+
+/*! @file randiter/sieve-prime.h
+ * @ingroup randiter
+ * @brief Batches of word size primes from a segmented sieve.
+ *
+ * Instead of testing random candidates one at a time, PrimeBatchSource
+ * sieves whole segments of the window [2^(bits-1), 2^bits[ (or of the
+ * progression 1 + 2^k m for FFT friendly primes) and hands out the primes
+ * of a segment at once. The segments are claimed with an atomic counter,
+ * so that several SievePrimeIterator sharing a source get disjoint batches
+ * without any lock: the primes are never repeated, and the CRA loops can
+ * skip their coprimality checks.
+ *
+ * The order of the segments (and of the primes inside them) is either
+ * deterministic, from the largest prime down, or a permutation fixed by the
+ * seed: a given seed always yields the same primes. Once all the batches of
+ * a source are handed out, the iterators go on with the primes of the next
+ * bit size. Prime tables can also be saved and loaded, see writePrimeTable
+ * and readPrimeTable.
+ */
+
+#ifndef __LINBOX_sieve_prime_H
+#define __LINBOX_sieve_prime_H
+
+#include <stdint.h>
+#include <vector>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <algorithm>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <cmath>
+#include <type_traits>
+
+#include "linbox/linbox-config.h"
+#include "linbox/integer.h"
+#include "linbox/util/debug.h"
+#include "linbox/util/error.h"
+#include "linbox/util/timer.h"
+#include "linbox/randiter/random-prime.h"
+
+namespace LinBox
+{
+	/*! @brief Shared, lock free source of batches of primes of a given bit size.
+	 * @ingroup primes
+	 */
+	class PrimeBatchSource {
+	public:
+		/*! Sieve mode.
+		 * @param bits size of the primes, between 3 and 63.
+		 * @param seed 0 for the deterministic decreasing order, otherwise the
+		 * seed of the order of the segments.
+		 * @param fft if nonzero, only primes p with 2^fft dividing p-1.
+		 * @param segment number of candidates sieved at once.
+		 */
+		PrimeBatchSource (uint64_t bits, uint64_t seed = 0, uint64_t fft = 0, uint64_t segment = 1<<15) :
+			_bits(bits), _seed(seed), _claimed(0)
+		{
+			if (bits < 3 || bits > 63)
+				throw LinboxError("PrimeBatchSource: bit size must be in [3,63]");
+			_log2step = std::max<uint64_t>(fft, 1);
+			if (_log2step >= bits-1)
+				throw LinboxError("PrimeBatchSource: no FFT prime of this size");
+			// candidates 1 + 2^k m for m in [_mlo, _mhi[, all of bit size bits
+			uint64_t lo = uint64_t(1) << (bits-1), hi = uint64_t(1) << bits;
+			_mlo = (lo - 1 + (uint64_t(1) << _log2step) - 1) >> _log2step;
+			_mhi = (hi - 2) >> _log2step; // 1 + 2^k m <= hi-1
+			++_mhi;
+			_seglen = std::max<uint64_t>(64, segment);
+			_nbseg = (_mhi - _mlo + _seglen - 1) / _seglen;
+			initSmallPrimes();
+			initOrder();
+		}
+
+		/*! Table mode: the primes of \p table, in order, by chunks. */
+		PrimeBatchSource (const std::vector<uint64_t>& table, uint64_t chunk = 256) :
+			_bits(0), _seed(0), _log2step(1), _mlo(0), _mhi(0), _a(1), _b(0), _claimed(0), _table(table), _complete(true)
+		{
+			_seglen = std::max<uint64_t>(1, chunk);
+			_nbseg = (_table.size() + _seglen - 1) / _seglen;
+			for (size_t i = 0; i < _table.size(); ++i)
+				_bits = std::max<uint64_t>(_bits, bitLength(_table[i] | 1));
+		}
+
+		uint64_t bits () const { return _bits; }
+
+		/// Number of batches, i.e. segments or chunks.
+		uint64_t size () const { return _nbseg; }
+
+		/*! Claims the next batch, safe to call from several threads.
+		 * @return false when all the batches have been handed out.
+		 */
+		bool nextBatch (std::vector<uint64_t>& batch)
+		{
+			uint64_t s = _claimed.fetch_add(1, std::memory_order_relaxed);
+			if (s >= _nbseg) return false;
+			getBatch(batch, s);
+			return true;
+		}
+
+		/*! The source of the primes of bit size bits()+1, with the same seed.
+		 * It is created at the first call, all the callers share it.
+		 */
+		std::shared_ptr<PrimeBatchSource> next ()
+		{
+			std::call_once(_nextOnce, [this]() {
+				if (_bits >= 63)
+					throw LinboxError("LinBox ERROR: Ran out of primes in PrimeBatchSource.\n");
+				if (_table.empty())
+					_next = std::make_shared<PrimeBatchSource>(_bits+1, _seed, _log2step, _seglen);
+				else
+					_next = std::make_shared<PrimeBatchSource>(std::max<uint64_t>(_bits+1, 3), _seed);
+			});
+			return _next;
+		}
+
+		/// Batch number s, in the order of the source.
+		void getBatch (std::vector<uint64_t>& batch, uint64_t s) const
+		{
+			batch.clear();
+			if (! _table.empty()) {
+				size_t b = (size_t)(s * _seglen), e = std::min(_table.size(), (size_t)(b + _seglen));
+				batch.assign(_table.begin()+b, _table.begin()+e);
+				return;
+			}
+			uint64_t seg = segmentOf(s);
+			sieve(batch, _mlo + seg*_seglen, std::min(_mhi, _mlo + (seg+1)*_seglen));
+			if (_seed == 0)
+				std::reverse(batch.begin(), batch.end());
+			else
+				shuffle(batch, s);
+		}
+
+		/// The first \p count primes of the source (independent of the claimed batches).
+		std::vector<uint64_t> generate (size_t count) const
+		{
+			std::vector<uint64_t> primes, batch;
+			for (uint64_t s = 0; s < _nbseg && primes.size() < count; ++s) {
+				getBatch(batch, s);
+				primes.insert(primes.end(), batch.begin(), batch.begin() + std::min(batch.size(), count - primes.size()));
+			}
+			return primes;
+		}
+
+		/// Deterministic Miller-Rabin, exact for all 64 bits integers.
+		static bool isPrime (uint64_t n)
+		{
+			if (n < 2) return false;
+			static const uint64_t small[] = {2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37};
+			for (size_t i = 0; i < 12; ++i) {
+				if (n == small[i]) return true;
+				if (n % small[i] == 0) return false;
+			}
+			uint64_t d = n-1;
+			unsigned r = 0;
+			while (! (d & 1)) { d >>= 1; ++r; }
+			static const uint64_t bases[] = {2, 325, 9375, 28178, 450775, 9780504, 1795265022};
+			for (size_t i = 0; i < 7; ++i) {
+				uint64_t a = bases[i] % n;
+				if (a == 0) continue;
+				uint64_t x = powmod(a, d, n);
+				if (x == 1 || x == n-1) continue;
+				bool composite = true;
+				for (unsigned k = 1; k < r && composite; ++k) {
+					x = mulmod(x, x, n);
+					if (x == n-1) composite = false;
+				}
+				if (composite) return false;
+			}
+			return true;
+		}
+
+	protected:
+		uint64_t _bits, _seed, _log2step;
+		uint64_t _mlo, _mhi;        // candidates 1 + 2^_log2step m, _mlo <= m < _mhi
+		uint64_t _seglen, _nbseg;
+		uint64_t _a, _b;            // segment order s -> (a s + b) mod _nbseg
+		std::atomic<uint64_t> _claimed;
+		std::vector<uint32_t> _small;    // odd sieving primes
+		std::vector<uint32_t> _offset;   // first multiple of each in the progression
+		std::vector<uint64_t> _table;
+		bool _complete;             // the sieving primes reach the square root
+		std::once_flag _nextOnce;
+		std::shared_ptr<PrimeBatchSource> _next;
+
+		// the sieving primes go up to 2^20, survivors are then checked if needed
+		void initSmallPrimes ()
+		{
+			uint64_t hi = uint64_t(1) << _bits;
+			uint64_t root = (uint64_t)std::sqrt((double)hi);
+			while (root*root > hi) --root;
+			while ((root+1)*(root+1) <= hi) ++root;
+			uint64_t bound = std::min<uint64_t>(root, uint64_t(1) << 20);
+			_complete = (bound >= root);
+			std::vector<bool> composite(bound+1, false);
+			for (uint64_t i = 3; i <= bound; i += 2) {
+				if (composite[i]) continue;
+				_small.push_back((uint32_t)i);
+				// 1 + 2^k m = 0 mod i  <=>  m = -inv(2^k) mod i
+				_offset.push_back((uint32_t)((i - invmod(powmod(2, _log2step, i), i)) % i));
+				for (uint64_t j = i*i; j <= bound; j += 2*i) composite[j] = true;
+			}
+		}
+
+		void initOrder ()
+		{
+			_a = 1; _b = 0;
+			if (_seed == 0 || _nbseg < 2) return;
+			uint64_t x = _seed;
+			_a = 1 + splitmix(x) % (_nbseg-1);
+			while (gcd(_a, _nbseg) != 1) ++_a;
+			_b = splitmix(x) % _nbseg;
+		}
+
+		// deterministic: from the top segment down
+		uint64_t segmentOf (uint64_t s) const
+		{
+			if (_seed == 0) return _nbseg-1-s;
+			uint64_t y = mulmod(_a, s, _nbseg);
+			return y >= _nbseg - _b ? y - (_nbseg - _b) : y + _b;
+		}
+
+		// primes 1 + 2^k m for m in [m0, m1[, increasing
+		void sieve (std::vector<uint64_t>& primes, uint64_t m0, uint64_t m1) const
+		{
+			std::vector<char> alive(m1 - m0, 1);
+			const unsigned k = (unsigned)_log2step;
+			for (size_t i = 0; i < _small.size(); ++i) {
+				uint64_t q = _small[i];
+				uint64_t first = m0 + (_offset[i] + q - m0 % q) % q;
+				for (uint64_t m = first; m < m1; m += q) {
+					// keep q itself
+					if ((m << k) + 1 != q) alive[m - m0] = 0;
+				}
+			}
+			for (uint64_t m = m0; m < m1; ++m) {
+				if (! alive[m - m0]) continue;
+				uint64_t p = (m << k) + 1;
+				if (_complete || isPrime(p)) primes.push_back(p);
+			}
+		}
+
+		void shuffle (std::vector<uint64_t>& batch, uint64_t s) const
+		{
+			uint64_t x = _seed ^ (s * 0xD1B54A32D192ED03ULL);
+			for (size_t i = batch.size(); i > 1; --i)
+				std::swap(batch[i-1], batch[splitmix(x) % i]);
+		}
+
+		static uint64_t splitmix (uint64_t& x)
+		{
+			uint64_t z = (x += 0x9E3779B97F4A7C15ULL);
+			z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+			z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+			return z ^ (z >> 31);
+		}
+
+		static uint64_t gcd (uint64_t a, uint64_t b) { while (b) { uint64_t t = a%b; a = b; b = t; } return a; }
+
+		static uint64_t mulmod (uint64_t a, uint64_t b, uint64_t n)
+		{
+#ifdef __SIZEOF_INT128__
+			return (uint64_t)((unsigned __int128)a * b % n);
+#else
+			// double and add, without overflow
+			uint64_t r = 0;
+			a %= n; b %= n;
+			for (; b; b >>= 1) {
+				if (b & 1) r = (r >= n - a) ? r - (n - a) : r + a;
+				a = (a >= n - a) ? a - (n - a) : a + a;
+			}
+			return r;
+#endif
+		}
+
+		// number of bits of x > 0
+		static uint64_t bitLength (uint64_t x)
+		{
+#ifdef __GNUC__
+			return 64 - (uint64_t)__builtin_clzll(x);
+#else
+			uint64_t b = 0;
+			for (; x; x >>= 1) ++b;
+			return b;
+#endif
+		}
+
+		static uint64_t powmod (uint64_t a, uint64_t e, uint64_t n)
+		{
+			uint64_t r = 1 % n;
+			for (; e; e >>= 1, a = mulmod(a, a, n))
+				if (e & 1) r = mulmod(r, a, n);
+			return r;
+		}
+
+		// q prime, a != 0 mod q
+		static uint64_t invmod (uint64_t a, uint64_t q) { return powmod(a, q-2, q); }
+	};
+
+	/*! @brief Prime iterator drawing its primes from a PrimeBatchSource.
+	 * @ingroup primes
+	 * @ingroup randiter
+	 *
+	 * With the DeterministicTag the primes are decreasing from 2^bits, with
+	 * the HeuristicTag they follow a permutation fixed by the seed.
+	 * A copy goes on from the same batch and position, it returns the same
+	 * primes as the original. Iterators built on the same source() never
+	 * return the same prime: give one to each thread.
+	 */
+	template<class Trait = IteratorCategories::HeuristicTag>
+	class SievePrimeIterator {
+	public:
+		typedef integer Prime_Type;
+		typedef std::true_type UniqueSamplingTag; //!< the batches are disjoint
+		typedef Trait IteratorTag;
+
+		/*! Constructor.
+		 * @param bits size of primes (in bits).
+		 * @param seed if \c 0 a seed will be generated, otherwise the provided
+		 * seed will be used (ignored by the DeterministicTag).
+		 */
+		SievePrimeIterator (uint64_t bits = 23, uint64_t seed = 0) :
+			_pos(0)
+		{
+			_source = makeSource(bits, seed);
+			++(*this);
+		}
+
+		/// Shares the primes of an existing source.
+		SievePrimeIterator (std::shared_ptr<PrimeBatchSource> source) :
+			_source(source), _pos(0)
+		{
+			++(*this);
+		}
+
+		/// Same source, same batch and position: no batch is claimed.
+		SievePrimeIterator (const SievePrimeIterator& other) = default;
+
+		SievePrimeIterator& operator= (const SievePrimeIterator& other) = default;
+
+		/** @brief operator++()  (prefix ++ operator)
+		 *  moves to the next prime, sieving a new batch when needed, of
+		 *  the next bit size when the source is exhausted.
+		 */
+		inline SievePrimeIterator& operator++ ()
+		{
+			while (_pos >= _batch.size()) {
+				if (_source->nextBatch(_batch))
+					_pos = 0;
+				else
+					_source = _source->next();
+			}
+			_prime = _batch[_pos++];
+			return *this;
+		}
+
+		/** @brief get the prime.
+		 *  @warning a new prime is not generated.
+		 */
+		const Prime_Type& operator* () const { return _prime; }
+
+		/// Restarts with primes of another size, in a new source.
+		void setBits (uint64_t bits)
+		{
+			if (bits == getBits()) return;
+			_source = makeSource(bits, 0);
+			_batch.clear(); _pos = 0;
+			++(*this);
+		}
+
+		uint64_t getBits () const { return _source->bits(); }
+
+		std::shared_ptr<PrimeBatchSource> source () const { return _source; }
+
+	protected:
+		std::shared_ptr<PrimeBatchSource> _source;
+		std::vector<uint64_t>              _batch;
+		size_t                               _pos;
+		Prime_Type                         _prime;
+
+		static std::shared_ptr<PrimeBatchSource> makeSource (uint64_t bits, uint64_t seed)
+		{
+			linbox_check(bits > 2);
+			if (std::is_same<Trait, IteratorCategories::DeterministicTag>::value)
+				seed = 0;
+			else if (! seed)
+				seed = BaseTimer::seed();
+			return std::make_shared<PrimeBatchSource>(bits, seed);
+		}
+	};
+
+	/*! Writes a prime table, one prime per line after a comment line. */
+	inline std::ostream& writePrimeTable (std::ostream& os, const std::vector<uint64_t>& primes)
+	{
+		os << "# LinBox prime table, " << primes.size() << " primes\n";
+		for (size_t i = 0; i < primes.size(); ++i)
+			os << primes[i] << '\n';
+		return os << std::flush;
+	}
+
+	/*! Reads a table written by writePrimeTable, checking each entry.
+	 * Lines starting with '#' are ignored.
+	 */
+	inline std::vector<uint64_t>& readPrimeTable (std::vector<uint64_t>& primes, std::istream& is)
+	{
+		primes.clear();
+		std::string line;
+		while (std::getline(is, line)) {
+			size_t b = line.find_first_not_of(" \t\r");
+			if (b == std::string::npos || line[b] == '#') continue;
+			uint64_t p = std::stoull(line.substr(b));
+			if (! PrimeBatchSource::isPrime(p))
+				throw LinboxError("readPrimeTable: " + line + " is not a prime");
+			primes.push_back(p);
+		}
+		return primes;
+	}
+}
+
+#endif //__LINBOX_sieve_prime_H
+
+// Local Variables:
+// mode: C++
+// tab-width: 4
+// indent-tabs-mode: nil
+// c-basic-offset: 4
+// End:
+// vim:sts=4:sw=4:ts=4:et:sr:cino=>s,f0,{0,g0,(0,\:0,t0,+0,=s
@@ -527,6 +527,7 @@ namespace LinBox
 
 #include "linbox/algorithms/cra-builder-single.h"
 #include "linbox/randiter/random-prime.h"
+#include "linbox/randiter/sieve-prime.h"
 #include "linbox/algorithms/matrix-hom.h"
 
 namespace LinBox
@@ -572,7 +573,7 @@ namespace LinBox
 		// 0.7213475205 is an upper approximation of 1/(2log(2))
 		IntegerModularDet<Blackbox, MyMethod> iteration(A, Meth);
                 typedef Givaro::ModularBalanced<double> Field;
-                PrimeIterator<IteratorCategories::HeuristicTag> genprime(FieldTraits<Field>::bestBitSize(A.coldim()));
+                SievePrimeIterator<IteratorCategories::HeuristicTag> genprime(FieldTraits<Field>::bestBitSize(A.coldim()));
 		integer dd; // use of integer due to non genericity of cra. PG 2005-08-04
 
 		//  will call regular cra if C=0
@@ -280,6 +280,21 @@ namespace LinBox {
         // (Numeric symbolic norm iteration - Saunders, Wan ISSAC 2004)
         DEFINE_METHOD(SymbolicNumericNorm, RingCategories::IntegerTag);
 
+        // Method::BlockHankel uses Dixon's p-adic lifting on sparse systems,
+        // with the inverse given by a block Krylov projection and its block Hankel matrix.
+        // A blockingFactor of 0 (the default) lets the solver choose it.
+        // (Solving sparse rational linear systems - Eberly, Giesbrecht, Giorgi, Storjohann, Villard ISSAC 2006)
+        struct BlockHankel : public MethodBase {
+            using CategoryTag = RingCategories::IntegerTag;
+            static std::string name() { return std::string("Method::BlockHankel"); }
+            BlockHankel() { blockingFactor = 0; }
+            BlockHankel(const BlockHankel&) = default;
+            BlockHankel(const MethodBase& methodBase)
+                : MethodBase(methodBase)
+            {
+            }
+        };
+
         //
         // Blackbox methods
         //
@@ -318,9 +333,6 @@ namespace LinBox {
 
         // (Mathematics of Computations - Coppersmith 1994)
         DEFINE_METHOD(Coppersmith, void);
-
-        // Use Krylov sequence to solve.
-        DEFINE_METHOD(BlockHankel, RingCategories::IntegerTag);
     };
 }
 
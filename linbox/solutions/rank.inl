@@ -259,8 +259,12 @@ namespace LinBox
 			typedef Compose<Compose<Compose<Compose<Diagonal<Field>,Transpose<Blackbox> >, Diagonal<Field> >, Blackbox>, Diagonal<Field> > Blackbox0;
 			Blackbox0 B_i (&B3_i, &D1_i);
 
-			BlackboxContainerSymmetric<Field, Blackbox0> TF_i (&B_i, F, iter);
-			MasseyDomain<Field, BlackboxContainerSymmetric<Field, Blackbox0> > WD (&TF_i, M.earlyTerminationThreshold);
+			// a sparse A is applied as a single ScaledGram, without temporaries
+			typedef typename Fused<Blackbox0>::value_type FusedBlackbox;
+			typename Fused<Blackbox0>::type FB_i = Fused<Blackbox0>::make(B_i);
+
+			BlackboxContainerSymmetric<Field, FusedBlackbox> TF_i (&FB_i, F, iter);
+			MasseyDomain<Field, BlackboxContainerSymmetric<Field, FusedBlackbox> > WD (&TF_i, M.earlyTerminationThreshold);
 
 			BlasVector<Field> phi(F);
 			WD.pseudo_minpoly (phi, res);
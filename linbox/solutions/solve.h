@@ -27,6 +27,7 @@
 #include <linbox/algorithms/vector-fraction.h> // @fixme Why this is not inside vector/vector-fraction.h?
 #include <linbox/field/field-traits.h>
 #include <linbox/solutions/methods.h>
+#include <linbox/util/tracer.h>
 
 namespace LinBox {
     //
@@ -84,6 +85,11 @@ namespace LinBox {
      *      |   - SparseMatrix  > `DixonSolver<..., Method::SparseElimination>`
      *      |   - Otherwise     >  Error
      *      - Otherwise > Error
+     * - Method::BlockHankel
+     *      - IntegerTag
+     *      |   - SparseMatrix  > `DixonSolver<..., Method::BlockHankel>`, Method::Dixon if singular
+     *      |   - Otherwise     > Method::Dixon
+     *      - Otherwise > Error
      * - Method::Blackbox > Method::Wiedemann
      * - Method::Wiedemann
      *      - ModularTag > `WiedemannSolver`
@@ -129,6 +135,7 @@ namespace LinBox {
     template <class ResultVector, class Matrix, class Vector, class SolveMethod>
     inline ResultVector& solve(ResultVector& x, const Matrix& A, const Vector& b, const SolveMethod& m)
     {
+        LINBOX_TRACE_SCOPE("solve");
         return solve(x, A, b, typename FieldTraits<typename Matrix::Field>::categoryTag(), m);
     }
 
@@ -235,6 +242,7 @@ namespace LinBox {
     template <class IntVector, class Matrix, class Vector, class SolveMethod>
     inline void solve(IntVector& xNum, typename IntVector::Element& xDen, const Matrix& A, const Vector& b, const SolveMethod& m)
     {
+        LINBOX_TRACE_SCOPE("solve");
         solve(xNum, xDen, A, b, typename FieldTraits<typename Matrix::Field>::categoryTag(), m);
     }
 
@@ -38,6 +38,7 @@
 #include <linbox/algorithms/rational-cra.h>
 #include <linbox/field/rebind.h>
 #include <linbox/randiter/random-prime.h>
+#include <linbox/randiter/sieve-prime.h>
 #include <linbox/solutions/hadamard-bound.h>
 #include <linbox/util/commentator.h>
 #include <linbox/util/debug.h> // NotImplementedYet
@@ -146,7 +147,7 @@ namespace LinBox {
 
         using CRAField = Givaro::ModularBalanced<double>;
         unsigned int bits = FieldTraits<CRAField>::bestBitSize(A.coldim());
-        PrimeIterator<LinBox::IteratorCategories::HeuristicTag> primeGenerator(bits);
+        SievePrimeIterator<LinBox::IteratorCategories::HeuristicTag> primeGenerator(bits);
         CRASolveIteration<Matrix, Vector, IterationMethod> iteration(A, b, m.iterationMethod);
 
         // @note The result is stored to Integers, and will be converted
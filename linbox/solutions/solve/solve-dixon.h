@@ -164,4 +164,42 @@ namespace LinBox {
             throw LinboxError("From Dixon method.");
         }
     }
+
+    /**
+     * \brief Solve specialisation for BlockHankel on sparse matrices.
+     *
+     * Singular or non-square systems, and systems on which the block Hankel
+     * lifting fails, are forwarded to Method::Dixon.
+     */
+    template <class IntVector, class... MatrixArgs, class Vector>
+    void solve(IntVector& xNum, typename IntVector::Element& xDen, const SparseMatrix<MatrixArgs...>& A, const Vector& b,
+               const RingCategories::IntegerTag& tag, const Method::BlockHankel& m)
+    {
+        linbox_check((A.coldim() == xNum.size()) && (A.rowdim() == b.size()));
+
+        SolverReturnStatus status = SS_SINGULAR;
+        if (A.rowdim() == A.coldim() && m.singularity != Singularity::Singular) {
+            commentator().start("solve.block-hankel.integer.sparse");
+
+            using Matrix = SparseMatrix<MatrixArgs...>;
+            using Ring = typename Matrix::Field;
+            using Field = Givaro::Modular<double>;
+            using PrimeGenerator = PrimeIterator<IteratorCategories::HeuristicTag>;
+            PrimeGenerator primeGenerator(FieldTraits<Field>::bestBitSize(A.coldim()));
+
+            using Solver = DixonSolver<Ring, Field, PrimeGenerator, Method::BlockHankel>;
+            Solver dixonSolve(A.field(), primeGenerator);
+
+            int maxTrials = m.trialsBeforeFailure;
+            status = dixonSolve.solveNonsingular(xNum, xDen, A, b, m.blockingFactor, maxTrials);
+
+            commentator().stop("solve.block-hankel.integer.sparse");
+        }
+
+        if (status != SS_OK) {
+            commentator().report(Commentator::LEVEL_UNIMPORTANT, INTERNAL_WARNING)
+                << "Method::BlockHankel is forwarded to Method::Dixon." << std::endl;
+            solve(xNum, xDen, A, b, tag, Method::Dixon(m));
+        }
+    }
 }
@@ -49,6 +49,7 @@
 
 //#include "linbox/util/timer.h"
 #include "givaro/givtimer.h"
+#include "linbox/util/tracer.h"
 
 #ifndef MAX
 #  define MAX(a,b) (((a) > (b)) ? (a) : (b))
@@ -868,12 +869,12 @@ namespace LinBox
             {}
             inline  ~Commentator ()
             {}
-            inline void start (const char *, const char * = (const char *) 0, unsigned long = 0)
-            {}
+            inline void start (const char *description, const char * = (const char *) 0, unsigned long = 0)
+            { LINBOX_TRACE_BEGIN(description); }
             inline void startIteration (unsigned int , unsigned long = 0)
-            {}
+            { LINBOX_TRACE_BEGIN("Iteration"); }
             inline void stop (const char *, const char * = (const char *) 0, const char * = (const char *) 0)
-            {}
+            { LINBOX_TRACE_END(); }
             inline void progress (long = -1, long = -1)
             {}
 
@@ -132,6 +132,8 @@ namespace LinBox
 
     void Commentator::start (const char *description, const char *fn, unsigned long len)
     {
+        LINBOX_TRACE_BEGIN(description);
+
         if (fn == (const char *) 0 && _activities.size () > 0)
             fn = _activities.top ()->_fn;
 
@@ -169,6 +171,8 @@ namespace LinBox
         double realtime; //, usertime, systime;
         Activity *top_act;
 
+        LINBOX_TRACE_END();
+
         linbox_check (_activities.top () != (Activity *) 0);
         linbox_check (msg != (const char *) 0);
 
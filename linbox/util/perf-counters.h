@@ -0,0 +1,317 @@
+/* linbox/util/perf-counters.h
+ * Copyright (C) LinBox
+ *
+ * ========LICENCE========
+ * This file is part of the library LinBox.
+ *
+ * LinBox is free software: you can redistribute it and/or modify
+ * it under the terms of the  GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ * ========LICENCE========
+ */
+
+/*! @file util/perf-counters.h
+ * @ingroup util
+ * @brief Hardware performance counters (Linux perf_event).
+ *
+ * PerfCounters measures cycles, instructions, last level cache references
+ * and misses of the calling thread between start() and stop(), together
+ * with the wall time, and derives the IPC, the LLC miss rate and the
+ * memory bandwidth implied by the LLC misses (one cache line per miss).
+ * A high bandwidth close to the machine peak points to a bandwidth bound
+ * kernel, a low IPC with a low bandwidth to a latency bound one.
+ *
+ * Kernels are instrumented with LINBOX_PERF_SCOPE(name). The counters are
+ * compiled in only when \c __LINBOX_PERF is defined, otherwise this header
+ * only defines the macro, which expands to nothing. The measures are aggregated
+ * by name over all the threads in perfRegistry(), e.g. to be written next
+ * to the benchmark timings.
+ *
+ * The hardware counters only count the thread which runs the scope: the
+ * events are not inherited, so the work of the threads a kernel hands out
+ * to (e.g. the OpenMP team of a parallel fgemm) is missing from the counts,
+ * while the time is the wall time of the whole kernel. Inheritance would
+ * not help, as it only follows the threads created after the counters are
+ * opened, not those of a running thread pool. The counts should be read
+ * as those of the calling thread, and reported as such (countingScope()).
+ *
+ * When the counters are not available (other OS, or perf_event_paranoid
+ * too restrictive), available() is false and only the time is measured.
+ */
+
+#ifndef __LINBOX_util_perf_counters_H
+#define __LINBOX_util_perf_counters_H
+
+#ifdef __LINBOX_PERF
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <map>
+#include <ostream>
+#include <cstring>
+#include <chrono>
+#include <mutex>
+
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+#ifndef __LINBOX_CACHE_LINE_SIZE
+#define __LINBOX_CACHE_LINE_SIZE 64
+#endif
+
+namespace LinBox
+{
+	class PerfCounters {
+	public:
+		enum Event { CYCLES=0, INSTRUCTIONS, LLC_REFERENCES, LLC_MISSES, NB_EVENTS };
+
+		/// @param counting open the hardware counters, false for a mere accumulator
+		explicit PerfCounters (bool counting = true) : _leader(-1), _seconds(0), _depth(0)
+		{
+			for (int e=0; e<NB_EVENTS; ++e) { _fd[e] = -1; _values[e] = 0; }
+			if (counting) open();
+		}
+
+		~PerfCounters () { close(); }
+
+		bool available () const { return _leader >= 0; }
+
+		/// Start counting, nested start/stop pairs only count once.
+		void start ()
+		{
+			if (_depth++ > 0) return;
+#ifdef __linux__
+			if (available()) {
+				ioctl(_leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+				ioctl(_leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+			}
+#endif
+			_start = std::chrono::steady_clock::now();
+		}
+
+		/// Stop counting and accumulate.
+		void stop ()
+		{
+			if (_depth == 0 || --_depth > 0) return;
+			std::chrono::duration<double> d = std::chrono::steady_clock::now() - _start;
+			_seconds += d.count();
+#ifdef __linux__
+			if (available()) {
+				ioctl(_leader, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+				// PERF_FORMAT_GROUP: nr, then one value per event
+				uint64_t buf[NB_EVENTS+1];
+				if (::read(_leader, buf, sizeof(buf)) > 0)
+					for (uint64_t e=0; e<buf[0] && e<NB_EVENTS; ++e)
+						_values[e] += buf[e+1];
+			}
+#endif
+		}
+
+		void reset ()
+		{
+			_seconds = 0;
+			for (int e=0; e<NB_EVENTS; ++e) _values[e] = 0;
+		}
+
+		/// Accumulate the measures of another set of counters.
+		PerfCounters& operator+= (const PerfCounters& P)
+		{
+			_seconds += P._seconds;
+			for (int e=0; e<NB_EVENTS; ++e) _values[e] += P._values[e];
+			return *this;
+		}
+
+		uint64_t value (Event e) const { return _values[e]; }
+		uint64_t cycles () const { return _values[CYCLES]; }
+		uint64_t instructions () const { return _values[INSTRUCTIONS]; }
+		uint64_t llcMisses () const { return _values[LLC_MISSES]; }
+		double   seconds () const { return _seconds; }
+
+		double ipc () const
+		{
+			return cycles() ? (double)instructions()/(double)cycles() : 0.;
+		}
+
+		double llcMissRate () const
+		{
+			return _values[LLC_REFERENCES] ? (double)llcMisses()/(double)_values[LLC_REFERENCES] : 0.;
+		}
+
+		/// Memory traffic implied by the LLC misses, in GB/s.
+		double bandwidth () const
+		{
+			return (_seconds > 0) ? (double)llcMisses()*__LINBOX_CACHE_LINE_SIZE/_seconds*1e-9 : 0.;
+		}
+
+		/// What the hardware counts cover, to be printed next to them.
+		static const char* countingScope () { return "calling thread only"; }
+
+		std::ostream& write (std::ostream& os) const
+		{
+			os << "Time: " << _seconds << "s";
+			if (!available() && cycles() == 0)
+				return os << " (no hardware counters)";
+			return os << " (" << countingScope() << ")" << " Cycles: " << cycles() << " Instructions: " << instructions()
+				<< " IPC: " << ipc() << " LLCMisses: " << llcMisses()
+				<< " LLCMissRate: " << llcMissRate() << " Bandwidth: " << bandwidth() << "GB/s";
+		}
+
+	protected:
+		int      _fd[NB_EVENTS];
+		int      _leader;
+		uint64_t _values[NB_EVENTS];
+		double   _seconds;
+		size_t   _depth;
+		std::chrono::steady_clock::time_point _start;
+
+		// counters are per object, not copyable
+		PerfCounters (const PerfCounters&);
+		PerfCounters& operator= (const PerfCounters&);
+
+		void open ()
+		{
+#ifdef __linux__
+			static const uint64_t config[NB_EVENTS] = {
+				PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+				PERF_COUNT_HW_CACHE_REFERENCES, PERF_COUNT_HW_CACHE_MISSES };
+			for (int e=0; e<NB_EVENTS; ++e) {
+				struct perf_event_attr attr;
+				std::memset(&attr, 0, sizeof(attr));
+				attr.size = sizeof(attr);
+				attr.type = PERF_TYPE_HARDWARE;
+				attr.config = config[e];
+				attr.disabled = (e == 0);
+				attr.exclude_kernel = 1;
+				attr.exclude_hv = 1;
+				attr.read_format = PERF_FORMAT_GROUP;
+				// calling thread, any cpu, not inherited by its children
+				_fd[e] = (int)syscall(__NR_perf_event_open, &attr, 0, -1, _leader, 0);
+				if (_fd[e] < 0) { close(); return; }
+				if (e == 0) _leader = _fd[0];
+			}
+#endif
+		}
+
+		void close ()
+		{
+#ifdef __linux__
+			for (int e=0; e<NB_EVENTS; ++e)
+				if (_fd[e] >= 0) { ::close(_fd[e]); _fd[e] = -1; }
+#endif
+			_leader = -1;
+		}
+	};
+
+	/** Counters of the instrumented kernels, by name.
+	 * Each thread measures with its own counters, the measures are
+	 * summed over the threads when written.
+	 */
+	class PerfRegistry {
+	public:
+		~PerfRegistry ()
+		{
+			for (size_t i=0; i<_all.size(); ++i)
+				delete _all[i].second;
+		}
+
+		/// The counters of the calling thread for this kernel.
+		/// @param name a string literal, it is looked up by address.
+		PerfCounters& local (const char* name)
+		{
+			static thread_local std::map<const char*,PerfCounters*> mine;
+			std::map<const char*,PerfCounters*>::iterator it = mine.find(name);
+			if (it != mine.end()) return *(it->second);
+			PerfCounters* P = new PerfCounters;
+			mine[name] = P;
+			std::lock_guard<std::mutex> lock(_mutex);
+			_all.push_back(std::make_pair(std::string(name),P));
+			return *P;
+		}
+
+		/// Sum over the threads, only when no kernel is running.
+		std::map<std::string,PerfCounters*> summary (std::vector<PerfCounters*>& owned) const
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			std::map<std::string,PerfCounters*> S;
+			for (size_t i=0; i<_all.size(); ++i) {
+				PerfCounters*& P = S[_all[i].first];
+				if (P == NULL) { P = new PerfCounters(false); owned.push_back(P); }
+				*P += *(_all[i].second);
+			}
+			return S;
+		}
+
+		/// f(name, counters) for each kernel, by name, summed over the threads.
+		template<class Function>
+		void forEach (Function f) const
+		{
+			std::vector<PerfCounters*> owned;
+			std::map<std::string,PerfCounters*> S = summary(owned);
+			for (std::map<std::string,PerfCounters*>::const_iterator it=S.begin(); it!=S.end(); ++it)
+				f(it->first, (const PerfCounters&)*(it->second));
+			for (size_t i=0; i<owned.size(); ++i) delete owned[i];
+		}
+
+		void reset ()
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			for (size_t i=0; i<_all.size(); ++i)
+				_all[i].second->reset();
+		}
+
+	protected:
+		mutable std::mutex _mutex;
+		std::vector<std::pair<std::string,PerfCounters*> > _all;
+	};
+
+	inline PerfRegistry& perfRegistry ()
+	{
+		static PerfRegistry internal_static_perf_registry;
+		return internal_static_perf_registry;
+	}
+
+	/// Measures the enclosing scope with the counters of the kernel \p name.
+	class PerfScope {
+	public:
+		PerfScope (const char* name) : _P(perfRegistry().local(name)) { _P.start(); }
+		~PerfScope () { _P.stop(); }
+	protected:
+		PerfCounters& _P;
+	};
+
+} // namespace LinBox
+
+#define LINBOX_PERF_CONCAT_(a,b) a##b
+#define LINBOX_PERF_CONCAT(a,b) LINBOX_PERF_CONCAT_(a,b)
+#define LINBOX_PERF_SCOPE(name) LinBox::PerfScope LINBOX_PERF_CONCAT(linbox_perf_scope_,__LINE__)(name)
+
+#else // __LINBOX_PERF
+
+#define LINBOX_PERF_SCOPE(name)
+
+#endif // __LINBOX_PERF
+
+#endif // __LINBOX_util_perf_counters_H
+
+// Local Variables:
+// mode: C++
+// tab-width: 4
+// indent-tabs-mode: nil
+// c-basic-offset: 4
+// End:
+// vim:sts=4:sw=4:ts=4:et:sr:cino=>s,f0,{0,g0,(0,\:0,t0,+0,=s
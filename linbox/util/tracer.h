@@ -0,0 +1,305 @@
+/* linbox/util/tracer.h
+ * Copyright (C) LinBox
+ *
+ * ========LICENCE========
+ * This file is part of the library LinBox.
+ *
+ * LinBox is free software: you can redistribute it and/or modify
+ * it under the terms of the  GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ * ========LICENCE========
+ */
+
+/*! @file util/tracer.h
+ * @ingroup util
+ * @brief Thread safe timeline of nested activities.
+ *
+ * Unlike the Commentator, the tracer can be used from parallel regions:
+ * each thread appends begin/end events to its own buffer, the only
+ * synchronisation being the registration of a thread at its first event.
+ * Tracing is compiled in only when \c __LINBOX_TRACE is defined, otherwise
+ * the macros below expand to nothing and tracer() is a Tracer with the same
+ * members which records nothing. It must also be switched on at runtime
+ * with <code>tracer().enable()</code>.
+ *
+ * Typical usage:
+ \code
+ tracer().enable();
+ {
+ LINBOX_TRACE_SCOPE("solve");
+ ...
+ }
+ tracer().writeChromeTrace(file);  // open with chrome://tracing or Perfetto
+ tracer().writeSummary(std::cout); // per activity totals
+ \endcode
+ *
+ * The Commentator start()/stop() calls are forwarded to the tracer, so the
+ * activities already instrumented appear in the timeline with the same
+ * names, even when the Commentator itself is disabled.
+ * Buffers must only be read (write*, clear) while no thread is tracing.
+ */
+
+#ifndef __LINBOX_util_tracer_H
+#define __LINBOX_util_tracer_H
+
+#include <cstddef>
+#include <map>
+#include <string>
+#include <ostream>
+
+namespace LinBox
+{
+	/// Per activity aggregate, see Tracer::summary.
+	struct TraceStat {
+		size_t _count;
+		double _total; // inclusive, in seconds
+		double _self;  // exclusive of the nested activities, in seconds
+		double _max;
+
+		TraceStat () : _count(0), _total(0), _self(0), _max(0) {}
+	};
+
+} // namespace LinBox
+
+#ifdef __LINBOX_TRACE
+
+#include <vector>
+#include <cstring>
+#include <stdint.h>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+
+namespace LinBox
+{
+	/// One begin or end event of an activity.
+	struct TraceEvent {
+		uint64_t _ts;      // nanoseconds since the tracer creation
+		char     _phase;   // 'B' or 'E'
+		char     _name[55];
+	};
+
+	/// Events of one thread, only written by that thread.
+	struct TraceBuffer {
+		size_t                  _tid;
+		std::vector<TraceEvent> _events;
+
+		TraceBuffer (size_t tid) : _tid(tid) { _events.reserve(4096); }
+	};
+
+	class Tracer {
+	public:
+		typedef std::chrono::steady_clock Clock;
+
+		Tracer () : _enabled(false), _origin(Clock::now()) {}
+
+		~Tracer ()
+		{
+			for (size_t i=0; i<_buffers.size(); ++i)
+				delete _buffers[i];
+		}
+
+		void enable  () { _enabled.store(true,  std::memory_order_relaxed); }
+		void disable () { _enabled.store(false, std::memory_order_relaxed); }
+		bool enabled () const { return _enabled.load(std::memory_order_relaxed); }
+
+		void begin (const char* name) { if (enabled()) record('B', name); }
+		void end   (const char* name = "") { if (enabled()) record('E', name); }
+
+		/// Forget all the recorded events, the threads stay registered.
+		void clear ()
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			for (size_t i=0; i<_buffers.size(); ++i)
+				_buffers[i]->_events.clear();
+		}
+
+		/// Chrome trace event format (JSON), timestamps in microseconds.
+		std::ostream& writeChromeTrace (std::ostream& os) const
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			os << "{\"traceEvents\":[";
+			bool first = true;
+			for (size_t i=0; i<_buffers.size(); ++i) {
+				const std::vector<TraceEvent>& ev = _buffers[i]->_events;
+				for (size_t k=0; k<ev.size(); ++k) {
+					os << (first ? "\n" : ",\n");
+					first = false;
+					os << "{\"name\":\"";
+					writeEscaped(os, ev[k]._name);
+					os << "\",\"ph\":\"" << ev[k]._phase
+					   << "\",\"ts\":" << ev[k]._ts/1000 << '.'
+					   << (char)('0'+ev[k]._ts/100%10) << (char)('0'+ev[k]._ts/10%10) << (char)('0'+ev[k]._ts%10)
+					   << ",\"pid\":0,\"tid\":" << _buffers[i]->_tid << "}";
+				}
+			}
+			return os << "\n],\"displayTimeUnit\":\"ns\"}" << std::endl;
+		}
+
+		/// Aggregate the activities of all threads by name.
+		std::map<std::string,TraceStat> summary () const
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			std::map<std::string,TraceStat> stats;
+			for (size_t i=0; i<_buffers.size(); ++i) {
+				const std::vector<TraceEvent>& ev = _buffers[i]->_events;
+				// open activities: event index and time spent in children
+				std::vector<std::pair<size_t,uint64_t> > stack;
+				for (size_t k=0; k<ev.size(); ++k) {
+					if (ev[k]._phase == 'B') {
+						stack.push_back(std::make_pair(k,uint64_t(0)));
+						continue;
+					}
+					if (stack.empty()) continue; // end without begin, e.g. after clear()
+					size_t b = stack.back().first;
+					uint64_t children = stack.back().second;
+					stack.pop_back();
+					uint64_t d = ev[k]._ts - ev[b]._ts;
+					TraceStat& s = stats[ev[b]._name];
+					++s._count;
+					s._total += (double)d*1e-9;
+					s._self  += (double)(d-std::min(d,children))*1e-9;
+					s._max    = std::max(s._max, (double)d*1e-9);
+					if (!stack.empty()) stack.back().second += d;
+				}
+			}
+			return stats;
+		}
+
+		std::ostream& writeSummary (std::ostream& os) const
+		{
+			std::map<std::string,TraceStat> stats = summary();
+			os << "activity\tcount\ttotal(s)\tself(s)\tmax(s)" << std::endl;
+			for (std::map<std::string,TraceStat>::const_iterator it=stats.begin(); it!=stats.end(); ++it)
+				os << it->first << '\t' << it->second._count << '\t' << it->second._total
+				   << '\t' << it->second._self << '\t' << it->second._max << std::endl;
+			return os;
+		}
+
+	protected:
+		std::atomic<bool>          _enabled;
+		Clock::time_point           _origin;
+		mutable std::mutex           _mutex;
+		std::vector<TraceBuffer*>  _buffers;
+
+		TraceBuffer* localBuffer ()
+		{
+			static thread_local TraceBuffer* buf = NULL;
+			if (buf == NULL) {
+				std::lock_guard<std::mutex> lock(_mutex);
+				buf = new TraceBuffer(_buffers.size());
+				_buffers.push_back(buf);
+			}
+			return buf;
+		}
+
+		void record (char phase, const char* name)
+		{
+			TraceBuffer* buf = localBuffer();
+			buf->_events.push_back(TraceEvent());
+			TraceEvent& e = buf->_events.back();
+			e._ts = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now()-_origin).count();
+			e._phase = phase;
+			std::strncpy(e._name, name ? name : "", sizeof(e._name)-1);
+			e._name[sizeof(e._name)-1] = '\0';
+		}
+
+		static void writeEscaped (std::ostream& os, const char* s)
+		{
+			for (; *s; ++s) {
+				if (*s == '"' || *s == '\\') os << '\\' << *s;
+				else if ((unsigned char)*s < 0x20) os << ' ';
+				else os << *s;
+			}
+		}
+	};
+
+	/// The process wide tracer.
+	inline Tracer& tracer ()
+	{
+		static Tracer internal_static_tracer;
+		return internal_static_tracer;
+	}
+
+	/// Traces the enclosing scope as one activity.
+	class TraceScope {
+	public:
+		TraceScope (const char* name) { tracer().begin(name); }
+		~TraceScope () { tracer().end(); }
+	};
+
+} // namespace LinBox
+
+#define LINBOX_TRACE_CONCAT_(a,b) a##b
+#define LINBOX_TRACE_CONCAT(a,b) LINBOX_TRACE_CONCAT_(a,b)
+#define LINBOX_TRACE_SCOPE(name) LinBox::TraceScope LINBOX_TRACE_CONCAT(linbox_trace_scope_,__LINE__)(name)
+#define LINBOX_TRACE_BEGIN(name) LinBox::tracer().begin(name)
+#define LINBOX_TRACE_END() LinBox::tracer().end()
+
+#else // __LINBOX_TRACE
+
+namespace LinBox
+{
+	/// Tracer compiled out: records nothing, writes an empty trace.
+	class Tracer {
+	public:
+		void enable  () {}
+		void disable () {}
+		bool enabled () const { return false; }
+
+		void begin (const char*) {}
+		void end   (const char* = "") {}
+		void clear () {}
+
+		std::ostream& writeChromeTrace (std::ostream& os) const
+		{
+			return os << "{\"traceEvents\":[\n],\"displayTimeUnit\":\"ns\"}" << std::endl;
+		}
+
+		std::map<std::string,TraceStat> summary () const { return std::map<std::string,TraceStat>(); }
+
+		std::ostream& writeSummary (std::ostream& os) const
+		{
+			return os << "activity\tcount\ttotal(s)\tself(s)\tmax(s)" << std::endl;
+		}
+	};
+
+	inline Tracer& tracer ()
+	{
+		static Tracer internal_static_tracer;
+		return internal_static_tracer;
+	}
+
+	class TraceScope {
+	public:
+		TraceScope (const char*) {}
+	};
+
+} // namespace LinBox
+
+#define LINBOX_TRACE_SCOPE(name)
+#define LINBOX_TRACE_BEGIN(name)
+#define LINBOX_TRACE_END()
+
+#endif // __LINBOX_TRACE
+
+#endif // __LINBOX_util_tracer_H
+
+// Local Variables:
+// mode: C++
+// tab-width: 4
+// indent-tabs-mode: nil
+// c-basic-offset: 4
+// End:
+// vim:sts=4:sw=4:ts=4:et:sr:cino=>s,f0,{0,g0,(0,\:0,t0,+0,=s
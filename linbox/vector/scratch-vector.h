@@ -0,0 +1,149 @@
+/* linbox/vector/scratch-vector.h
+ * Copyright (C) LinBox
+ *
+ * ========LICENCE========
+ * This file is part of the library LinBox.
+ *
+ * LinBox is free software: you can redistribute it and/or modify
+ * it under the terms of the  GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.	 See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ * ========LICENCE========
+ */
+
+/*! @file vector/scratch-vector.h
+ * @ingroup vector
+ * @brief Temporary vector of a blackbox, safe for concurrent applies.
+ */
+
+#ifndef __LINBOX_scratch_vector_H
+#define __LINBOX_scratch_vector_H
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+namespace LinBox
+{
+	template<class _Field, class _Rep> class BlasVector ;
+
+	namespace Protected
+	{
+		/// @internal An object of the shape of \p v (sizes and field), built
+		/// without reading its entries: another thread may be writing them.
+		template <class T>
+		struct ScratchShape {
+			static const bool leaf = true;
+			static T make (const T &) { return T(); }
+		};
+
+		template <class T, class A>
+		struct ScratchShape<std::vector<T, A> > {
+			static const bool leaf = false;
+			static std::vector<T, A> make (const std::vector<T, A> &v)
+			{
+				std::vector<T, A> w(v.size());
+				if (! ScratchShape<T>::leaf)
+					for (size_t i = 0; i < v.size(); ++i)
+						w[i] = ScratchShape<T>::make(v[i]);
+				return w;
+			}
+		};
+
+		template <class F, class R>
+		struct ScratchShape<BlasVector<F, R> > {
+			static const bool leaf = false;
+			static BlasVector<F, R> make (const BlasVector<F, R> &v)
+			{
+				return BlasVector<F, R>(v.field(), v.size());
+			}
+		};
+	}
+
+	/** Temporary vector kept by a blackbox between two applies.
+	 *
+	 * A Guard lends the kept vector to the first caller; a caller arriving
+	 * while it is lent (another thread, or a nested apply) gets a vector of
+	 * its own, of the same shape, for the duration of the Guard: the entries
+	 * of the lent vector are never read. The usual sequential case thus
+	 * costs one atomic exchange and no allocation.
+	 *
+	 * The content of the vector is unspecified, only its size and field are.
+	 */
+	template <class _Vector>
+	class ScratchVector {
+	public:
+		typedef _Vector Vector;
+
+		ScratchVector () :
+			_busy(false)
+		{}
+
+		ScratchVector (const Vector &v) :
+			_v(v), _busy(false)
+		{}
+
+		ScratchVector (const ScratchVector &S) :
+			_v(S._v), _busy(false)
+		{}
+
+		ScratchVector& operator= (const ScratchVector &S)
+		{
+			_v = S._v;
+			return *this;
+		}
+
+		/// Vector to use until the guard is destroyed.
+		class Guard {
+		public:
+			Guard (const ScratchVector &S) :
+				_s(S), _own(! S._busy.exchange(true, std::memory_order_acquire))
+			{
+				if (! _own) _local.reset(new Vector(Protected::ScratchShape<Vector>::make(S._v)));
+			}
+
+			~Guard ()
+			{
+				if (_own) _s._busy.store(false, std::memory_order_release);
+			}
+
+			Vector& operator* () { return _own ? _s._v : *_local; }
+			Vector* operator-> () { return &(**this); }
+
+		private:
+			Guard (const Guard&);
+			Guard& operator= (const Guard&);
+
+			const ScratchVector       &_s;
+			bool                     _own;
+			std::unique_ptr<Vector> _local;
+		};
+
+		/// Kept vector, for the owner only (resize, rebind).
+		Vector& get () { return _v; }
+
+	private:
+		mutable Vector                _v;
+		mutable std::atomic<bool>  _busy;
+	};
+
+} // namespace LinBox
+
+#endif // __LINBOX_scratch_vector_H
+
+// Local Variables:
+// mode: C++
+// tab-width: 4
+// indent-tabs-mode: nil
+// c-basic-offset: 4
+// End:
+// vim:sts=4:sw=4:ts=4:et:sr:cino=>s,f0,{0,g0,(0,\:0,t0,+0,=s
@@ -271,6 +271,17 @@ namespace LinBox
 		void reset ();
 	};
 
+	/** v gets the next elements of r, one after the other.
+	 * Generators which can do better overload it, see CounterRandIter.
+	 */
+	template <class RandIter, class Vector>
+	Vector& randomFill (RandIter &r, Vector &v)
+	{
+		for (typename Vector::iterator i = v.begin (); i != v.end (); ++i)
+			r.random (*i);
+		return v;
+	}
+
 	//! Specialization of random dense stream for dense vectors
 	template <class Field, class _Vector, class RandIter>
 	class RandomDenseStream<Field, _Vector, RandIter, VectorCategories::DenseVectorTag > : public VectorStream<_Vector> {
@@ -284,15 +295,10 @@ namespace LinBox
 
 		Vector &get (Vector &v)
 		{
-			typename Vector::iterator i;
-
 			if ( (_m > 0) && (_j++ >= _m) )
 				return v;
 
-			for (i = v.begin (); i != v.end (); ++i)
-				_r.random (*i);
-
-			return v;
+			return randomFill (_r, v);
 		}
 
 		/** Extraction operator form